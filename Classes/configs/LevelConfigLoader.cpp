@@ -1,9 +1,7 @@
 ﻿#include "LevelConfigLoader.h"
-#include "json/rapidjson.h"
-#include "json/document.h"
+#include "base/CCStreamReader.h"
 
 USING_NS_CC;
-using namespace RAPIDJSON_NAMESPACE;
 
 LevelConfig* LevelConfigLoader::loadLevelConfig(int levelId, const std::string& configPath)
 {
@@ -31,28 +29,11 @@ LevelConfig* LevelConfigLoader::loadLevelConfig(int levelId, const std::string&
         return nullptr;
     }
 
-    // 5. 解析 JSON 数据
-    Document doc;
-    doc.Parse<kParseDefaultFlags>(fileContent.c_str());
-
-    // 6. 检查 JSON 格式合法性
-    if (doc.HasParseError())
-    {
-        _errorLog = StringUtils::format(
-            "JSON 解析错误（文件：%s，错误码：%d，偏移量：%u）",
-            fullPath.c_str(),
-            doc.GetParseError(),
-            doc.GetErrorOffset()
-        );
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return nullptr;
-    }
-
-    // 7. 解析 JSON 数据为 LevelConfig
-    return parseLevelConfig(doc);
+    // 5. 流式解析 JSON 数据为 LevelConfig
+    return parseLevelConfig(fileContent, fullPath);
 }
 
-LevelConfig* LevelConfigLoader::parseLevelConfig(const RAPIDJSON_NAMESPACE::Value& root)
+LevelConfig* LevelConfigLoader::parseLevelConfig(const std::string& content, const std::string& fullPath)
 {
     // 1. 创建 LevelConfig 实例
     LevelConfig* levelConfig = LevelConfig::create();
@@ -63,136 +44,82 @@ LevelConfig* LevelConfigLoader::parseLevelConfig(const RAPIDJSON_NAMESPACE::Valu
         return nullptr;
     }
 
+    // 2. 当前解析的卡牌，点数与花色在卡牌对象结束时验证
+    CardConfig cardConfig;
+    int cardFaceInt = 0;
+    int cardSuitInt = 0;
     int cardId = 0;
-
-    // 2. 解析主牌区配置（Playfield）
-    if (root.HasMember("Playfield") && root["Playfield"].IsArray())
-    {
-        const auto& playfieldArray = root["Playfield"];
-        for (SizeType i = 0; i < playfieldArray.Size(); ++i)
+    // 备用牌堆的卡牌编号排在主牌区之后，与 JSON 中两个数组的顺序无关，解析完成后再加入
+    std::vector<CardConfig> stackConfigs;
+
+    // 3. 描述卡牌配置的结构（Position 的 x/y，CardFace，CardSuit 均为必需的整数）
+    StreamSchema positionSchema;
+    positionSchema
+        .onInt("x", [&cardConfig](int x) { cardConfig.position.x = static_cast<float>(x); return true; }).required()
+        .onInt("y", [&cardConfig](int y) { cardConfig.position.y = static_cast<float>(y); return true; }).required();
+
+    StreamSchema cardSchema;
+    cardSchema
+        .onInt("CardFace", [&cardFaceInt](int face) { cardFaceInt = face; return true; }).required()
+        .onInt("CardSuit", [&cardSuitInt](int suit) { cardSuitInt = suit; return true; }).required()
+        .onObject("Position", positionSchema).required();
+
+    auto beginCard = [&cardConfig]() {
+        cardConfig = CardConfig();
+        return true;
+    };
+    // 验证点数和花色的合法性，非法时停止解析
+    auto endCard = [this, &cardConfig, &cardFaceInt, &cardSuitInt]() {
+        if (!validateCardConfig(cardFaceInt, cardSuitInt))
+            return false;
+        cardConfig.cardFace = static_cast<CardFaceType>(cardFaceInt);
+        cardConfig.cardSuit = static_cast<CardSuitType>(cardSuitInt);
+        return true;
+    };
+
+    StreamSchema rootSchema;
+    rootSchema
+        .onArray("Playfield", cardSchema, beginCard, [&]() {
+            if (!endCard())
+                return false;
+            cardConfig.cardId = cardId++;
+            levelConfig->addPlayfieldConfig(cardConfig);
+            return true;
+        }).required()
+        .onArray("Stack", cardSchema, beginCard, [&]() {
+            if (!endCard())
+                return false;
+            stackConfigs.push_back(cardConfig);
+            return true;
+        }).required();
+
+    // 4. 解析 JSON 数据，格式错误、缺少字段或卡牌非法时失败
+    StreamReader reader;
+    if (!reader.parseJson(content.data(), content.size(), rootSchema))
+    {
+        // 卡牌非法时 validateCardConfig 已记录错误信息
+        if (_errorLog.empty())
         {
-            const auto& cardJson = playfieldArray[i];
-            CardConfig cardConfig;
-
-            if (parseCardConfig(cardJson, cardConfig))
-            {
-                cardConfig.cardId = cardId++;
-                levelConfig->addPlayfieldConfig(cardConfig);
-            }
-            else
-            {
-                // 解析单张卡牌失败，释放配置并返回 nullptr
-                CC_SAFE_DELETE(levelConfig);
-                return nullptr;
-            }
+            _errorLog = StringUtils::format("JSON 解析错误（文件：%s）：%s", fullPath.c_str(), reader.getError().c_str());
         }
-    }
-    else
-    {
-        _errorLog = "JSON 缺少 Playfield 数组或格式错误";
         CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
         CC_SAFE_DELETE(levelConfig);
         return nullptr;
     }
 
-    // 3. 解析备用牌堆配置（Stack）
-    if (root.HasMember("Stack") && root["Stack"].IsArray())
-    {
-        const auto& stackArray = root["Stack"];
-        for (SizeType i = 0; i < stackArray.Size(); ++i)
-        {
-            const auto& cardJson = stackArray[i];
-            CardConfig cardConfig;
-
-            if (parseCardConfig(cardJson, cardConfig))
-            {
-                cardConfig.cardId = cardId++;
-                levelConfig->addStackConfig(cardConfig);
-            }
-            else
-            {
-                // 解析单张卡牌失败，释放配置并返回 nullptr
-                CC_SAFE_DELETE(levelConfig);
-                return nullptr;
-            }
-        }
-    }
-    else
+    for (auto& stackConfig : stackConfigs)
     {
-        _errorLog = "JSON 缺少 Stack 数组或格式错误";
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        CC_SAFE_DELETE(levelConfig);
-        return nullptr;
+        stackConfig.cardId = cardId++;
+        levelConfig->addStackConfig(stackConfig);
     }
 
-    // 4. 解析成功，返回配置实例
+    // 5. 解析成功，返回配置实例
     CCLOG("[LevelConfigLoader] 关卡配置解析成功（主牌区：%zu 张，备用牌堆：%zu 张）",
         levelConfig->getPlayfieldConfigs().size(),
         levelConfig->getStackConfigs().size());
     return levelConfig;
 }
 
-bool LevelConfigLoader::parseCardConfig(const RAPIDJSON_NAMESPACE::Value& cardJson, CardConfig& outConfig)
-{
-    // 1. 检查卡牌 JSON 是否为对象
-    if (!cardJson.IsObject())
-    {
-        _errorLog = "卡牌配置不是 JSON 对象";
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return false;
-    }
-
-    // 2. 解析卡牌点数（CardFace）
-    if (!cardJson.HasMember("CardFace") || !cardJson["CardFace"].IsInt())
-    {
-        _errorLog = "卡牌配置缺少 CardFace 或格式错误";
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return false;
-    }
-    const int cardFaceInt = cardJson["CardFace"].GetInt();
-
-    // 3. 解析卡牌花色（CardSuit）
-    if (!cardJson.HasMember("CardSuit") || !cardJson["CardSuit"].IsInt())
-    {
-        _errorLog = "卡牌配置缺少 CardSuit 或格式错误";
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return false;
-    }
-    const int cardSuitInt = cardJson["CardSuit"].GetInt();
-
-    // 4. 验证点数和花色的合法性
-    if (!validateCardConfig(cardFaceInt, cardSuitInt))
-    {
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return false;
-    }
-
-    // 5. 解析卡牌位置（Position）
-    if (!cardJson.HasMember("Position") || !cardJson["Position"].IsObject())
-    {
-        _errorLog = "卡牌配置缺少 Position 或格式错误";
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return false;
-    }
-    const auto& posJson = cardJson["Position"];
-    if (!posJson.HasMember("x") || !posJson["x"].IsInt() ||
-        !posJson.HasMember("y") || !posJson["y"].IsInt())
-    {
-        _errorLog = "Position 缺少 x/y 或格式错误";
-        CCLOGERROR("[LevelConfigLoader] %s", _errorLog.c_str());
-        return false;
-    }
-    const float x = static_cast<float>(posJson["x"].GetInt());
-    const float y = static_cast<float>(posJson["y"].GetInt());
-
-    // 6. 赋值给输出参数
-    outConfig.cardFace = static_cast<CardFaceType>(cardFaceInt);
-    outConfig.cardSuit = static_cast<CardSuitType>(cardSuitInt);
-    outConfig.position = Vec2(x, y);
-
-    return true;
-}
-
 bool LevelConfigLoader::validateCardConfig(int face, int suit)
 {
     // 验证点数范围（CFT_ACE(0) ~ CFT_KING(12)）
@@ -1,7 +1,6 @@
 ﻿#pragma once
 #include "cocos2d.h"
 #include "LevelConfig.h"
-#include "json/document.h"
 
 /**
  * @class LevelConfigLoader
@@ -30,19 +29,12 @@ public:
 
 private:
     /**
-     * 解析 JSON 根对象，生成 LevelConfig 数据
-     * @param root JSON 根对象
+     * 流式解析 JSON 内容，生成 LevelConfig 数据（不构建 JSON DOM，卡牌配置边解析边填充）
+     * @param content JSON 文件内容
+     * @param fullPath 配置文件路径（用于错误日志）
      * @return 成功返回 LevelConfig 实例，失败返回 nullptr
      */
-    LevelConfig* parseLevelConfig(const RAPIDJSON_NAMESPACE::Value& root);
-
-    /**
-     * 解析单个卡牌配置（Playfield 或 Stack 中的卡牌）
-     * @param cardJson 单张卡牌的 JSON 对象
-     * @param outConfig 输出参数：解析后的 CardConfig 结构
-     * @return 解析成功返回 true，失败返回 false
-     */
-    bool parseCardConfig(const RAPIDJSON_NAMESPACE::Value& cardJson, CardConfig& outConfig);
+    LevelConfig* parseLevelConfig(const std::string& content, const std::string& fullPath);
 
     /**
      * 验证卡牌配置的合法性（点数、花色范围）
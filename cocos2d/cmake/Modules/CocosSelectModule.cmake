@@ -16,6 +16,7 @@ option(USE_WEBP "Use WebP codec" ${USE_WEBP_DEFAULT})
 option(USE_PNG "Use PNG codec" ON)
 option(USE_TIFF "Use TIFF codec" ON)
 option(USE_JPEG "Use JPEG codec" ON)
+option(USE_HEADLESS_GLVIEW "Build the headless EGL GLView on Linux" OFF)
 option(BUILD_SHARED_LIBS "Build shared libraries" OFF)
 option(DEBUG_MODE "Debug or Release?" ON)
 option(BUILD_EXTENSIONS "Build extension library" ON)
@@ -15,6 +15,9 @@ macro(cocos2d_depend_libs)
     elseif(LINUX)
         # need review those libs: X11 Xi Xrandr Xxf86vm Xinerama Xcursor rt m
         list(APPEND PLATFORM_SPECIFIC_LIBS dl X11 Xi Xrandr Xxf86vm Xinerama Xcursor rt m)
+        if(USE_HEADLESS_GLVIEW)
+            list(APPEND PLATFORM_SPECIFIC_LIBS EGL)
+        endif()
         foreach(_pkg OPENGL GLEW GLFW3 FMOD FONTCONFIG THREADS GTK3 SQLITE3)
             list(APPEND PREBUILT_SPECIFIC_LIBS ${_pkg})
         endforeach()
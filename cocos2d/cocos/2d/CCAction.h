@@ -178,10 +178,13 @@ protected:
     int     _tag;
     /** The action flag field. To categorize action into certain groups.*/
     unsigned int _flags;
+    /** The lane of the action in the ActionManager tween batch, -1 when the action is stepped. */
+    int _batchLane;
 
 #if CC_ENABLE_SCRIPT_BINDING
     ccScriptType _scriptType;         ///< type of script binding, lua or javascript
 #endif
+    friend class ActionManager;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(Action);
 };
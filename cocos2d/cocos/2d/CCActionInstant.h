@@ -31,6 +31,7 @@ THE SOFTWARE.
 
 #include <functional>
 #include "2d/CCAction.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -380,6 +381,9 @@ public:
     virtual void update(float time) override;
     virtual CallFunc* reverse() const override;
     virtual CallFunc* clone() const override;
+
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(CallFunc)
     
 CC_CONSTRUCTOR_ACCESS:
     CallFunc()
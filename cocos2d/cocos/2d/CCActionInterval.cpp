@@ -39,9 +39,13 @@ THE SOFTWARE.
 #include "base/CCEventDispatcher.h"
 #include "platform/CCStdC.h"
 #include "base/CCScriptSupport.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Sequence, 100)
+CC_DEFINE_ALLOCATOR_POOL(MoveTo, 100)
+
 // Extra action for making a Sequence or Spawn when only adding one action to it.
 class ExtraAction : public FiniteTimeAction
 {
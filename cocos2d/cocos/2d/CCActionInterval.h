@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "2d/CCAnimation.h"
 #include "base/CCProtocols.h"
 #include "base/CCVector.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -120,6 +121,8 @@ protected:
     
 protected:
     bool sendUpdateEventToScript(float dt, Action *actionObject);
+
+    friend class ActionManager;
 };
 
 /** @class Sequence
@@ -191,6 +194,9 @@ public:
      * @param t In seconds.
      */
     virtual void update(float t) override;
+
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(Sequence)
     
 CC_CONSTRUCTOR_ACCESS:
     Sequence();
@@ -507,6 +513,7 @@ protected:
     Vec3 _dstAngle;
     Vec3 _startAngle;
     Vec3 _diffAngle;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateTo);
@@ -573,6 +580,7 @@ protected:
     bool _is3D;
     Vec3 _deltaAngle;
     Vec3 _startAngle;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(RotateBy);
@@ -629,6 +637,7 @@ protected:
     Vec3 _positionDelta;
     Vec3 _startPosition;
     Vec3 _previousPosition;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(MoveBy);
@@ -664,6 +673,9 @@ public:
     virtual MoveTo* clone() const override;
     virtual MoveTo* reverse() const  override;
     virtual void startWithTarget(Node *target) override;
+
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(MoveTo)
     
 CC_CONSTRUCTOR_ACCESS:
     MoveTo() {}
@@ -1124,6 +1136,7 @@ protected:
     float _deltaX;
     float _deltaY;
     float _deltaZ;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(ScaleTo);
@@ -1264,6 +1277,7 @@ protected:
     GLubyte _fromOpacity;
     friend class FadeOut;
     friend class FadeIn;
+    friend class ActionManager;
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(FadeTo);
 };
@@ -1382,6 +1396,7 @@ CC_CONSTRUCTOR_ACCESS:
 protected:
     Color3B _to;
     Color3B _from;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(TintTo);
@@ -1430,6 +1445,7 @@ protected:
     GLshort _fromR;
     GLshort _fromG;
     GLshort _fromB;
+    friend class ActionManager;
 
 private:
     CC_DISALLOW_COPY_AND_ASSIGN(TintBy);
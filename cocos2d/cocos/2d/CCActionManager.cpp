@@ -28,8 +28,15 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "2d/CCActionManager.h"
+
+#include <algorithm>
+#include <typeinfo>
+#include <vector>
+
 #include "2d/CCNode.h"
 #include "2d/CCAction.h"
+#include "2d/CCActionEase.h"
+#include "2d/CCActionInterval.h"
 #include "base/CCScheduler.h"
 #include "base/ccMacros.h"
 #include "base/ccCArray.h"
@@ -50,10 +57,125 @@ typedef struct _hashElement
     UT_hash_handle      hh;
 } tHashElement;
 
+//
+// batch stuff
+//
+enum class TweenKind : unsigned char
+{
+    MOVE,
+    SCALE,
+    ROTATE,
+    ROTATE_3D,
+    OPACITY,
+    COLOR
+};
+
+typedef float (*TweenFunc)(float time);
+typedef float (*TweenRateFunc)(float time, float rate);
+
+// The batched actions as structure of arrays, one lane per action
+typedef struct _tweenBatch
+{
+    std::vector<ActionInterval*>    actions;    // the action run by the target
+    std::vector<ActionInterval*>    tweens;     // the interpolated action, the inner one of an easing
+    std::vector<Node*>              targets;
+    std::vector<TweenKind>          kinds;
+    std::vector<TweenFunc>          easings;
+    std::vector<TweenRateFunc>      rateEasings;
+    std::vector<float>              rates;
+    std::vector<float>              durations;
+    std::vector<float>              elapsed;
+    std::vector<float>              running;    // 0 while the target is paused, else 1
+    std::vector<float>              started;    // 0 until the first tick, else 1
+    std::vector<float>              ticked;     // 1 once the values of the frame are computed, else 0
+    std::vector<float>              nextElapsed;
+    std::vector<float>              times;
+    std::vector<float>              from[3];
+    std::vector<float>              delta[3];
+    std::vector<float>              values[3];
+    std::vector<float>              previous[3]; // last position set by a move, for the stackable actions
+} tTweenBatch;
+
+template <typename T>
+static void eraseLane(std::vector<T>& lanes, size_t lane)
+{
+    lanes[lane] = lanes.back();
+    lanes.pop_back();
+}
+
+static TweenFunc getEasing(const std::type_info& type)
+{
+    static const struct
+    {
+        const std::type_info& type;
+        TweenFunc func;
+    } easings[] = {
+        { typeid(EaseExponentialIn), tweenfunc::expoEaseIn },
+        { typeid(EaseExponentialOut), tweenfunc::expoEaseOut },
+        { typeid(EaseExponentialInOut), tweenfunc::expoEaseInOut },
+        { typeid(EaseSineIn), tweenfunc::sineEaseIn },
+        { typeid(EaseSineOut), tweenfunc::sineEaseOut },
+        { typeid(EaseSineInOut), tweenfunc::sineEaseInOut },
+        { typeid(EaseBounceIn), tweenfunc::bounceEaseIn },
+        { typeid(EaseBounceOut), tweenfunc::bounceEaseOut },
+        { typeid(EaseBounceInOut), tweenfunc::bounceEaseInOut },
+        { typeid(EaseBackIn), tweenfunc::backEaseIn },
+        { typeid(EaseBackOut), tweenfunc::backEaseOut },
+        { typeid(EaseBackInOut), tweenfunc::backEaseInOut },
+        { typeid(EaseQuadraticActionIn), tweenfunc::quadraticIn },
+        { typeid(EaseQuadraticActionOut), tweenfunc::quadraticOut },
+        { typeid(EaseQuadraticActionInOut), tweenfunc::quadraticInOut },
+        { typeid(EaseQuarticActionIn), tweenfunc::quartEaseIn },
+        { typeid(EaseQuarticActionOut), tweenfunc::quartEaseOut },
+        { typeid(EaseQuarticActionInOut), tweenfunc::quartEaseInOut },
+        { typeid(EaseQuinticActionIn), tweenfunc::quintEaseIn },
+        { typeid(EaseQuinticActionOut), tweenfunc::quintEaseOut },
+        { typeid(EaseQuinticActionInOut), tweenfunc::quintEaseInOut },
+        { typeid(EaseCircleActionIn), tweenfunc::circEaseIn },
+        { typeid(EaseCircleActionOut), tweenfunc::circEaseOut },
+        { typeid(EaseCircleActionInOut), tweenfunc::circEaseInOut },
+        { typeid(EaseCubicActionIn), tweenfunc::cubicEaseIn },
+        { typeid(EaseCubicActionOut), tweenfunc::cubicEaseOut },
+        { typeid(EaseCubicActionInOut), tweenfunc::cubicEaseInOut },
+    };
+
+    for (const auto& easing : easings)
+    {
+        if (easing.type == type)
+            return easing.func;
+    }
+    return nullptr;
+}
+
+static TweenRateFunc getRateEasing(const std::type_info& type)
+{
+    static const struct
+    {
+        const std::type_info& type;
+        TweenRateFunc func;
+    } easings[] = {
+        { typeid(EaseIn), tweenfunc::easeIn },
+        { typeid(EaseOut), tweenfunc::easeOut },
+        { typeid(EaseInOut), tweenfunc::easeInOut },
+        { typeid(EaseElasticIn), tweenfunc::elasticEaseIn },
+        { typeid(EaseElasticOut), tweenfunc::elasticEaseOut },
+        { typeid(EaseElasticInOut), tweenfunc::elasticEaseInOut },
+    };
+
+    for (const auto& easing : easings)
+    {
+        if (easing.type == type)
+            return easing.func;
+    }
+    return nullptr;
+}
+
 ActionManager::ActionManager()
 : _targets(nullptr),
   _currentTarget(nullptr),
-  _currentTargetSalvaged(false)
+  _currentTargetSalvaged(false),
+  _tweenBatch(new (std::nothrow) tTweenBatch()),
+  _batchingEnabled(false)
 {
 
 }
@@ -63,12 +185,14 @@ ActionManager::~ActionManager()
     CCLOGINFO("deallocing ActionManager: %p", this);
 
     removeAllActions();
+    delete _tweenBatch;
 }
 
 // private
 
 void ActionManager::deleteHashElement(tHashElement *element)
 {
+    unbatchActions(element);
     ccArrayFree(element->actions);
     HASH_DEL(_targets, element);
     element->target->release();
@@ -93,6 +217,11 @@ void ActionManager::removeActionAtIndex(ssize_t index, tHashElement *element)
 {
     Action *action = static_cast<Action*>(element->actions->arr[index]);
 
+    if (action->_batchLane >= 0)
+    {
+        unbatchAction(action);
+    }
+
     if (action == element->currentAction && (! element->currentActionSalvaged))
     {
         element->currentAction->retain();
@@ -129,6 +258,7 @@ void ActionManager::pauseTarget(Node *target)
     if (element)
     {
         element->paused = true;
+        setBatchRunning(element, false);
     }
 }
 
@@ -139,6 +269,7 @@ void ActionManager::resumeTarget(Node *target)
     if (element)
     {
         element->paused = false;
+        setBatchRunning(element, true);
     }
 }
 
@@ -151,6 +282,7 @@ Vector<Node*> ActionManager::pauseAllRunningActions()
         if (! element->paused) 
         {
             element->paused = true;
+            setBatchRunning(element, false);
             idsWithActions.pushBack(element->target);
         }
     }    
@@ -194,6 +326,11 @@ void ActionManager::addAction(Action *action, Node *target, bool paused)
      ccArrayAppendObject(element->actions, action);
  
      action->startWithTarget(target);
+
+     if (_batchingEnabled)
+     {
+         batchAction(action, element);
+     }
 }
 
 // remove
@@ -226,6 +363,7 @@ void ActionManager::removeAllActionsFromTarget(Node *target)
             element->currentActionSalvaged = true;
         }
 
+        unbatchActions(element);
         ccArrayRemoveAllObjects(element->actions);
         if (_currentTarget == element)
         {
@@ -436,9 +574,369 @@ ssize_t ActionManager::getNumberOfRunningActions() const
     return count;
 }
 
+// batch
+
+void ActionManager::setBatchingEnabled(bool enabled)
+{
+    _batchingEnabled = enabled;
+
+    if (! enabled)
+    {
+        // the remaining steps are done by the actions
+        while (! _tweenBatch->actions.empty())
+        {
+            unbatchAction(_tweenBatch->actions.back());
+        }
+    }
+}
+
+ssize_t ActionManager::getNumberOfBatchedActions() const
+{
+    return _tweenBatch->actions.size();
+}
+
+void ActionManager::batchAction(Action *action, tHashElement *element)
+{
+#if CC_ENABLE_SCRIPT_BINDING
+    // the script may handle the update itself
+    if (action->_scriptType == kScriptTypeJavascript)
+    {
+        return;
+    }
+#endif
+
+    auto interval = dynamic_cast<ActionInterval*>(action);
+    if (interval == nullptr)
+    {
+        return;
+    }
+
+    // the exact types only, a subclass may override update()
+    ActionInterval *tween = interval;
+    TweenFunc easing = nullptr;
+    TweenRateFunc rateEasing = nullptr;
+    float rate = 0;
+    if (auto ease = dynamic_cast<ActionEase*>(interval))
+    {
+        easing = getEasing(typeid(*ease));
+        rateEasing = getRateEasing(typeid(*ease));
+        if (easing == nullptr && rateEasing == nullptr)
+        {
+            return;
+        }
+
+        if (auto rateAction = dynamic_cast<EaseRateAction*>(ease))
+        {
+            rate = rateAction->getRate();
+        }
+        else if (auto elastic = dynamic_cast<EaseElastic*>(ease))
+        {
+            rate = elastic->getPeriod();
+        }
+        tween = ease->getInnerAction();
+    }
+
+    TweenKind kind;
+    Vec3 from, delta, previous;
+    const std::type_info& type = typeid(*tween);
+    if (type == typeid(MoveBy) || type == typeid(MoveTo))
+    {
+        auto move = static_cast<MoveBy*>(tween);
+        kind = TweenKind::MOVE;
+        from = move->_startPosition;
+        delta = move->_positionDelta;
+        previous = move->_previousPosition;
+    }
+    else if (type == typeid(ScaleTo) || type == typeid(ScaleBy))
+    {
+        auto scale = static_cast<ScaleTo*>(tween);
+        kind = TweenKind::SCALE;
+        from.set(scale->_startScaleX, scale->_startScaleY, scale->_startScaleZ);
+        delta.set(scale->_deltaX, scale->_deltaY, scale->_deltaZ);
+    }
+    else if (type == typeid(RotateBy))
+    {
+        auto rotate = static_cast<RotateBy*>(tween);
+        kind = rotate->_is3D ? TweenKind::ROTATE_3D : TweenKind::ROTATE;
+        from = rotate->_startAngle;
+        delta = rotate->_deltaAngle;
+    }
+    else if (type == typeid(RotateTo))
+    {
+        auto rotate = static_cast<RotateTo*>(tween);
+        kind = rotate->_is3D ? TweenKind::ROTATE_3D : TweenKind::ROTATE;
+        from = rotate->_startAngle;
+        delta = rotate->_diffAngle;
+    }
+    else if (type == typeid(FadeTo) || type == typeid(FadeIn) || type == typeid(FadeOut))
+    {
+        auto fade = static_cast<FadeTo*>(tween);
+        kind = TweenKind::OPACITY;
+        from.x = fade->_fromOpacity;
+        delta.x = fade->_toOpacity - fade->_fromOpacity;
+    }
+    else if (type == typeid(TintTo))
+    {
+        auto tint = static_cast<TintTo*>(tween);
+        kind = TweenKind::COLOR;
+        from.set(tint->_from.r, tint->_from.g, tint->_from.b);
+        delta.set(tint->_to.r - tint->_from.r, tint->_to.g - tint->_from.g, tint->_to.b - tint->_from.b);
+    }
+    else if (type == typeid(TintBy))
+    {
+        auto tint = static_cast<TintBy*>(tween);
+        kind = TweenKind::COLOR;
+        from.set(tint->_fromR, tint->_fromG, tint->_fromB);
+        delta.set(tint->_deltaR, tint->_deltaG, tint->_deltaB);
+    }
+    else
+    {
+        return;
+    }
+
+    auto batch = _tweenBatch;
+    action->_batchLane = (int)batch->actions.size();
+    batch->actions.push_back(interval);
+    batch->tweens.push_back(tween);
+    batch->targets.push_back(element->target);
+    batch->kinds.push_back(kind);
+    batch->easings.push_back(easing);
+    batch->rateEasings.push_back(rateEasing);
+    batch->rates.push_back(rate);
+    batch->durations.push_back(interval->getDuration());
+    batch->elapsed.push_back(interval->_elapsed);
+    batch->running.push_back(element->paused ? 0.0f : 1.0f);
+    batch->started.push_back(interval->_firstTick ? 0.0f : 1.0f);
+    batch->ticked.push_back(0.0f);
+    batch->nextElapsed.push_back(interval->_elapsed);
+    batch->times.push_back(0.0f);
+    const float* fromValues = &from.x;
+    const float* deltaValues = &delta.x;
+    const float* previousValues = &previous.x;
+    for (int c = 0; c < 3; ++c)
+    {
+        batch->from[c].push_back(fromValues[c]);
+        batch->delta[c].push_back(deltaValues[c]);
+        batch->values[c].push_back(fromValues[c]);
+        batch->previous[c].push_back(previousValues[c]);
+    }
+}
+
+void ActionManager::unbatchAction(Action *action)
+{
+    auto batch = _tweenBatch;
+    size_t lane = action->_batchLane;
+    CCASSERT(lane < batch->actions.size() && batch->actions[lane] == action, "action isn't batched!");
+
+    if (batch->kinds[lane] == TweenKind::MOVE)
+    {
+        // the positions moved with the stacked actions
+        auto move = static_cast<MoveBy*>(batch->tweens[lane]);
+        move->_startPosition.set(batch->from[0][lane], batch->from[1][lane], batch->from[2][lane]);
+        move->_previousPosition.set(batch->previous[0][lane], batch->previous[1][lane], batch->previous[2][lane]);
+    }
+
+    batch->actions.back()->_batchLane = (int)lane;
+    action->_batchLane = -1;
+
+    eraseLane(batch->actions, lane);
+    eraseLane(batch->tweens, lane);
+    eraseLane(batch->targets, lane);
+    eraseLane(batch->kinds, lane);
+    eraseLane(batch->easings, lane);
+    eraseLane(batch->rateEasings, lane);
+    eraseLane(batch->rates, lane);
+    eraseLane(batch->durations, lane);
+    eraseLane(batch->elapsed, lane);
+    eraseLane(batch->running, lane);
+    eraseLane(batch->started, lane);
+    eraseLane(batch->ticked, lane);
+    eraseLane(batch->nextElapsed, lane);
+    eraseLane(batch->times, lane);
+    for (int c = 0; c < 3; ++c)
+    {
+        eraseLane(batch->from[c], lane);
+        eraseLane(batch->delta[c], lane);
+        eraseLane(batch->values[c], lane);
+        eraseLane(batch->previous[c], lane);
+    }
+}
+
+void ActionManager::unbatchActions(tHashElement *element)
+{
+    if (_tweenBatch->actions.empty() || element->actions == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < element->actions->num; ++i)
+    {
+        auto action = static_cast<Action*>(element->actions->arr[i]);
+        if (action->_batchLane >= 0)
+        {
+            unbatchAction(action);
+        }
+    }
+}
+
+void ActionManager::setBatchRunning(tHashElement *element, bool running)
+{
+    if (_tweenBatch->actions.empty() || element->actions == nullptr)
+    {
+        return;
+    }
+
+    for (int i = 0; i < element->actions->num; ++i)
+    {
+        auto action = static_cast<Action*>(element->actions->arr[i]);
+        if (action->_batchLane >= 0)
+        {
+            _tweenBatch->running[action->_batchLane] = running ? 1.0f : 0.0f;
+        }
+    }
+}
+
+void ActionManager::updateBatch(float dt)
+{
+    auto batch = _tweenBatch;
+    const size_t count = batch->actions.size();
+    if (count == 0)
+    {
+        return;
+    }
+
+    // Same as ActionInterval::step, the values are set on the nodes by stepBatchedAction.
+    // The passes over the arrays have no branch, so that the compiler vectorizes them.
+    const float* elapsed = batch->elapsed.data();
+    const float* running = batch->running.data();
+    const float* started = batch->started.data();
+    float* ticked = batch->ticked.data();
+    float* nextElapsed = batch->nextElapsed.data();
+    float* times = batch->times.data();
+    const float* durations = batch->durations.data();
+    for (size_t i = 0; i < count; ++i)
+    {
+        // the first tick only starts the action
+        nextElapsed[i] = started[i] * (elapsed[i] + dt * running[i]);
+        times[i] = std::max(0.0f, std::min(1.0f, nextElapsed[i] / durations[i]));
+        ticked[i] = 1.0f;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (batch->easings[i])
+            times[i] = batch->easings[i](times[i]);
+        else if (batch->rateEasings[i])
+            times[i] = batch->rateEasings[i](times[i], batch->rates[i]);
+    }
+
+    for (int c = 0; c < 3; ++c)
+    {
+        const float* from = batch->from[c].data();
+        const float* delta = batch->delta[c].data();
+        float* values = batch->values[c].data();
+        for (size_t i = 0; i < count; ++i)
+        {
+            values[i] = from[i] + delta[i] * times[i];
+        }
+    }
+}
+
+void ActionManager::stepBatchedAction(Action *action, float dt)
+{
+    auto batch = _tweenBatch;
+    const size_t i = action->_batchLane;
+
+    if (batch->ticked[i] == 0)
+    {
+        // batched during this update, after updateBatch
+        batch->nextElapsed[i] = batch->started[i] * (batch->elapsed[i] + dt);
+        float time = std::max(0.0f, std::min(1.0f, batch->nextElapsed[i] / batch->durations[i]));
+        if (batch->easings[i])
+            time = batch->easings[i](time);
+        else if (batch->rateEasings[i])
+            time = batch->rateEasings[i](time, batch->rates[i]);
+        for (int c = 0; c < 3; ++c)
+        {
+            batch->values[c][i] = batch->from[c][i] + batch->delta[c][i] * time;
+        }
+        batch->ticked[i] = 1.0f;
+    }
+
+    // leave the action as its step would
+    auto interval = batch->actions[i];
+    batch->elapsed[i] = batch->nextElapsed[i];
+    batch->started[i] = 1.0f;
+    interval->_elapsed = batch->elapsed[i];
+    interval->_firstTick = false;
+    interval->_done = interval->_elapsed >= batch->durations[i];
+
+    Node *target = batch->targets[i];
+    float x = batch->values[0][i];
+    float y = batch->values[1][i];
+    float z = batch->values[2][i];
+
+    // A node setter may run or stop actions, the lane isn't used after it.
+    switch (batch->kinds[i])
+    {
+    case TweenKind::MOVE:
+        {
+#if CC_ENABLE_STACKABLE_ACTIONS
+            // same as MoveBy::update, the moves add to the other changes of the position,
+            // including the ones of the actions stepped before this one
+            Vec3 currentPos = target->getPosition3D();
+            Vec3 diff(currentPos.x - batch->previous[0][i], currentPos.y - batch->previous[1][i], currentPos.z - batch->previous[2][i]);
+            batch->from[0][i] += diff.x;
+            batch->from[1][i] += diff.y;
+            batch->from[2][i] += diff.z;
+            x += diff.x;
+            y += diff.y;
+            z += diff.z;
+            batch->previous[0][i] = x;
+            batch->previous[1][i] = y;
+            batch->previous[2][i] = z;
+#endif
+            target->setPosition3D(Vec3(x, y, z));
+        }
+        break;
+    case TweenKind::SCALE:
+        target->setScaleX(x);
+        target->setScaleY(y);
+        target->setScaleZ(z);
+        break;
+    case TweenKind::ROTATE:
+#if CC_USE_PHYSICS
+        if (batch->from[0][i] == batch->from[1][i] && batch->delta[0][i] == batch->delta[1][i])
+        {
+            target->setRotation(x);
+        }
+        else
+        {
+            target->setRotationSkewX(x);
+            target->setRotationSkewY(y);
+        }
+#else
+        target->setRotationSkewX(x);
+        target->setRotationSkewY(y);
+#endif // CC_USE_PHYSICS
+        break;
+    case TweenKind::ROTATE_3D:
+        target->setRotation3D(Vec3(x, y, z));
+        break;
+    case TweenKind::OPACITY:
+        target->setOpacity((GLubyte)x);
+        break;
+    case TweenKind::COLOR:
+        target->setColor(Color3B((GLubyte)x, (GLubyte)y, (GLubyte)z));
+        break;
+    }
+}
+
 // main loop
 void ActionManager::update(float dt)
 {
+    updateBatch(dt);
+
     for (tHashElement *elt = _targets; elt != nullptr; )
     {
         _currentTarget = elt;
@@ -458,7 +956,15 @@ void ActionManager::update(float dt)
 
                 _currentTarget->currentActionSalvaged = false;
 
-                _currentTarget->currentAction->step(dt);
+                // the values of the batched actions are computed by updateBatch
+                if (_currentTarget->currentAction->_batchLane >= 0)
+                {
+                    stepBatchedAction(_currentTarget->currentAction, dt);
+                }
+                else
+                {
+                    _currentTarget->currentAction->step(dt);
+                }
 
                 if (_currentTarget->currentActionSalvaged)
                 {
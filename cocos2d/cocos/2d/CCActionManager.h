@@ -37,8 +37,10 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Action;
+class ActionInterval;
 
 struct _hashElement;
+struct _tweenBatch;
 
 /**
  * @addtogroup actions
@@ -193,6 +195,26 @@ public:
      * @param targetsToResume   A set of targets need to be resumed.
      */
     virtual void resumeTargets(const Vector<Node*>& targetsToResume);
+
+    /** Enables the batched update of the common interval actions.
+     * MoveTo, MoveBy, ScaleTo, ScaleBy, RotateTo, RotateBy, FadeTo, FadeIn, FadeOut, TintTo and TintBy,
+     * alone or wrapped in an easing action, are then interpolated together in dense arrays
+     * instead of being stepped one by one. Only the actions run directly on a node are batched,
+     * not the ones in a Sequence or a Spawn. Disabled by default.
+     * @param enabled True to batch the actions added from now on, false to step all the actions.
+     * @since v3.17
+     */
+    void setBatchingEnabled(bool enabled);
+
+    /** Returns whether the common interval actions are batched.
+     * @since v3.17
+     */
+    bool isBatchingEnabled() const { return _batchingEnabled; }
+
+    /** Returns the number of actions updated by the batch.
+     * @since v3.17
+     */
+    ssize_t getNumberOfBatchedActions() const;
     
     /** Main loop of ActionManager.
      * @param dt    In seconds.
@@ -206,10 +228,21 @@ protected:
     void deleteHashElement(struct _hashElement *element);
     void actionAllocWithHashElement(struct _hashElement *element);
 
+    // batch specific
+
+    void batchAction(Action *action, struct _hashElement *element);
+    void unbatchAction(Action *action);
+    void unbatchActions(struct _hashElement *element);
+    void setBatchRunning(struct _hashElement *element, bool running);
+    void updateBatch(float dt);
+    void stepBatchedAction(Action *action, float dt);
+
 protected:
     struct _hashElement    *_targets;
     struct _hashElement    *_currentTarget;
     bool            _currentTargetSalvaged;
+    struct _tweenBatch     *_tweenBatch;
+    bool            _batchingEnabled;
 };
 
 // end of actions group
@@ -355,9 +355,9 @@ protected:
     CustomCommand _customCommandGLPoint;
     CustomCommand _customCommandGLLine;
 
-    bool        _dirty;
-    bool        _dirtyGLPoint;
-    bool        _dirtyGLLine;
+    DirtyFlag   _dirty;
+    DirtyFlag   _dirtyGLPoint;
+    DirtyFlag   _dirtyGLLine;
     
     GLfloat         _lineWidth;
 
@@ -32,6 +32,7 @@
 #include "renderer/CCQuadCommand.h"
 #include "2d/CCFontAtlas.h"
 #include "base/ccTypes.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -592,6 +593,9 @@ public:
     CC_DEPRECATED_ATTRIBUTE FontDefinition getFontDefinition() const { return _getFontDefinition(); }
     CC_DEPRECATED_ATTRIBUTE int getCommonLineHeight() const { return (int)getLineHeight();}
 
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(Label)
+
 CC_CONSTRUCTOR_ACCESS:
     /**
      * Constructor of Label.
@@ -681,7 +685,7 @@ protected:
     virtual void updateColor() override;
 
     LabelType _currentLabelType;
-    bool _contentDirty;
+    DirtyFlag _contentDirty;
     std::u32string _utf32Text;
     std::string _utf8Text;
     int _numberOfLines;
@@ -58,8 +58,16 @@ NS_CC_BEGIN
 
 // FIXME:: Yes, nodes might have a sort problem once every 30 days if the game runs at 60 FPS and each frame sprites are reordered.
 std::uint32_t Node::s_globalOrderOfArrival = 0;
+std::uint32_t Node::s_transformVersion = 0;
+bool Node::s_sceneGraphDirty = true;
 int Node::__attachedNodeCount = 0;
 
+// above this number of reordered children, sortAllChildren sorts all of them again
+static const size_t MAX_INCREMENTALLY_SORTED_CHILDREN = 16;
+
+// below this number of dirty children, each one computes its transform in processParentFlags
+static const size_t MIN_BATCHED_CHILDREN_TRANSFORMS = 4;
+
 // MARK: Constructor, Destructor, Init
 
 Node::Node()
@@ -99,6 +107,7 @@ Node::Node()
 , _visible(true)
 , _ignoreAnchorPointForPosition(false)
 , _reorderChildDirty(false)
+, _transformBatched(false)
 , _isTransitionFinished(false)
 #if CC_ENABLE_SCRIPT_BINDING
 , _updateScriptHandler(0)
@@ -299,6 +308,7 @@ void Node::setGlobalZOrder(float globalZOrder)
     {
         _globalZOrder = globalZOrder;
         _eventDispatcher->setDirtyForNode(this);
+        s_sceneGraphDirty = true;
     }
 }
 
@@ -607,6 +617,8 @@ void Node::setVisible(bool visible)
     if(visible != _visible)
     {
         _visible = visible;
+        // hiding a node needs a redraw too
+        s_sceneGraphDirty = true;
         if(_visible)
             _transformUpdated = _transformDirty = _inverseDirty = true;
     }
@@ -1116,10 +1128,13 @@ void Node::removeAllChildrenWithCleanup(bool cleanup)
     }
     
     _children.clear();
+    _reorderedChildren.clear();
 }
 
 void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
 {
+    s_sceneGraphDirty = true;
+
     // IMPORTANT:
     //  -1st do onExit
     //  -2nd cleanup
@@ -1147,6 +1162,12 @@ void Node::detachChild(Node *child, ssize_t childIndex, bool doCleanup)
     child->setParent(nullptr);
 
     _children.erase(childIndex);
+
+    auto reorderedIter = std::find(_reorderedChildren.begin(), _reorderedChildren.end(), child);
+    if (reorderedIter != _reorderedChildren.end())
+    {
+        _reorderedChildren.erase(reorderedIter);
+    }
 }
 
 
@@ -1161,7 +1182,7 @@ void Node::insertChild(Node* child, int z)
     }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
     _transformUpdated = true;
-    _reorderChildDirty = true;
+    setChildReordered(child);
     _children.pushBack(child);
     child->_setLocalZOrder(z);
 }
@@ -1169,21 +1190,89 @@ void Node::insertChild(Node* child, int z)
 void Node::reorderChild(Node *child, int zOrder)
 {
     CCASSERT( child != nullptr, "Child must be non-nil");
-    _reorderChildDirty = true;
+    setChildReordered(child);
     child->updateOrderOfArrival();
     child->_setLocalZOrder(zOrder);
 }
 
+void Node::setChildReordered(Node* child)
+{
+    // Subclasses set _reorderChildDirty without listing the children, it is then kept empty to sort all of them.
+    if (!_reorderChildDirty)
+    {
+        _reorderedChildren.clear();
+        _reorderedChildren.push_back(child);
+    }
+    else if (!_reorderedChildren.empty()
+             && std::find(_reorderedChildren.begin(), _reorderedChildren.end(), child) == _reorderedChildren.end())
+    {
+        if (_reorderedChildren.size() < MAX_INCREMENTALLY_SORTED_CHILDREN)
+            _reorderedChildren.push_back(child);
+        else
+            _reorderedChildren.clear();
+    }
+    _reorderChildDirty = true;
+}
+
 void Node::sortAllChildren()
 {
     if (_reorderChildDirty)
     {
-        sortNodes(_children);
+        if (_reorderedChildren.empty())
+            sortNodes(_children);
+        else
+            sortReorderedChildren();
+        _reorderedChildren.clear();
         _reorderChildDirty = false;
         _eventDispatcher->setDirtyForNode(this);
     }
 }
 
+bool Node::isChildOrderLess(Node* n1, Node* n2)
+{
+#if CC_64BITS
+    return (n1->_localZOrder$Arrival < n2->_localZOrder$Arrival);
+#else
+    return (n1->_localZOrder == n2->_localZOrder && n1->_orderOfArrival < n2->_orderOfArrival) || n1->_localZOrder < n2->_localZOrder;
+#endif
+}
+
+void Node::sortReorderedChildren()
+{
+    auto first = _children.begin();
+    auto last = _children.end();
+
+    // take the reordered children out, the other ones stay sorted
+    Node* moved[MAX_INCREMENTALLY_SORTED_CHILDREN];
+    size_t movedCount = 0;
+    auto sortedEnd = first;
+    for (auto iter = first; iter != last; ++iter)
+    {
+        if (movedCount < _reorderedChildren.size()
+            && std::find(_reorderedChildren.begin(), _reorderedChildren.end(), *iter) != _reorderedChildren.end())
+        {
+            moved[movedCount++] = *iter;
+        }
+        else
+        {
+            *sortedEnd++ = *iter;
+        }
+    }
+    std::sort(moved, moved + movedCount, isChildOrderLess);
+
+    // merge them back from the end, each one is placed with a binary search,
+    // the order of arrival is unique so that the result is the same as sortNodes
+    auto write = last;
+    while (movedCount > 0)
+    {
+        Node* child = moved[--movedCount];
+        auto pos = std::upper_bound(first, sortedEnd, child, isChildOrderLess);
+        write = std::move_backward(pos, sortedEnd, write);
+        *--write = child;
+        sortedEnd = pos;
+    }
+}
+
 // MARK: draw / visit
 
 void Node::draw()
@@ -1228,8 +1317,12 @@ uint32_t Node::processParentFlags(const Mat4& parentTransform, uint32_t parentFl
     flags |= (_contentSizeDirty ? FLAGS_CONTENT_SIZE_DIRTY : 0);
     
 
-    if(flags & FLAGS_DIRTY_MASK)
+    // the batched transform is stale if the node was moved in its own visit before this, e.g. Label::updateContent
+    if((flags & FLAGS_DIRTY_MASK) && (!_transformBatched || _transformDirty))
         _modelViewTransform = this->transform(parentTransform);
+
+    if (_transformUpdated || _contentSizeDirty)
+        ++s_transformVersion;
     
     _transformUpdated = false;
     _contentSizeDirty = false;
@@ -1267,13 +1360,17 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
     if(!_children.empty())
     {
         sortAllChildren();
+        batchChildrenTransforms(flags);
         // draw children zOrder < 0
         for(auto size = _children.size(); i < size; ++i)
         {
             auto node = _children.at(i);
 
             if (node && node->_localZOrder < 0)
+            {
                 node->visit(renderer, _modelViewTransform, flags);
+                node->_transformBatched = false;
+            }
             else
                 break;
         }
@@ -1282,7 +1379,10 @@ void Node::visit(Renderer* renderer, const Mat4 &parentTransform, uint32_t paren
             this->draw(renderer, _modelViewTransform, flags);
 
         for(auto it=_children.cbegin()+i, itCend = _children.cend(); it != itCend; ++it)
+        {
             (*it)->visit(renderer, _modelViewTransform, flags);
+            (*it)->_transformBatched = false;
+        }
     }
     else if (visibleByCamera)
     {
@@ -1302,6 +1402,42 @@ Mat4 Node::transform(const Mat4& parentTransform)
     return parentTransform * this->getNodeToParentTransform();
 }
 
+void Node::batchChildrenTransforms(uint32_t flags)
+{
+    // visit isn't reentrant across threads, the arrays are only reused to not allocate each frame
+    static std::vector<Node*> s_batchedChildren;
+    static std::vector<Mat4> s_batchedTransforms;
+
+    // same conditions as processParentFlags, the children using a normalized position update it there first
+    s_batchedChildren.clear();
+    for (const auto& child : _children)
+    {
+        if (child->_visible && !child->_usingNormalizedPosition
+            && ((flags & FLAGS_DIRTY_MASK) || child->_transformUpdated || child->_contentSizeDirty)
+            && child->isVisitableByVisitingCamera())
+        {
+            s_batchedChildren.push_back(child);
+        }
+    }
+
+    size_t count = s_batchedChildren.size();
+    if (count < MIN_BATCHED_CHILDREN_TRANSFORMS)
+        return;
+
+    if (s_batchedTransforms.size() < count)
+        s_batchedTransforms.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        s_batchedTransforms[i] = s_batchedChildren[i]->getNodeToParentTransform();
+    }
+    Mat4::multiply(_modelViewTransform, s_batchedTransforms.data(), s_batchedTransforms.data(), count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        s_batchedChildren[i]->_modelViewTransform = s_batchedTransforms[i];
+        s_batchedChildren[i]->_transformBatched = true;
+    }
+}
+
 // MARK: events
 
 void Node::onEnter()
@@ -2012,6 +2148,7 @@ void Node::setOpacity(GLubyte opacity)
 void Node::updateDisplayedOpacity(GLubyte parentOpacity)
 {
     _displayedOpacity = _realOpacity * parentOpacity/255.0;
+    s_sceneGraphDirty = true;
     updateColor();
     
     if (_cascadeOpacityEnabled)
@@ -2099,6 +2236,7 @@ void Node::updateDisplayedColor(const Color3B& parentColor)
     _displayedColor.r = _realColor.r * parentColor.r/255.0;
     _displayedColor.g = _realColor.g * parentColor.g/255.0;
     _displayedColor.b = _realColor.b * parentColor.b/255.0;
+    s_sceneGraphDirty = true;
     updateColor();
     
     if (_cascadeColorEnabled)
@@ -2203,6 +2341,7 @@ bool isScreenPointInRect(const Vec2 &pt, const Camera* camera, const Mat4& w2l,
 void Node::setCameraMask(unsigned short mask, bool applyChildren)
 {
     _cameraMask = mask;
+    s_sceneGraphDirty = true;
     if (applyChildren)
     {
         for (const auto& child : _children)
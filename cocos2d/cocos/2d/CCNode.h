@@ -132,6 +132,21 @@ public:
      * Gets count of nodes those are attached to scene graph.
      */
     static int getAttachedNodeCount();
+
+    /**
+     * Whether a node changed in a way that needs a redraw since the last rendered frame, e.g. a transform,
+     * a child added or removed, a color or a texture. Director uses it to skip the idle frames.
+     * Setting a Node::DirtyFlag, e.g. _transformUpdated or _contentSizeDirty, marks it.
+     * @since v3.17
+     */
+    static bool isSceneGraphDirty() { return s_sceneGraphDirty; }
+
+    /**
+     * Marks the scene graph as changed, e.g. by a custom node drawing different content,
+     * Director clears it after rendering a frame.
+     * @since v3.17
+     */
+    static void setSceneGraphDirty(bool dirty) { s_sceneGraphDirty = dirty; }
 public:
     
     /**
@@ -934,6 +949,8 @@ public:
     /**
      * Sorts the children array once before drawing, instead of every time when a child is added or reordered.
      * This approach can improves the performance massively.
+     * When a few children were added or reordered since the last sort, only those are moved to their place,
+     * with a binary search among the other ones. The resulting order is the same as a full sort.
      * @note Don't call this manually unless a child added needs to be removed in the same frame.
      */
     virtual void sortAllChildren();
@@ -1871,6 +1888,15 @@ protected:
     /// helper that reorder a child
     void insertChild(Node* child, int z);
 
+    /// marks the child to be moved to its place by the next sortAllChildren
+    void setChildReordered(Node* child);
+
+    /// sorts the children by moving the reordered ones, the other ones are still sorted
+    void sortReorderedChildren();
+
+    /// the order of sortNodes
+    static bool isChildOrderLess(Node* n1, Node* n2);
+
     /// Removes a child, call child->onExit(), do cleanup, remove it from children array.
     void detachChild(Node *child, ssize_t index, bool doCleanup);
 
@@ -1880,6 +1906,9 @@ protected:
     Mat4 transform(const Mat4 &parentTransform);
     uint32_t processParentFlags(const Mat4& parentTransform, uint32_t parentFlags);
 
+    /// computes the model view transform of the dirty children in one Mat4::multiply call, before visiting them
+    void batchChildrenTransforms(uint32_t flags);
+
     virtual void updateCascadeOpacity();
     virtual void disableCascadeOpacity();
     virtual void updateCascadeColor();
@@ -1901,6 +1930,30 @@ private:
     void addChildHelper(Node* child, int localZOrder, int tag, const std::string &name, bool setTag);
     
 protected:
+    /** A dirty flag of a node which marks the scene graph dirty when it is set, see isSceneGraphDirty.
+     * The subclasses setting it, e.g. _transformUpdated, don't need to mark the scene graph themselves.
+     * @since v3.17
+     */
+    class DirtyFlag
+    {
+    public:
+        DirtyFlag(bool dirty = false) : _dirty(dirty) {}
+        DirtyFlag(const DirtyFlag& other) = default;
+
+        DirtyFlag& operator=(bool dirty)
+        {
+            _dirty = dirty;
+            if (dirty)
+                s_sceneGraphDirty = true;
+            return *this;
+        }
+        DirtyFlag& operator=(const DirtyFlag& other) { return *this = other._dirty; }
+
+        operator bool() const { return _dirty; }
+
+    private:
+        bool _dirty;
+    };
 
     float _rotationX;               ///< rotation on the X-axis
     float _rotationY;               ///< rotation on the Y-axis
@@ -1928,7 +1981,7 @@ protected:
     Vec2 _anchorPoint;              ///< anchor point normalized (NOT in points)
 
     Size _contentSize;              ///< untransformed size of the node
-    bool _contentSizeDirty;         ///< whether or not the contentSize is dirty
+    DirtyFlag _contentSizeDirty;    ///< whether or not the contentSize is dirty
 
     Mat4 _modelViewTransform;       ///< ModelView transform of the Node.
 
@@ -1939,7 +1992,7 @@ protected:
     mutable bool _inverseDirty;     ///< inverse transform dirty flag
     mutable Mat4* _additionalTransform; ///< two transforms needed by additional transforms
     mutable bool _additionalTransformDirty; ///< transform dirty ?
-    bool _transformUpdated;         ///< Whether or not the Transform object was updated since the last frame
+    DirtyFlag _transformUpdated;    ///< Whether or not the Transform object was updated since the last frame
 
 #if CC_LITTLE_ENDIAN
     union {
@@ -1962,8 +2015,11 @@ protected:
     float _globalZOrder;            ///< Global order used to sort the node
 
     static std::uint32_t s_globalOrderOfArrival;
+    static std::uint32_t s_transformVersion;    ///< increased when a visit applies a transform or content size change
+    static bool s_sceneGraphDirty;              ///< set when the scene graph changes in a way that needs redrawing
 
     Vector<Node*> _children;        ///< array of children nodes
+    std::vector<Node*> _reorderedChildren;  ///< children added or reordered since the last sort, all of them are sorted if empty
     Node *_parent;                  ///< weak reference to parent node
     Director* _director;            //cached director pointer to improve rendering performance
     int _tag;                       ///< a tag. Can be any number you assigned just to identify this node
@@ -1989,7 +2045,8 @@ protected:
     bool _ignoreAnchorPointForPosition; ///< true if the Anchor Vec2 will be (0,0) when you position the Node, false otherwise.
                                           ///< Used by Layer and Scene.
 
-    bool _reorderChildDirty;          ///< children order dirty flag
+    DirtyFlag _reorderChildDirty;     ///< children order dirty flag
+    bool _transformBatched;           ///< _modelViewTransform was computed by batchChildrenTransforms of the parent
     bool _isTransitionFinished;       ///< flag to indicate whether the transition was finished
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -2034,6 +2091,8 @@ public:
     friend class PhysicsBody;
 #endif
 
+    friend class EventDispatcher;
+
     static int __attachedNodeCount;
     
 private:
@@ -40,9 +40,12 @@ THE SOFTWARE.
 #include "base/CCDirector.h"
 #include "base/ccUTF8.h"
 #include "2d/CCCamera.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(Sprite, 100)
+
 // MARK: create, init, dealloc
 Sprite* Sprite::createWithTexture(Texture2D *texture)
 {
@@ -405,6 +408,7 @@ void Sprite::setTexture(Texture2D *texture)
         CC_SAFE_RELEASE(_texture);
         _texture = texture;
         updateBlendFunc();
+        s_sceneGraphDirty = true;
     }
 }
 
@@ -432,6 +436,8 @@ void Sprite::setTextureRect(const Rect& rect, bool rotated, const Size& untrimme
 
 void Sprite::updatePoly()
 {
+    s_sceneGraphDirty = true;
+
     // There are 3 cases:
     //
     // A) a non 9-sliced, non stretched
@@ -1458,6 +1464,8 @@ bool Sprite::isFlippedY(void) const
 }
 
 void Sprite::flipX() {
+    s_sceneGraphDirty = true;
+
     if (_renderMode == RenderMode::QUAD_BATCHNODE)
     {
         setDirty(true);
@@ -1477,6 +1485,8 @@ void Sprite::flipX() {
 }
 
 void Sprite::flipY() {
+    s_sceneGraphDirty = true;
+
     if (_renderMode == RenderMode::QUAD_BATCHNODE)
     {
         setDirty(true);
@@ -1501,6 +1511,8 @@ void Sprite::flipY() {
 
 void Sprite::updateColor(void)
 {
+    s_sceneGraphDirty = true;
+
     Color4B color4( _displayedColor.r, _displayedColor.g, _displayedColor.b, _displayedOpacity );
 
     // special opacity for premultiplied textures
@@ -1727,6 +1739,7 @@ void Sprite::setPolygonInfo(const PolygonInfo& info)
 {
     _polyInfo = info;
     _renderMode = RenderMode::POLYGON;
+    s_sceneGraphDirty = true;
 }
 
 NS_CC_END
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "renderer/CCTrianglesCommand.h"
 #include "renderer/CCCustomCommand.h"
 #include "2d/CCAutoPolygon.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 NS_CC_BEGIN
 
@@ -545,6 +546,9 @@ public:
     int getResourceType() const { return _fileType; }
     const std::string& getResourceName() const { return _fileName; }
 
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(Sprite)
+
 CC_CONSTRUCTOR_ACCESS :
 	/**
      * @js ctor
@@ -30,6 +30,8 @@ THE SOFTWARE.
 
 #include "2d/CCSpriteFrameCache.h"
 
+#include <string.h>
+#include <algorithm>
 #include <vector>
 
 
@@ -50,6 +52,9 @@ NS_CC_BEGIN
 
 static SpriteFrameCache *_sharedSpriteFrameCache = nullptr;
 
+static const char SHEET_MAGIC[4] = { 'C', 'C', 'S', 'F' };
+static const uint32_t SHEET_VERSION = 1;
+
 SpriteFrameCache* SpriteFrameCache::getInstance()
 {
     if (! _sharedSpriteFrameCache)
@@ -76,6 +81,7 @@ bool SpriteFrameCache::init()
 
 SpriteFrameCache::~SpriteFrameCache()
 {
+    removeSpriteSheets();
     CC_SAFE_DELETE(_loadedFileNames);
 }
 
@@ -297,18 +303,9 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dictionary, Textu
     CC_SAFE_DELETE(image);
 }
 
-void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dict, const std::string &texturePath)
+// the texture with the pixel format of the sprite sheet metadata
+static Texture2D* addTextureWithPixelFormat(const std::string& texturePath, const std::string& pixelFormatName)
 {
-    std::string pixelFormatName;
-    if (dict.find("metadata") != dict.end())
-    {
-        ValueMap& metadataDict = dict.at("metadata").asValueMap();
-        if (metadataDict.find("pixelFormat") != metadataDict.end())
-        {
-            pixelFormatName = metadataDict.at("pixelFormat").asString();
-        }
-    }
-    
     Texture2D *texture = nullptr;
     static std::unordered_map<std::string, Texture2D::PixelFormat> pixelFormats = {
         {"RGBA8888", Texture2D::PixelFormat::RGBA8888},
@@ -338,6 +335,22 @@ void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dict, const std::
     {
         texture = Director::getInstance()->getTextureCache()->addImage(texturePath);
     }
+    return texture;
+}
+
+void SpriteFrameCache::addSpriteFramesWithDictionary(ValueMap& dict, const std::string &texturePath)
+{
+    std::string pixelFormatName;
+    if (dict.find("metadata") != dict.end())
+    {
+        ValueMap& metadataDict = dict.at("metadata").asValueMap();
+        if (metadataDict.find("pixelFormat") != metadataDict.end())
+        {
+            pixelFormatName = metadataDict.at("pixelFormat").asString();
+        }
+    }
+    
+    Texture2D *texture = addTextureWithPixelFormat(texturePath, pixelFormatName);
     
     if (texture)
     {
@@ -357,6 +370,12 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture
     }
     
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+    if (isSpriteSheetFile(plist))
+    {
+        addSpriteSheet(plist, FileUtils::getInstance()->getDataFromFile(fullPath), texture, "");
+        _loadedFileNames->insert(plist);
+        return;
+    }
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
     addSpriteFramesWithDictionary(dict, texture);
@@ -365,6 +384,13 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, Texture
 
 void SpriteFrameCache::addSpriteFramesWithFileContent(const std::string& plist_content, Texture2D *texture)
 {
+    if (plist_content.compare(0, sizeof(SHEET_MAGIC), SHEET_MAGIC, sizeof(SHEET_MAGIC)) == 0)
+    {
+        Data data;
+        data.copy((const unsigned char*)plist_content.data(), plist_content.size());
+        addSpriteSheet("", std::move(data), texture, "");
+        return;
+    }
     ValueMap dict = FileUtils::getInstance()->getValueMapFromData(plist_content.c_str(), static_cast<int>(plist_content.size()));
     addSpriteFramesWithDictionary(dict, texture);
 }
@@ -378,6 +404,12 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist, const s
     }
     
     const std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+    if (isSpriteSheetFile(plist))
+    {
+        addSpriteSheet(plist, FileUtils::getInstance()->getDataFromFile(fullPath), nullptr, textureFileName);
+        _loadedFileNames->insert(plist);
+        return;
+    }
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
     addSpriteFramesWithDictionary(dict, textureFileName);
     _loadedFileNames->insert(plist);
@@ -395,7 +427,12 @@ void SpriteFrameCache::addSpriteFramesWithFile(const std::string& plist)
         return;
     }
 
-    if (_loadedFileNames->find(plist) == _loadedFileNames->end())
+    if (_loadedFileNames->find(plist) == _loadedFileNames->end() && isSpriteSheetFile(plist))
+    {
+        addSpriteSheet(plist, FileUtils::getInstance()->getDataFromFile(fullPath), nullptr, "");
+        _loadedFileNames->insert(plist);
+    }
+    else if (_loadedFileNames->find(plist) == _loadedFileNames->end())
     {
         ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
@@ -452,6 +489,7 @@ void SpriteFrameCache::addSpriteFrame(SpriteFrame* frame, const std::string& fra
 
 void SpriteFrameCache::removeSpriteFrames()
 {
+    removeSpriteSheets();
     _spriteFrames.clear();
     _spriteFramesAliases.clear();
     _loadedFileNames->clear();
@@ -476,6 +514,13 @@ void SpriteFrameCache::removeUnusedSpriteFrames()
 
     _spriteFrames.erase(toRemoveFrames);
 
+    // the frames of the sprite sheets not created yet are unused
+    if (!_spriteSheets.empty())
+    {
+        removeSpriteSheets();
+        removed = true;
+    }
+
     // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     if( removed )
     {
@@ -504,6 +549,23 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
         _spriteFrames.erase(name);
     }
 
+    // the sprite sheets don't create it again
+    for (auto sheet : _spriteSheets)
+    {
+        int index = findSheetFrame(sheet, name);
+        int aliasIndex = index < 0 ? findSheetAlias(sheet, name) : -1;
+        if (aliasIndex >= 0)
+        {
+            index = sheet->aliases[aliasIndex].frameIndex;
+            const tSheetFrame& frame = sheet->frames[index];
+            _spriteFrames.erase(getSheetString(sheet, frame.nameOffset, frame.nameLength));
+        }
+        if (index >= 0)
+        {
+            sheet->created[index] = true;
+        }
+    }
+
     // FIXME:. Since we don't know the .plist file that originated the frame, we must remove all .plist from the cache
     _loadedFileNames->clear();
 }
@@ -511,6 +573,29 @@ void SpriteFrameCache::removeSpriteFrameByName(const std::string& name)
 void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 {
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
+    if (isSpriteSheetFile(plist))
+    {
+        auto iter = std::find_if(_spriteSheets.begin(), _spriteSheets.end(), [&plist](const tSpriteSheet* sheet) {
+            return sheet->file == plist;
+        });
+        tSpriteSheet sheet = tSpriteSheet();
+        if (iter != _spriteSheets.end())
+        {
+            removeSpriteFramesFromSheet(*iter);
+        }
+        else if (initSpriteSheet(&sheet, FileUtils::getInstance()->getDataFromFile(fullPath)))
+        {
+            removeSpriteFramesFromSheet(&sheet);
+        }
+        else
+        {
+            CCLOG("cocos2d:SpriteFrameCache:removeSpriteFramesFromFile: create sprite sheet by %s fail.", plist.c_str());
+            return;
+        }
+        removeSpriteSheet(plist);
+        _loadedFileNames->erase(plist);
+        return;
+    }
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
     if (dict.empty())
     {
@@ -529,6 +614,17 @@ void SpriteFrameCache::removeSpriteFramesFromFile(const std::string& plist)
 
 void SpriteFrameCache::removeSpriteFramesFromFileContent(const std::string& plist_content)
 {
+    if (plist_content.compare(0, sizeof(SHEET_MAGIC), SHEET_MAGIC, sizeof(SHEET_MAGIC)) == 0)
+    {
+        tSpriteSheet sheet = tSpriteSheet();
+        Data data;
+        data.copy((const unsigned char*)plist_content.data(), plist_content.size());
+        if (initSpriteSheet(&sheet, std::move(data)))
+        {
+            removeSpriteFramesFromSheet(&sheet);
+        }
+        return;
+    }
     ValueMap dict = FileUtils::getInstance()->getValueMapFromData(plist_content.data(), static_cast<int>(plist_content.size()));
     if (dict.empty())
     {
@@ -572,11 +668,29 @@ void SpriteFrameCache::removeSpriteFramesFromTexture(Texture2D* texture)
     }
 
     _spriteFrames.erase(keysToRemove);
+
+    for (auto iter = _spriteSheets.begin(); iter != _spriteSheets.end(); )
+    {
+        if ((*iter)->texture == texture)
+        {
+            CC_SAFE_RELEASE((*iter)->texture);
+            delete *iter;
+            iter = _spriteSheets.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
 }
 
 SpriteFrame* SpriteFrameCache::getSpriteFrameByName(const std::string& name)
 {
     SpriteFrame* frame = _spriteFrames.at(name);
+    if (!frame && !_spriteSheets.empty())
+    {
+        frame = createSpriteFrameFromSheets(name);
+    }
     if (!frame)
     {
         // try alias dictionary
@@ -725,6 +839,38 @@ bool SpriteFrameCache::reloadTexture(const std::string& plist)
         return false;
     }
 
+    if (isSpriteSheetFile(plist))
+    {
+        auto sheetIter = std::find_if(_spriteSheets.begin(), _spriteSheets.end(), [&plist](const tSpriteSheet* sheet) {
+            return sheet->file == plist;
+        });
+        if (sheetIter == _spriteSheets.end())
+            return false;
+
+        tSpriteSheet* sheet = *sheetIter;
+        auto textureCache = Director::getInstance()->getTextureCache();
+        std::string texturePath = textureCache->getTextureFilePath(sheet->texture);
+        Texture2D *texture = nullptr;
+        if (textureCache->reloadTexture(texturePath))
+            texture = textureCache->getTextureForKey(texturePath);
+
+        if (texture)
+        {
+            // the frames are created again with the texture
+            removeSpriteFramesFromSheet(sheet);
+            texture->retain();
+            sheet->texture->release();
+            sheet->texture = texture;
+            sheet->created.assign(sheet->header->frameCount, false);
+            _loadedFileNames->insert(plist);
+        }
+        else
+        {
+            CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        }
+        return true;
+    }
+
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(plist);
     ValueMap dict = FileUtils::getInstance()->getValueMapFromFile(fullPath);
 
@@ -771,4 +917,260 @@ bool SpriteFrameCache::reloadTexture(const std::string& plist)
     return true;
 }
 
+// --------------------- binary sprite sheets ---------------------
+
+bool SpriteFrameCache::isSpriteSheetFile(const std::string& file)
+{
+    return FileUtils::getInstance()->getFileExtension(file) == ".ccsheet";
+}
+
+bool SpriteFrameCache::initSpriteSheet(tSpriteSheet* sheet, Data data)
+{
+    static_assert(sizeof(tSheetHeader) == 48 && sizeof(tSheetFrame) == 64 && sizeof(tSheetAlias) == 12, "the sprite sheets are read in place");
+
+    sheet->data = std::move(data);
+    // a borrowed buffer may be unaligned, e.g. a file stored in the obb file, which faults on ARMv7
+    if (sheet->data.isBorrowed() && reinterpret_cast<uintptr_t>(sheet->data.getBytes()) % alignof(tSheetFrame) != 0)
+    {
+        sheet->data.copy(sheet->data.getBytes(), sheet->data.getSize());
+    }
+    const unsigned char* bytes = sheet->data.getBytes();
+    uint64_t size = sheet->data.getSize();
+    if (size < sizeof(tSheetHeader) || memcmp(bytes, SHEET_MAGIC, sizeof(SHEET_MAGIC)) != 0)
+        return false;
+
+    auto header = (const tSheetHeader*)bytes;
+    uint64_t framesOffset = sizeof(tSheetHeader);
+    uint64_t aliasesOffset = framesOffset + (uint64_t)header->frameCount * sizeof(tSheetFrame);
+    uint64_t polygonsOffset = aliasesOffset + (uint64_t)header->aliasCount * sizeof(tSheetAlias);
+    uint64_t stringsOffset = polygonsOffset + (uint64_t)header->polygonDataCount * sizeof(int32_t);
+    if (header->version != SHEET_VERSION || stringsOffset + header->stringsSize > size)
+        return false;
+
+    sheet->header = header;
+    sheet->frames = (const tSheetFrame*)(bytes + framesOffset);
+    sheet->aliases = (const tSheetAlias*)(bytes + aliasesOffset);
+    sheet->polygons = (const int32_t*)(bytes + polygonsOffset);
+    sheet->strings = (const char*)(bytes + stringsOffset);
+
+    // the lookups trust the sheet from now on
+    uint64_t stringsSize = header->stringsSize;
+    bool valid = (uint64_t)header->textureNameOffset + header->textureNameLength <= stringsSize
+        && (uint64_t)header->pixelFormatOffset + header->pixelFormatLength <= stringsSize;
+    for (uint32_t i = 0; i < header->frameCount && valid; ++i)
+    {
+        const tSheetFrame& frame = sheet->frames[i];
+        valid = (uint64_t)frame.nameOffset + frame.nameLength <= stringsSize
+            && (!(frame.flags & SHEET_FRAME_POLYGON)
+                || (uint64_t)frame.polygonOffset + (uint64_t)frame.vertexCount * 4 + frame.indexCount <= header->polygonDataCount);
+    }
+    for (uint32_t i = 0; i < header->aliasCount && valid; ++i)
+    {
+        const tSheetAlias& alias = sheet->aliases[i];
+        valid = (uint64_t)alias.nameOffset + alias.nameLength <= stringsSize && alias.frameIndex < header->frameCount;
+    }
+    return valid;
+}
+
+std::string SpriteFrameCache::getSheetString(const tSpriteSheet* sheet, uint32_t offset, uint32_t length)
+{
+    return std::string(sheet->strings + offset, length);
+}
+
+// the frames and aliases are sorted by name, bytewise
+template <typename T>
+static int findSheetName(const T* items, uint32_t count, const char* strings, const std::string& name)
+{
+    auto end = items + count;
+    auto it = std::lower_bound(items, end, name, [strings](const T& item, const std::string& key) {
+        int cmp = memcmp(strings + item.nameOffset, key.data(), std::min((size_t)item.nameLength, key.size()));
+        return cmp < 0 || (cmp == 0 && item.nameLength < key.size());
+    });
+
+    if (it == end || it->nameLength != name.size() || memcmp(strings + it->nameOffset, name.data(), name.size()) != 0)
+        return -1;
+    return (int)(it - items);
+}
+
+int SpriteFrameCache::findSheetFrame(const tSpriteSheet* sheet, const std::string& name)
+{
+    return findSheetName(sheet->frames, sheet->header->frameCount, sheet->strings, name);
+}
+
+int SpriteFrameCache::findSheetAlias(const tSpriteSheet* sheet, const std::string& name)
+{
+    return findSheetName(sheet->aliases, sheet->header->aliasCount, sheet->strings, name);
+}
+
+void SpriteFrameCache::addSpriteSheet(const std::string& file, Data data, Texture2D* texture, const std::string& textureFileName)
+{
+    auto sheet = new (std::nothrow) tSpriteSheet();
+    if (!initSpriteSheet(sheet, std::move(data)))
+    {
+        CCLOG("cocos2d: SpriteFrameCache: %s isn't a valid sprite sheet", file.c_str());
+        delete sheet;
+        return;
+    }
+
+    const tSheetHeader* header = sheet->header;
+    if (!texture)
+    {
+        std::string texturePath = textureFileName;
+        if (texturePath.empty())
+        {
+            texturePath = getSheetString(sheet, header->textureNameOffset, header->textureNameLength);
+            if (!texturePath.empty())
+            {
+                // build texture path relative to the sheet file
+                texturePath = FileUtils::getInstance()->fullPathFromRelativeFile(texturePath, file);
+            }
+            else
+            {
+                // build texture path by replacing file extension
+                texturePath = file.substr(0, file.find_last_of('.')) + ".png";
+                CCLOG("cocos2d: SpriteFrameCache: Trying to use file %s as texture", texturePath.c_str());
+            }
+        }
+        texture = addTextureWithPixelFormat(texturePath, getSheetString(sheet, header->pixelFormatOffset, header->pixelFormatLength));
+    }
+    if (!texture)
+    {
+        CCLOG("cocos2d: SpriteFrameCache: Couldn't load texture");
+        delete sheet;
+        return;
+    }
+
+    texture->retain();
+    sheet->texture = texture;
+    sheet->file = file;
+    sheet->created.assign(header->frameCount, false);
+    if (!file.empty())
+    {
+        removeSpriteSheet(file);
+    }
+    _spriteSheets.push_back(sheet);
+}
+
+SpriteFrame* SpriteFrameCache::createSpriteFrameFromSheets(const std::string& name)
+{
+    for (auto sheet : _spriteSheets)
+    {
+        int index = findSheetFrame(sheet, name);
+        if (index >= 0 && !sheet->created[index])
+        {
+            return createSpriteFrameFromSheet(sheet, index);
+        }
+    }
+
+    for (auto sheet : _spriteSheets)
+    {
+        int aliasIndex = findSheetAlias(sheet, name);
+        if (aliasIndex < 0)
+            continue;
+
+        uint32_t index = sheet->aliases[aliasIndex].frameIndex;
+        if (!sheet->created[index])
+        {
+            return createSpriteFrameFromSheet(sheet, index);
+        }
+        const tSheetFrame& frame = sheet->frames[index];
+        SpriteFrame* spriteFrame = _spriteFrames.at(getSheetString(sheet, frame.nameOffset, frame.nameLength));
+        if (spriteFrame)
+        {
+            return spriteFrame;
+        }
+    }
+    return nullptr;
+}
+
+SpriteFrame* SpriteFrameCache::createSpriteFrameFromSheet(tSpriteSheet* sheet, int frameIndex)
+{
+    const tSheetFrame& frame = sheet->frames[frameIndex];
+    std::string spriteFrameName = getSheetString(sheet, frame.nameOffset, frame.nameLength);
+    Size sourceSize(frame.sourceWidth, frame.sourceHeight);
+
+    // create frame
+    SpriteFrame* spriteFrame = SpriteFrame::createWithTexture(sheet->texture,
+                                                              Rect(frame.x, frame.y, frame.width, frame.height),
+                                                              (frame.flags & SHEET_FRAME_ROTATED) != 0,
+                                                              Vec2(frame.offsetX, frame.offsetY),
+                                                              sourceSize);
+
+    if (frame.flags & SHEET_FRAME_POLYGON)
+    {
+        const int32_t* vertices = sheet->polygons + frame.polygonOffset;
+        const int32_t* verticesUV = vertices + frame.vertexCount * 2;
+        const int32_t* indices = verticesUV + frame.vertexCount * 2;
+
+        PolygonInfo info;
+        initializePolygonInfo(Size(sheet->header->textureWidth, sheet->header->textureHeight), sourceSize,
+                              std::vector<int>(vertices, verticesUV),
+                              std::vector<int>(verticesUV, indices),
+                              std::vector<int>(indices, indices + frame.indexCount),
+                              info);
+        spriteFrame->setPolygonInfo(info);
+    }
+    if (frame.flags & SHEET_FRAME_ANCHOR)
+    {
+        spriteFrame->setAnchorPoint(Vec2(frame.anchorX, frame.anchorY));
+    }
+
+    if (NinePatchImageParser::isNinePatchImage(spriteFrameName))
+    {
+        Image* image = new (std::nothrow) Image();
+        image->initWithImageFile(Director::getInstance()->getTextureCache()->getTextureFilePath(sheet->texture));
+        NinePatchImageParser parser;
+        parser.setSpriteFrameInfo(image, spriteFrame->getRectInPixels(), spriteFrame->isRotated());
+        sheet->texture->addSpriteFrameCapInset(spriteFrame, parser.parseCapInset());
+        CC_SAFE_DELETE(image);
+    }
+
+    sheet->created[frameIndex] = true;
+    _spriteFrames.insert(spriteFrameName, spriteFrame);
+    return spriteFrame;
+}
+
+void SpriteFrameCache::removeSpriteFramesFromSheet(const tSpriteSheet* sheet)
+{
+    std::vector<std::string> keysToRemove;
+    for (uint32_t i = 0; i < sheet->header->frameCount; ++i)
+    {
+        const tSheetFrame& frame = sheet->frames[i];
+        std::string name = getSheetString(sheet, frame.nameOffset, frame.nameLength);
+        if (_spriteFrames.at(name))
+        {
+            keysToRemove.push_back(name);
+        }
+    }
+
+    _spriteFrames.erase(keysToRemove);
+}
+
+void SpriteFrameCache::removeSpriteSheet(const std::string& file)
+{
+    for (auto iter = _spriteSheets.begin(); iter != _spriteSheets.end(); )
+    {
+        if ((*iter)->file == file)
+        {
+            CC_SAFE_RELEASE((*iter)->texture);
+            delete *iter;
+            iter = _spriteSheets.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
+void SpriteFrameCache::removeSpriteSheets()
+{
+    for (auto sheet : _spriteSheets)
+    {
+        CC_SAFE_RELEASE(sheet->texture);
+        delete sheet;
+    }
+    _spriteSheets.clear();
+}
+
 NS_CC_END
@@ -31,12 +31,15 @@ THE SOFTWARE.
 #ifndef __SPRITE_CCSPRITE_FRAME_CACHE_H__
 #define __SPRITE_CCSPRITE_FRAME_CACHE_H__
 
+#include <stdint.h>
 #include <set>
 #include <string>
+#include <vector>
 #include "2d/CCSpriteFrame.h"
 #include "base/CCRef.h"
 #include "base/CCValue.h"
 #include "base/CCMap.h"
+#include "base/CCData.h"
 
 NS_CC_BEGIN
 
@@ -81,6 +84,10 @@ class PolygonInfo;
  Use one of the following tools to create the .plist file and sprite sheet:
  - [TexturePacker](https://www.codeandweb.com/texturepacker/cocos2d)
  - [Zwoptex](https://zwopple.com/zwoptex/)
+
+ A .plist file can be converted to a binary sprite sheet, a .ccsheet file, by tools/sprite-sheet/ccsheet.py.
+ The .ccsheet files are loaded by the same methods without parsing, and their sprite frames are only created
+ by their first getSpriteFrameByName (since v3.17).
  
  @since v0.9
  @js cc.spriteFrameCache
@@ -270,9 +277,89 @@ protected:
 
     void reloadSpriteFramesWithDictionary(ValueMap& dictionary, Texture2D *texture);
 
+    /*
+     * Binary sprite sheet, read in place, all the integers are little endian:
+     *
+     *     header   : tSheetHeader
+     *     frames   : frameCount * tSheetFrame, sorted by name, bytewise
+     *     aliases  : aliasCount * tSheetAlias, sorted by name, bytewise
+     *     polygons : polygonDataCount * int32, the vertices, verticesUV then triangles of the polygon frames
+     *     strings  : stringsSize bytes, the names, not terminated
+     */
+    typedef struct _sheetHeader
+    {
+        char magic[4];                  // "CCSF"
+        uint32_t version;               // 1
+        uint32_t frameCount;
+        uint32_t aliasCount;
+        uint32_t polygonDataCount;
+        uint32_t stringsSize;
+        uint32_t textureNameOffset;     // relative to the sheet, the sheet name with .png when empty
+        uint32_t textureNameLength;
+        uint32_t pixelFormatOffset;     // e.g. RGBA4444, the default alpha pixel format when empty
+        uint32_t pixelFormatLength;
+        float textureWidth;             // for the polygon frames
+        float textureHeight;
+    } tSheetHeader;
+
+    enum
+    {
+        SHEET_FRAME_ROTATED = 1,
+        SHEET_FRAME_ANCHOR = 2,
+        SHEET_FRAME_POLYGON = 4,
+    };
+
+    typedef struct _sheetFrame
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        float x, y, width, height;      // the rect in the texture
+        float offsetX, offsetY;
+        float sourceWidth, sourceHeight;
+        float anchorX, anchorY;
+        uint32_t flags;
+        uint32_t vertexCount;           // x and y of each vertex
+        uint32_t indexCount;
+        uint32_t polygonOffset;         // in the polygon data
+    } tSheetFrame;
+
+    typedef struct _sheetAlias
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint32_t frameIndex;
+    } tSheetAlias;
+
+    typedef struct _spriteSheet
+    {
+        std::string file;
+        Data data;
+        Texture2D* texture;
+        const tSheetHeader* header;
+        const tSheetFrame* frames;
+        const tSheetAlias* aliases;
+        const int32_t* polygons;
+        const char* strings;
+        std::vector<bool> created;      // the frames created or removed, they aren't created again
+    } tSpriteSheet;
+
+    static bool isSpriteSheetFile(const std::string& file);
+    static bool initSpriteSheet(tSpriteSheet* sheet, Data data);
+    static std::string getSheetString(const tSpriteSheet* sheet, uint32_t offset, uint32_t length);
+    static int findSheetFrame(const tSpriteSheet* sheet, const std::string& name);
+    static int findSheetAlias(const tSpriteSheet* sheet, const std::string& name);
+
+    void addSpriteSheet(const std::string& file, Data data, Texture2D* texture, const std::string& textureFileName);
+    SpriteFrame* createSpriteFrameFromSheets(const std::string& name);
+    SpriteFrame* createSpriteFrameFromSheet(tSpriteSheet* sheet, int frameIndex);
+    void removeSpriteFramesFromSheet(const tSpriteSheet* sheet);
+    void removeSpriteSheet(const std::string& file);
+    void removeSpriteSheets();
+
     Map<std::string, SpriteFrame*> _spriteFrames;
     ValueMap _spriteFramesAliases;
     std::set<std::string>*  _loadedFileNames;
+    std::vector<tSpriteSheet*> _spriteSheets;   // in the loading order, the first one has the precedence
 };
 
 // end of _2d group
@@ -107,6 +107,7 @@ math/Vec4.cpp \
 base/CCNinePatchImageParser.cpp \
 base/CCStencilStateManager.cpp \
 base/CCAsyncTaskPool.cpp \
+base/CCFileIOPool.cpp \
 base/CCAutoreleasePool.cpp \
 base/CCConfiguration.cpp \
 base/CCConsole.cpp \
@@ -135,6 +136,7 @@ base/CCEventTouch.cpp \
 base/CCIMEDispatcher.cpp \
 base/CCNS.cpp \
 base/CCProfiling.cpp \
+base/CCTracing.cpp \
 base/CCProperties.cpp \
 base/CCRef.cpp \
 base/CCScheduler.cpp \
@@ -143,11 +145,15 @@ base/CCTouch.cpp \
 base/CCUserDefault-android.cpp \
 base/CCUserDefault.cpp \
 base/CCValue.cpp \
+base/CCValueDocument.cpp \
+base/CCStreamReader.cpp \
 base/ObjectFactory.cpp \
 base/TGAlib.cpp \
 base/ZipUtils.cpp \
+base/CCAssetPack.cpp \
 base/allocator/CCAllocatorDiagnostics.cpp \
 base/allocator/CCAllocatorGlobal.cpp \
+base/allocator/CCAllocatorStrategyFrame.cpp \
 base/allocator/CCAllocatorGlobalNewDelete.cpp \
 base/atitc.cpp \
 base/base64.cpp \
@@ -157,6 +163,7 @@ base/ccRandom.cpp \
 base/ccTypes.cpp \
 base/ccUTF8.cpp \
 base/ccUtils.cpp \
+base/ccPixelUtils.cpp \
 base/etc1.cpp \
 base/pvr.cpp \
 base/s3tc.cpp \
@@ -30,6 +30,7 @@
 #include <queue>
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
+#include "base/CCTracing.h"
 
 #if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
 #include "audio/android/AudioEngine-inl.h"
@@ -118,6 +119,7 @@ public:
 private:
     void threadFunc()
     {
+        Tracer::setThreadName("AudioEngine");
         while (true) {
             std::function<void()> task = nullptr;
             {
@@ -138,6 +140,7 @@ private:
                 }
             }
 
+            CC_TRACE_SCOPE("AudioEngine::task");
             task();
         }
     }
@@ -189,6 +192,7 @@ bool AudioEngine::lazyInit()
 
 int AudioEngine::play2d(const std::string& filePath, bool loop, float volume, const AudioProfile *profile)
 {
+    CC_TRACE_SCOPE("AudioEngine::play2d");
     int ret = AudioEngine::INVALID_AUDIO_ID;
 
     do {
@@ -535,6 +539,7 @@ AudioProfile* AudioEngine::getProfile(const std::string &name)
 
 void AudioEngine::preload(const std::string& filePath, std::function<void(bool isSuccess)> callback)
 {
+    CC_TRACE_SCOPE("AudioEngine::preload");
     if (!isEnabled())
     {
         callback(false);
@@ -0,0 +1,244 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCAssetPack.h"
+
+#include <string.h>
+#include <algorithm>
+#include <zlib.h>
+
+#include "base/ccMacros.h"
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+#include <windows.h>
+#elif (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+NS_CC_BEGIN
+
+static const char PACK_MAGIC[4] = { 'C', 'C', 'P', 'K' };
+static const uint32_t PACK_VERSION = 1;
+static const size_t PACK_HEADER_SIZE = 16;
+
+AssetPack::AssetPack()
+: _bytes(nullptr)
+, _size(0)
+, _mapped(false)
+, _entries(nullptr)
+, _names(nullptr)
+, _entryCount(0)
+{
+    static_assert(sizeof(tEntry) == 32, "the entries are read in place");
+}
+
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+void AssetPack::close()
+{
+    if (_mapped)
+    {
+        unmapFile(_bytes, _size);
+    }
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+    _mapped = false;
+    _entries = nullptr;
+    _names = nullptr;
+    _entryCount = 0;
+}
+
+// read-only mapping, writing in the buffers given to Data::borrow faults instead of altering the pack
+unsigned char* AssetPack::mapFile(const std::string& fullPath, size_t* size)
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    int length = MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, nullptr, 0);
+    std::wstring widePath(length, L'\0');
+    MultiByteToWideChar(CP_UTF8, 0, fullPath.c_str(), -1, &widePath[0], length);
+
+    HANDLE file = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+        return nullptr;
+
+    void* bytes = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    *size = (size_t)fileSize.QuadPart;
+    return (unsigned char*)bytes;
+#elif (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    int fd = ::open(fullPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat statBuf;
+    void* bytes = MAP_FAILED;
+    if (fstat(fd, &statBuf) == 0 && statBuf.st_size > 0)
+        bytes = mmap(nullptr, statBuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (bytes == MAP_FAILED)
+        return nullptr;
+
+    *size = statBuf.st_size;
+    return (unsigned char*)bytes;
+#else
+    return nullptr;
+#endif
+}
+
+void AssetPack::unmapFile(unsigned char* bytes, size_t size)
+{
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32)
+    UnmapViewOfFile(bytes);
+#elif (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    munmap(bytes, size);
+#endif
+}
+
+bool AssetPack::open(const std::string& fullPath)
+{
+    close();
+
+    _bytes = mapFile(fullPath, &_size);
+    _mapped = _bytes != nullptr;
+    if (!_mapped)
+    {
+        // e.g. in the Android APK
+        if (FileUtils::getInstance()->getContents(fullPath, &_data) != FileUtils::Status::OK)
+        {
+            CCLOG("AssetPack: can't open %s", fullPath.c_str());
+            return false;
+        }
+        _bytes = _data.getBytes();
+        _size = _data.getSize();
+    }
+
+    do
+    {
+        CC_BREAK_IF(_size < PACK_HEADER_SIZE || memcmp(_bytes, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0);
+
+        uint32_t header[3];
+        memcpy(header, _bytes + sizeof(PACK_MAGIC), sizeof(header));
+        CC_BREAK_IF(header[0] != PACK_VERSION);
+
+        uint64_t entryCount = header[1];
+        uint64_t namesSize = header[2];
+        CC_BREAK_IF(PACK_HEADER_SIZE + entryCount * sizeof(tEntry) + namesSize > _size);
+
+        _entries = (const tEntry*)(_bytes + PACK_HEADER_SIZE);
+        _names = (const char*)(_entries + entryCount);
+        _entryCount = (unsigned int)entryCount;
+
+        // the lookups trust the index from now on
+        bool valid = true;
+        for (unsigned int i = 0; i < _entryCount && valid; ++i)
+        {
+            const auto& entry = _entries[i];
+            valid = (uint64_t)entry.nameOffset + entry.nameLength <= namesSize
+                && entry.dataOffset <= _size && entry.storedSize <= _size - entry.dataOffset
+                && (entry.compression == STORED ? entry.storedSize == entry.size : entry.compression == ZLIB);
+        }
+        CC_BREAK_IF(!valid);
+
+        return true;
+    } while (0);
+
+    CCLOG("AssetPack: %s isn't a valid pack", fullPath.c_str());
+    close();
+    return false;
+}
+
+const AssetPack::tEntry* AssetPack::findEntry(const std::string& path) const
+{
+    auto end = _entries + _entryCount;
+    auto it = std::lower_bound(_entries, end, path, [this](const tEntry& entry, const std::string& key) {
+        int cmp = memcmp(_names + entry.nameOffset, key.data(), std::min((size_t)entry.nameLength, key.size()));
+        return cmp < 0 || (cmp == 0 && entry.nameLength < key.size());
+    });
+
+    if (it == end || it->nameLength != path.size() || memcmp(_names + it->nameOffset, path.data(), path.size()) != 0)
+        return nullptr;
+    return it;
+}
+
+bool AssetPack::fileExists(const std::string& path) const
+{
+    return findEntry(path) != nullptr;
+}
+
+long AssetPack::getFileSize(const std::string& path) const
+{
+    auto entry = findEntry(path);
+    return entry ? (long)entry->size : -1;
+}
+
+FileUtils::Status AssetPack::getContents(const std::string& path, ResizableBuffer* buffer) const
+{
+    auto entry = findEntry(path);
+    if (!entry)
+        return FileUtils::Status::NotExists;
+
+    buffer->resize(entry->size);
+    if (entry->size == 0)
+        return FileUtils::Status::OK;
+
+    if (entry->compression == STORED)
+    {
+        memcpy(buffer->buffer(), _bytes + entry->dataOffset, entry->size);
+        return FileUtils::Status::OK;
+    }
+
+    uLongf size = entry->size;
+    if (uncompress((Bytef*)buffer->buffer(), &size, _bytes + entry->dataOffset, entry->storedSize) != Z_OK || size != entry->size)
+    {
+        buffer->resize(0);
+        return FileUtils::Status::ReadFailed;
+    }
+    return FileUtils::Status::OK;
+}
+
+unsigned char* AssetPack::getMappedData(const std::string& path, ssize_t* size) const
+{
+    auto entry = findEntry(path);
+    if (!entry || entry->compression != STORED)
+        return nullptr;
+
+    *size = entry->size;
+    return _bytes + entry->dataOffset;
+}
+
+NS_CC_END
@@ -0,0 +1,133 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_ASSET_PACK_H__
+#define __CC_ASSET_PACK_H__
+/// @cond DO_NOT_SHOW
+
+#include <stdint.h>
+#include <string>
+
+#include "platform/CCFileUtils.h"
+#include "base/CCData.h"
+
+NS_CC_BEGIN
+
+/**
+ * Read-only pack of files, mapped in memory and mounted in FileUtils with FileUtils::mountPack.
+ * Built by tools/asset-pack/ccpack.py, all the integers are little endian:
+ *
+ *     header  : char magic[4] = "CCPK", uint32 version = 1, uint32 entryCount, uint32 namesSize
+ *     entries : entryCount * { uint32 nameOffset, uint32 nameLength, uint64 dataOffset,
+ *                              uint32 storedSize, uint32 size, uint32 compression, uint32 reserved }
+ *               sorted by name, bytewise
+ *     names   : namesSize bytes, the paths relative to the pack root with '/' separators, not terminated
+ *     data    : the entries, from the start of the pack, compression is 0 for stored or 1 for zlib
+ *
+ * The pack is mapped read-only where possible, the stored entries are then served without copy.
+ * Otherwise, e.g. for a pack in the Android APK, it is read in memory once.
+ *
+ * @since v3.17
+ */
+class CC_DLL AssetPack
+{
+public:
+    enum Compression
+    {
+        STORED = 0,
+        ZLIB = 1,
+    };
+
+    AssetPack();
+    virtual ~AssetPack();
+
+    /**
+     * Maps a pack and checks its index.
+     *
+     * @param fullPath The full path of the pack.
+     * @return True if the pack is valid.
+     */
+    bool open(const std::string& fullPath);
+
+    /** Number of files in the pack. */
+    unsigned int getEntryCount() const { return _entryCount; }
+
+    /** Check whether a path relative to the pack root is in the pack. */
+    bool fileExists(const std::string& path) const;
+
+    /** Gets the uncompressed size of a file, -1 if it isn't in the pack. */
+    long getFileSize(const std::string& path) const;
+
+    /**
+     * Gets the contents of a file, inflating it if needed.
+     *
+     * @return Status::OK, Status::NotExists or Status::ReadFailed if a compressed entry is corrupted.
+     */
+    FileUtils::Status getContents(const std::string& path, ResizableBuffer* buffer) const;
+
+    /**
+     * Gets a stored file in place, valid as long as the pack is open.
+     *
+     * @param[out] size The size of the file.
+     * @return The file bytes, nullptr if the file isn't in the pack or is compressed.
+     */
+    unsigned char* getMappedData(const std::string& path, ssize_t* size) const;
+
+    /**
+     * Maps a file read-only, also used by ZipFile.
+     *
+     * @param[out] size The size of the file.
+     * @return The file bytes to give to unmapFile, nullptr if the file can't be mapped, e.g. on WinRT or if it is empty.
+     */
+    static unsigned char* mapFile(const std::string& fullPath, size_t* size);
+    static void unmapFile(unsigned char* bytes, size_t size);
+
+private:
+    typedef struct _entry
+    {
+        uint32_t nameOffset;
+        uint32_t nameLength;
+        uint64_t dataOffset;
+        uint32_t storedSize;
+        uint32_t size;
+        uint32_t compression;
+        uint32_t reserved;
+    } tEntry;
+
+    const tEntry* findEntry(const std::string& path) const;
+    void close();
+
+    unsigned char* _bytes;
+    size_t _size;
+    bool _mapped;
+    Data _data;                 // the pack read in memory when it can't be mapped
+    const tEntry* _entries;
+    const char* _names;
+    unsigned int _entryCount;
+};
+
+NS_CC_END
+
+/// @endcond
+#endif // __CC_ASSET_PACK_H__
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #include "platform/CCPlatformMacros.h"
 #include "base/CCDirector.h"
 #include "base/CCScheduler.h"
+#include "base/allocator/CCAllocatorStrategyFrame.h"
 #include <vector>
 #include <queue>
 #include <memory>
@@ -141,6 +142,8 @@ protected:
                                           }
                                           
                                           task();
+                                          // the task's transient allocations are dead, like those of a frame
+                                          allocator::AllocatorStrategyFrame::getThreadAllocator().reset();
                                           Director::getInstance()->getScheduler()->performFunctionInCocosThread(std::bind(callback.callback, callback.callbackParam));
                                       }
                                   }
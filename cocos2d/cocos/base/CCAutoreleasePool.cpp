@@ -25,6 +25,7 @@ THE SOFTWARE.
 ****************************************************************************/
 #include "base/CCAutoreleasePool.h"
 #include "base/ccMacros.h"
+#include "base/allocator/CCAllocatorStrategyFrame.h"
 
 NS_CC_BEGIN
 
@@ -66,8 +67,9 @@ void AutoreleasePool::clear()
 #if defined(COCOS2D_DEBUG) && (COCOS2D_DEBUG > 0)
     _isClearing = true;
 #endif
-    std::vector<Ref*> releasings;
-    releasings.swap(_managedObjectArray);
+    // copied to the frame allocator, so that the pool keeps its capacity for the next frame
+    allocator::FrameVector<Ref*> releasings(_managedObjectArray.begin(), _managedObjectArray.end());
+    _managedObjectArray.clear();
     for (const auto &obj : releasings)
     {
         obj->release();
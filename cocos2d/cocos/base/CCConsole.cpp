@@ -69,6 +69,7 @@
 #include "base/base64.h"
 #include "base/ccUtils.h"
 #include "base/allocator/CCAllocatorDiagnostics.h"
+#include "base/CCTracing.h"
 NS_CC_BEGIN
 
 extern const char* cocos2dVersion(void);
@@ -506,6 +507,7 @@ Console::Console()
     createCommandSceneGraph();
     createCommandTexture();
     createCommandTouch();
+    createCommandTrace();
     createCommandUpload();
     createCommandVersion();
 }
@@ -1054,6 +1056,8 @@ void Console::createCommandDirector()
         CC_CALLBACK_2(Console::commandDirectorSubCommandStart, this)});
     addSubCommand("director", {"end",    "exit this app.",
         CC_CALLBACK_2(Console::commandDirectorSubCommandEnd, this)});
+    addSubCommand("director", {"stats",  "print the frame time percentiles, the fixed step and the idle state.",
+        CC_CALLBACK_2(Console::commandDirectorSubCommandStats, this)});
 }
 
 void Console::createCommandExit()
@@ -1105,10 +1109,14 @@ void Console::createCommandSceneGraph()
 
 void Console::createCommandTexture()
 {
-    addCommand({"texture", "Flush or print the TextureCache info. Args: [-h | help | flush | ] ",
+    addCommand({"texture", "Flush or print the TextureCache info. Args: [-h | help | flush | async | budget | ] ",
         CC_CALLBACK_2(Console::commandTextures, this)});
     addSubCommand("texture", {"flush", "Purges the dictionary of loaded textures.",
         CC_CALLBACK_2(Console::commandTexturesSubCommandFlush, this)});
+    addSubCommand("texture", {"async", "Print the asynchronous loading queue and decode times.",
+        CC_CALLBACK_2(Console::commandTexturesSubCommandAsync, this)});
+    addSubCommand("texture", {"budget", "Sets the texture memory budget in MB, 0 means no limit. Args: [mb]",
+        CC_CALLBACK_2(Console::commandTexturesSubCommandBudget, this)});
 }
 
 void Console::createCommandTouch()
@@ -1120,6 +1128,17 @@ void Console::createCommandTouch()
         CC_CALLBACK_2(Console::commandTouchSubCommandSwipe, this)});
 }
 
+void Console::createCommandTrace()
+{
+    addCommand({"trace", "Record the engine scopes and export them as Chrome trace JSON. Args: [-h | help | on | off | clear | dump | ]",
+        CC_CALLBACK_2(Console::commandTrace, this)});
+    addSubCommand("trace", {"on", "start recording", CC_CALLBACK_2(Console::commandTraceSubCommandOnOff, this)});
+    addSubCommand("trace", {"off", "stop recording", CC_CALLBACK_2(Console::commandTraceSubCommandOnOff, this)});
+    addSubCommand("trace", {"clear", "drop the scopes recorded until now", CC_CALLBACK_2(Console::commandTraceSubCommandClear, this)});
+    addSubCommand("trace", {"dump", "write the recorded scopes to a file, trace.json in the writable path by default. Args: [filename]",
+        CC_CALLBACK_2(Console::commandTraceSubCommandDump, this)});
+}
+
 void Console::createCommandUpload()
 {
     addCommand({"upload", "upload file. Args: [filename base64_encoded_data]", CC_CALLBACK_1(Console::commandUpload, this)});
@@ -1199,6 +1218,27 @@ void Console::commandDirectorSubCommandEnd(int /*fd*/, const std::string& /*args
     director->end();
 }
 
+void Console::commandDirectorSubCommandStats(int fd, const std::string& /*args*/)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        auto director = Director::getInstance();
+        Console::Utility::mydprintf(fd, "frame time (ms) p50: %.2f, p95: %.2f, p99: %.2f, max: %.2f\n",
+                                    director->getFrameTimePercentile(0.5f) * 1000,
+                                    director->getFrameTimePercentile(0.95f) * 1000,
+                                    director->getFrameTimePercentile(0.99f) * 1000,
+                                    director->getFrameTimePercentile(1.0f) * 1000);
+        Console::Utility::mydprintf(fd, "fixed step (ms): %.2f, alpha: %.2f\n",
+                                    director->getFixedTimeStep() * 1000, director->getFixedStepAlpha());
+        Console::Utility::mydprintf(fd, "idle: %s, idle interval (ms): %.2f\n",
+                                    director->isIdle() ? "yes" : "no", director->getIdleAnimationInterval() * 1000);
+        Console::Utility::mydprintf(fd, "skip idle frames: %s, skipped: %u, saved (ms): %.2f\n",
+                                    director->isSkipIdleFrames() ? "yes" : "no", director->getSkippedFrames(),
+                                    director->getSavedFrameTime() * 1000);
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
 void Console::commandExit(int fd, const std::string& /*args*/)
 {
     FD_CLR(fd, &_read_set);
@@ -1343,6 +1383,34 @@ void Console::commandTexturesSubCommandFlush(int /*fd*/, const std::string& /*ar
     });
 }
 
+void Console::commandTexturesSubCommandAsync(int fd, const std::string& /*args*/)
+{
+    Scheduler *sched = Director::getInstance()->getScheduler();
+    sched->performFunctionInCocosThread( [=](){
+        Console::Utility::mydprintf(fd, "%s", Director::getInstance()->getTextureCache()->getAsyncLoadingInfo().c_str());
+        Console::Utility::sendPrompt(fd);
+    });
+}
+
+void Console::commandTexturesSubCommandBudget(int fd, const std::string& args)
+{
+    auto argv = Console::Utility::split(args, ' ');
+
+    if (argv.size() == 2 && Console::Utility::isFloat(argv[1]))
+    {
+        float megabytes = utils::atof(argv[1].c_str());
+        Scheduler *sched = Director::getInstance()->getScheduler();
+        sched->performFunctionInCocosThread( [=](){
+            Director::getInstance()->getTextureCache()->setMemoryBudget(static_cast<size_t>(std::max(megabytes, 0.0f) * 1024 * 1024));
+        });
+    }
+    else
+    {
+        const char msg[] = "texture budget: invalid arguments.\n";
+        Console::Utility::sendToConsole(fd, msg, strlen(msg));
+    }
+}
+
 void Console::commandTouchSubCommandTap(int fd, const std::string& args)
 {
     auto argv = Console::Utility::split(args,' ');
@@ -1467,6 +1535,40 @@ void Console::commandTouchSubCommandSwipe(int fd, const std::string& args)
 
 static char invalid_filename_char[] = {':', '/', '\\', '?', '%', '*', '<', '>', '"', '|', '\r', '\n', '\t'};
 
+void Console::commandTrace(int fd, const std::string& /*args*/)
+{
+#if CC_ENABLE_TRACING
+    Console::Utility::mydprintf(fd, "trace is: %s\n", Tracer::isEnabled() ? "on" : "off");
+#else
+    Console::Utility::mydprintf(fd, "trace not available. CC_ENABLE_TRACING must be set to 1 in ccConfig.h\n");
+#endif
+}
+
+void Console::commandTraceSubCommandOnOff(int /*fd*/, const std::string& args)
+{
+    Tracer::setEnabled(args.compare("on") == 0);
+}
+
+void Console::commandTraceSubCommandClear(int /*fd*/, const std::string& /*args*/)
+{
+    Tracer::clear();
+}
+
+void Console::commandTraceSubCommandDump(int fd, const std::string& args)
+{
+    // the export reads the buffers of all the threads without stopping them
+    auto argv = Console::Utility::split(args, ' ');
+    std::string path = argv.size() > 1 ? argv[1] : FileUtils::getInstance()->getWritablePath() + "trace.json";
+    if (Tracer::writeChromeTrace(path))
+    {
+        Console::Utility::mydprintf(fd, "trace written to %s\n", path.c_str());
+    }
+    else
+    {
+        Console::Utility::mydprintf(fd, "trace dump: can't write %s\n", path.c_str());
+    }
+}
+
 void Console::commandUpload(int fd)
 {
     ssize_t n, rc;
@@ -1594,9 +1696,9 @@ void Console::printFileUtils(int fd)
     Console::Utility::mydprintf(fd, "%s\n", fu->getWritablePath().c_str());
     
     Console::Utility::mydprintf(fd, "\nFull Path Cache:\n");
-    auto& cache = fu->getFullPathCache();
+    auto cache = fu->getFullPathCache();
     for( const auto &item : cache) {
-        Console::Utility::mydprintf(fd, "%s -> %s\n", item.first.c_str(), item.second.c_str());
+        Console::Utility::mydprintf(fd, "%s -> %s\n", item.first.c_str(), item.second.empty() ? "(not found)" : item.second.c_str());
     }
     Console::Utility::sendPrompt(fd);
 }
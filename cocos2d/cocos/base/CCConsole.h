@@ -239,6 +239,7 @@ protected:
     void createCommandSceneGraph();
     void createCommandTexture();
     void createCommandTouch();
+    void createCommandTrace();
     void createCommandUpload();
     void createCommandVersion();
 
@@ -252,6 +253,7 @@ protected:
     void commandDirectorSubCommandStop(int fd, const std::string& args);
     void commandDirectorSubCommandStart(int fd, const std::string& args);
     void commandDirectorSubCommandEnd(int fd, const std::string& args);
+    void commandDirectorSubCommandStats(int fd, const std::string& args);
     void commandExit(int fd, const std::string& args);
     void commandFileUtils(int fd, const std::string& args);
     void commandFileUtilsSubCommandFlush(int fd, const std::string& args);
@@ -266,8 +268,14 @@ protected:
     void commandSceneGraph(int fd, const std::string& args);
     void commandTextures(int fd, const std::string& args);
     void commandTexturesSubCommandFlush(int fd, const std::string& args);
+    void commandTexturesSubCommandAsync(int fd, const std::string& args);
+    void commandTexturesSubCommandBudget(int fd, const std::string& args);
     void commandTouchSubCommandTap(int fd, const std::string& args);
     void commandTouchSubCommandSwipe(int fd, const std::string& args);
+    void commandTrace(int fd, const std::string& args);
+    void commandTraceSubCommandOnOff(int fd, const std::string& args);
+    void commandTraceSubCommandClear(int fd, const std::string& args);
+    void commandTraceSubCommandDump(int fd, const std::string& args);
     void commandUpload(int fd);
     void commandVersion(int fd, const std::string& args);
     // file descriptor: socket, console, etc.
@@ -33,14 +33,16 @@ const Data Data::Null;
 
 Data::Data() :
 _bytes(nullptr),
-_size(0)
+_size(0),
+_borrowed(false)
 {
     CCLOGINFO("In the empty constructor of Data.");
 }
 
 Data::Data(Data&& other) :
 _bytes(nullptr),
-_size(0)
+_size(0),
+_borrowed(false)
 {
     CCLOGINFO("In the move constructor of Data.");
     move(other);
@@ -48,7 +50,8 @@ _size(0)
 
 Data::Data(const Data& other) :
 _bytes(nullptr),
-_size(0)
+_size(0),
+_borrowed(false)
 {
     CCLOGINFO("In the copy constructor of Data.");
     copy(other._bytes, other._size);
@@ -80,9 +83,11 @@ void Data::move(Data& other)
     
     _bytes = other._bytes;
     _size = other._size;
+    _borrowed = other._borrowed;
 
     other._bytes = nullptr;
     other._size = 0;
+    other._borrowed = false;
 }
 
 bool Data::isNull() const
@@ -116,17 +121,35 @@ void Data::fastSet(unsigned char* bytes, const ssize_t size)
 {
     _bytes = bytes;
     _size = size;
+    _borrowed = false;
+}
+
+void Data::borrow(unsigned char* bytes, const ssize_t size)
+{
+    clear();
+    _bytes = bytes;
+    _size = size;
+    _borrowed = true;
 }
 
 void Data::clear()
 {
-    free(_bytes);
+    if (!_borrowed)
+        free(_bytes);
     _bytes = nullptr;
     _size = 0;
+    _borrowed = false;
 }
 
 unsigned char* Data::takeBuffer(ssize_t* size)
 {
+    // the caller frees the buffer, a borrowed one is copied
+    if (_borrowed)
+    {
+        unsigned char* borrowed = _bytes;
+        copy(borrowed, _size);
+    }
+
     auto buffer = getBytes();
     if (size)
         *size = getSize();
@@ -109,6 +109,19 @@ public:
      */
     void fastSet(unsigned char* bytes, const ssize_t size);
 
+    /** Uses a buffer owned by someone else without copying it, e.g. an entry of a memory mapped asset pack, see FileUtils::getMappedDataFromFile.
+     *  @note The buffer isn't freed by Data and it must outlive it, takeBuffer returns a copy of it.
+     *        It may be read-only, copy the Data before modifying its bytes.
+     *  @see Data::fastSet
+     *  @since v3.17
+     */
+    void borrow(unsigned char* bytes, const ssize_t size);
+
+    /** Whether or not the buffer is borrowed, see Data::borrow.
+     *  @since v3.17
+     */
+    bool isBorrowed() const { return _borrowed; }
+
     /**
      * Clears data, free buffer and reset data size.
      */
@@ -148,6 +161,7 @@ private:
 private:
     unsigned char* _bytes;
     ssize_t _size;
+    bool _borrowed;
 };
 
 
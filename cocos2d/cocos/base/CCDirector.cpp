@@ -31,6 +31,8 @@ THE SOFTWARE.
 
 // standard includes
 #include <string>
+#include <algorithm>
+#include <cmath>
 
 #include "2d/CCDrawingPrimitives.h"
 #include "2d/CCSpriteFrameCache.h"
@@ -62,6 +64,8 @@ THE SOFTWARE.
 #include "base/CCConfiguration.h"
 #include "base/CCAsyncTaskPool.h"
 #include "base/ObjectFactory.h"
+#include "base/CCTracing.h"
+#include "base/allocator/CCAllocatorStrategyFrame.h"
 #include "platform/CCApplication.h"
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -124,6 +128,7 @@ Director::Director()
 bool Director::init(void)
 {
     setDefaultValues();
+    Tracer::setThreadName("cocos");
 
     // scenes
     _runningScene = nullptr;
@@ -143,6 +148,27 @@ bool Director::init(void)
     _secondsPerFrame = 1.0f;
     _frames = 0;
 
+    // frame pacing
+    _fixedTimeStep = 0.0f;
+    _fixedStepAccumulator = 0.0f;
+    _fixedStepAlpha = 0.0f;
+    _maxFixedSteps = 5;
+    _idleAnimationInterval = 0.0f;
+    _idleDelay = 2.0f;
+    _idleTime = 0.0f;
+    _lastInputEventCount = 0;
+    _idle = false;
+    _frameTimes.reserve(FRAME_TIME_SAMPLES);
+    _frameTimeIndex = 0;
+
+    // idle frames skipping
+    _skipIdleFrames = false;
+    _skippedFrames = 0;
+    _savedFrameTime = 0.0f;
+    _renderTime = 0.0f;
+    _lastRedrawInputEventCount = 0;
+    _lastRedrawCallbackCount = 0;
+
     // paused ?
     _paused = false;
 
@@ -286,6 +312,8 @@ void Director::setGLDefaultValues()
 // Draw the Scene
 void Director::drawScene()
 {
+    CC_TRACE_SCOPE("Director::drawScene");
+
     // calculate "global" dt
     calculateDeltaTime();
     
@@ -295,12 +323,27 @@ void Director::drawScene()
     }
 
     //tick before glClear: issue #533
+    // only read by the physics and navigation step
+    CC_UNUSED float simulatedTime = _deltaTime;
     if (! _paused)
     {
-        _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
-        _scheduler->update(_deltaTime);
-        _eventDispatcher->dispatchEvent(_eventAfterUpdate);
+        simulatedTime = updateScheduler();
+    }
+
+    if (_skipIdleFrames && !needsRedraw())
+    {
+        // the previous frame is still on screen
+        _totalFrames++;
+        _skippedFrames++;
+        _savedFrameTime += _renderTime;
+        updateIdleState();
+        _textureCache->evictUnusedTextures();
+        allocator::AllocatorStrategyFrame::getThreadAllocator().reset();
+        return;
     }
+    // the changes made from now on, e.g. while visiting, are drawn in the next frame
+    Node::setSceneGraphDirty(false);
+    auto renderStart = std::chrono::steady_clock::now();
 
     _renderer->clear();
     experimental::FrameBuffer::clearAllFBOs();
@@ -320,7 +363,7 @@ void Director::drawScene()
     if (_runningScene)
     {
 #if (CC_USE_PHYSICS || (CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION) || CC_USE_NAVMESH)
-        _runningScene->stepPhysicsAndNavigation(_deltaTime);
+        _runningScene->stepPhysicsAndNavigation(simulatedTime);
 #endif
         //clear draw stats
         _renderer->clearDrawStats();
@@ -361,12 +404,23 @@ void Director::drawScene()
         _openGLView->swapBuffers();
     }
 
+    float renderTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - renderStart).count() / 1000000.0f;
+    _renderTime = _renderTime > 0 ? _renderTime * 0.9f + renderTime * 0.1f : renderTime;
+
     if (_displayStats)
     {
 #if !CC_STRIP_FPS
         calculateMPF();
 #endif
     }
+
+    updateIdleState();
+
+    // the textures added during the frame are retained by their users now
+    _textureCache->evictUnusedTextures();
+
+    // the transient allocations of the frame are all dead now
+    allocator::AllocatorStrategyFrame::getThreadAllocator().reset();
 }
 
 void Director::calculateDeltaTime()
@@ -387,6 +441,16 @@ void Director::calculateDeltaTime()
             _lastUpdate = now;
         }
         _deltaTime = MAX(0, _deltaTime);
+
+        if (_frameTimes.size() < FRAME_TIME_SAMPLES)
+        {
+            _frameTimes.push_back(_deltaTime);
+        }
+        else
+        {
+            _frameTimes[_frameTimeIndex] = _deltaTime;
+            _frameTimeIndex = (_frameTimeIndex + 1) % FRAME_TIME_SAMPLES;
+        }
     }
 
 #if COCOS2D_DEBUG
@@ -402,6 +466,108 @@ float Director::getDeltaTime() const
 {
     return _deltaTime;
 }
+
+float Director::updateScheduler()
+{
+    if (_fixedTimeStep <= 0)
+    {
+        _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
+        _scheduler->update(_deltaTime);
+        _eventDispatcher->dispatchEvent(_eventAfterUpdate);
+        return _deltaTime;
+    }
+
+    _fixedStepAccumulator += _deltaTime;
+    unsigned int steps = 0;
+    while (_fixedStepAccumulator >= _fixedTimeStep && steps < _maxFixedSteps)
+    {
+        _eventDispatcher->dispatchEvent(_eventBeforeUpdate);
+        _scheduler->update(_fixedTimeStep);
+        _eventDispatcher->dispatchEvent(_eventAfterUpdate);
+        _fixedStepAccumulator -= _fixedTimeStep;
+        ++steps;
+    }
+
+    // drop the backlog of a slow frame instead of catching it up in the next ones
+    if (_fixedStepAccumulator >= _fixedTimeStep)
+    {
+        _fixedStepAccumulator = std::fmod(_fixedStepAccumulator, _fixedTimeStep);
+    }
+    _fixedStepAlpha = _fixedStepAccumulator / _fixedTimeStep;
+    return steps * _fixedTimeStep;
+}
+
+void Director::setFixedTimeStep(float step)
+{
+    _fixedTimeStep = MAX(0, step);
+    _fixedStepAccumulator = 0.0f;
+    _fixedStepAlpha = 0.0f;
+}
+
+void Director::updateIdleState()
+{
+    if (_idleAnimationInterval <= 0)
+    {
+        _idle = false;
+        return;
+    }
+
+    unsigned int inputEventCount = _eventDispatcher->getInputEventCount();
+    if (inputEventCount != _lastInputEventCount || _nextScene || _actionManager->getNumberOfRunningActions() > 0)
+    {
+        _lastInputEventCount = inputEventCount;
+        _idleTime = 0.0f;
+    }
+    else
+    {
+        _idleTime += _deltaTime;
+    }
+    _idle = _idleTime >= _idleDelay;
+}
+
+void Director::setSkipIdleFrames(bool skip)
+{
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+    // GLSurfaceView presents the back buffer after every onDrawFrame, drawn or not
+    skip = false;
+#endif
+    _skipIdleFrames = skip;
+}
+
+bool Director::needsRedraw()
+{
+    unsigned int inputEventCount = _eventDispatcher->getInputEventCount();
+    unsigned int callbackCount = _scheduler->getCallbackCount();
+    bool redraw = Node::isSceneGraphDirty() || _nextScene || _displayStats
+        || inputEventCount != _lastRedrawInputEventCount
+        || callbackCount != _lastRedrawCallbackCount
+        || _actionManager->getNumberOfRunningActions() > 0;
+    _lastRedrawInputEventCount = inputEventCount;
+    _lastRedrawCallbackCount = callbackCount;
+
+    // the physics and navigation step within the rendered frames
+#if CC_USE_PHYSICS
+    redraw = redraw || (_runningScene && _runningScene->getPhysicsWorld());
+#endif
+#if CC_USE_3D_PHYSICS && CC_ENABLE_BULLET_INTEGRATION
+    redraw = redraw || (_runningScene && _runningScene->getPhysics3DWorld());
+#endif
+#if CC_USE_NAVMESH
+    redraw = redraw || (_runningScene && _runningScene->getNavMesh());
+#endif
+    return redraw;
+}
+
+float Director::getFrameTimePercentile(float percentile) const
+{
+    if (_frameTimes.empty())
+        return 0.0f;
+
+    std::vector<float> sorted(_frameTimes);
+    size_t index = static_cast<size_t>(clampf(percentile, 0.0f, 1.0f) * (sorted.size() - 1) + 0.5f);
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
 void Director::setOpenGLView(GLView *openGLView)
 {
     CCASSERT(openGLView, "opengl view should not be null");
@@ -467,6 +633,7 @@ void Director::setViewport()
     {
         _openGLView->setViewPortInPoints(0, 0, _winSizeInPoints.width, _winSizeInPoints.height);
     }
+    Node::setSceneGraphDirty(true);
 }
 
 void Director::setNextDeltaTimeZero(bool nextDeltaTimeZero)
@@ -1136,11 +1303,13 @@ void Director::reset()
     SpriteFrameCache::destroyInstance();
     GLProgramCache::destroyInstance();
     GLProgramStateCache::destroyInstance();
-    FileUtils::destroyInstance();
-    AsyncTaskPool::destroyInstance();
-    
+
     // cocos2d-x specific data structures
+    // UserDefault saves its file with FileUtils, it is destroyed first
     UserDefault::destroyInstance();
+
+    FileUtils::destroyInstance();
+    AsyncTaskPool::destroyInstance();
     
     GL::invalidateStateCache();
 
@@ -469,6 +469,76 @@ public:
      */
     float getFrameRate() const { return _frameRate; }
 
+    /** Sets a fixed time step for the scheduler, in seconds.
+     * The frame time is accumulated and the scheduler is updated with whole steps, the rest is carried over
+     * to the next frame, see getFixedStepAlpha. 0 disables it, which is the default.
+     * @since v3.17
+     */
+    void setFixedTimeStep(float step);
+    float getFixedTimeStep() const { return _fixedTimeStep; }
+
+    /** Sets the most steps run in a frame, the time left after them is dropped so that a slow frame
+     * doesn't make the next ones slower. 5 by default.
+     * @since v3.17
+     */
+    void setMaxFixedSteps(unsigned int steps) { _maxFixedSteps = steps; }
+    unsigned int getMaxFixedSteps() const { return _maxFixedSteps; }
+
+    /** The accumulated time not simulated yet, as a fraction of the fixed step.
+     * Drawing the nodes at previous + (current - previous) * alpha smooths the motion.
+     * @since v3.17
+     */
+    float getFixedStepAlpha() const { return _fixedStepAlpha; }
+
+    /** Sets the animation interval used while the director is idle, 0 disables it, which is the default.
+     * The director is idle when no input event was dispatched, no action ran and no scene was set for the idle delay.
+     * @since v3.17
+     */
+    void setIdleAnimationInterval(float interval) { _idleAnimationInterval = interval; }
+    float getIdleAnimationInterval() const { return _idleAnimationInterval; }
+
+    /** Sets how long the director waits without activity before being idle, in seconds. 2 by default.
+     * @since v3.17
+     */
+    void setIdleDelay(float delay) { _idleDelay = delay; }
+    float getIdleDelay() const { return _idleDelay; }
+
+    /** Whether or not the idle animation interval is used.
+     * @since v3.17
+     */
+    bool isIdle() const { return _idle; }
+
+    /** Gets a percentile of the last frame times, e.g. 0.95 for the 95th.
+     * @return The frame time in seconds, 0 if no frame was recorded.
+     * @since v3.17
+     */
+    float getFrameTimePercentile(float percentile) const;
+
+    /** Number of frame times kept for getFrameTimePercentile. */
+    static const int FRAME_TIME_SAMPLES = 600;
+
+    /** Sets whether or not the frames where nothing changed skip the visit, the rendering and the buffers swap,
+     * the scheduler still runs. A frame is drawn when a node is changed (see Node::isSceneGraphDirty), an input event
+     * is received, a non system scheduled callback or an action runs, a physics world or a navigation mesh is used,
+     * the scene is replaced or the stats are displayed. Disabled by default.
+     * It is ignored on Android, where GLSurfaceView swaps the buffers after each frame and a skipped one would show
+     * an undefined back buffer. Custom nodes drawing something new without changing their properties (or a
+     * Node::DirtyFlag), or shaders animated with CC_Time, must call Node::setSceneGraphDirty(true).
+     * @since v3.17
+     */
+    void setSkipIdleFrames(bool skip);
+    bool isSkipIdleFrames() const { return _skipIdleFrames; }
+
+    /** Gets the number of frames skipped since the director started.
+     * @since v3.17
+     */
+    unsigned int getSkippedFrames() const { return _skippedFrames; }
+
+    /** Gets an estimation of the time saved by the skipped frames, in seconds, from the average render time.
+     * @since v3.17
+     */
+    float getSavedFrameTime() const { return _savedFrameTime; }
+
     /** 
      * Clones a specified type matrix and put it to the top of specified type of matrix stack.
      * @js NA
@@ -609,6 +679,15 @@ protected:
     /** calculates delta time since last time it was called */    
     void calculateDeltaTime();
 
+    /** runs the scheduler with a variable or fixed step, returns the simulated time */
+    float updateScheduler();
+
+    /** sets _idle from the activity of the frame */
+    void updateIdleState();
+
+    /** whether or not the frame has to be drawn when skipping the idle frames */
+    bool needsRedraw();
+
     //textureCache creation or release
     void initTextureCache();
     void destroyTextureCache();
@@ -689,6 +768,31 @@ protected:
 
     /* whether or not the next delta time will be zero */
     bool _nextDeltaTimeZero;
+
+    /* fixed step simulation, disabled when the step is 0 */
+    float _fixedTimeStep;
+    float _fixedStepAccumulator;
+    float _fixedStepAlpha;
+    unsigned int _maxFixedSteps;
+
+    /* idle throttling */
+    float _idleAnimationInterval;
+    float _idleDelay;
+    float _idleTime;
+    unsigned int _lastInputEventCount;
+    bool _idle;
+
+    /* ring of the last frame times, in seconds */
+    std::vector<float> _frameTimes;
+    size_t _frameTimeIndex;
+
+    /* idle frames skipping */
+    bool _skipIdleFrames;
+    unsigned int _skippedFrames;
+    float _savedFrameTime;
+    float _renderTime;
+    unsigned int _lastRedrawInputEventCount;
+    unsigned int _lastRedrawCallbackCount;
     
     /* projection used */
     Projection _projection;
@@ -25,9 +25,12 @@
 
 #include "base/CCEventCustom.h"
 #include "base/CCEvent.h"
+#include "base/allocator/CCAllocatorStrategyPool.h"
 
 NS_CC_BEGIN
 
+CC_DEFINE_ALLOCATOR_POOL(EventCustom, 20)
+
 EventCustom::EventCustom(const std::string& eventName)
 : Event(Type::CUSTOM)
 , _userData(nullptr)
@@ -28,6 +28,7 @@
 
 #include <string>
 #include "base/CCEvent.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 /**
  * @addtogroup base
@@ -66,6 +67,10 @@ public:
      * @return The name of the event.
      */
     const std::string& getEventName() const { return _eventName; }
+
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(EventCustom)
+
 protected:
     void* _userData;       ///< User data
     std::string _eventName;
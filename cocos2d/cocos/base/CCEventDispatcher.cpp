@@ -24,6 +24,7 @@
  ****************************************************************************/
 #include "base/CCEventDispatcher.h"
 #include <algorithm>
+#include <cmath>
 
 #include "base/CCEventCustom.h"
 #include "base/CCEventListenerTouch.h"
@@ -38,7 +39,10 @@
 #include "2d/CCScene.h"
 #include "base/CCDirector.h"
 #include "base/CCEventType.h"
+#include "base/CCTouch.h"
 #include "2d/CCCamera.h"
+#include "math/CCAffineTransform.h"
+#include "base/allocator/CCAllocatorStrategyFrame.h"
 
 #define DUMP_LISTENER_ITEM_PRIORITY_INFO 0
 
@@ -199,10 +203,33 @@ void EventDispatcher::EventListenerVector::clear()
 }
 
 
+// Uniform grid over the world bounding boxes of the nodes of the culled touch listeners
+typedef struct _touchHitGrid
+{
+    std::vector<EventListener*> listeners;  // the scene graph listeners it was built from, in dispatch order
+    std::vector<Node*> nodes;               // the nodes of the culled listeners
+    std::vector<Rect> bounds;               // world bounding box of each culled listener, empty otherwise
+    std::vector<int> unculled;              // indices of the listeners called for every touch
+    std::vector<std::vector<int>> cells;    // indices of the culled listeners overlapping each cell, ascending
+    Rect area;
+    float cellWidth;
+    float cellHeight;
+    int columns;
+    int rows;
+    uint32_t transformVersion;
+    bool valid;
+} tTouchHitGrid;
+
+// the grid is at most 64x64, a cell holds a couple of listeners at that size
+static const int TOUCH_HIT_GRID_MAX_SIDE = 64;
+
 EventDispatcher::EventDispatcher()
 : _inDispatch(0)
 , _isEnabled(false)
+, _inputEventCount(0)
 , _nodePriorityIndex(0)
+, _touchHitGrid(new tTouchHitGrid())
+, _touchCullingEnabled(false)
 {
     _toAddedListeners.reserve(50);
     _toRemovedListeners.reserve(50);
@@ -220,6 +247,7 @@ EventDispatcher::~EventDispatcher()
     // so removeAllEventListeners would clean internal custom listeners.
     _internalCustomListenerIDs.clear();
     removeAllEventListeners();
+    delete _touchHitGrid;
 }
 
 void EventDispatcher::visitTarget(Node* node, bool isRootNode)
@@ -267,7 +295,7 @@ void EventDispatcher::visitTarget(Node* node, bool isRootNode)
     
     if (isRootNode)
     {
-        std::vector<float> globalZOrders;
+        allocator::FrameVector<float> globalZOrders;
         globalZOrders.reserve(_globalZOrderNodeMap.size());
         
         for (const auto& e : _globalZOrderNodeMap)
@@ -801,7 +829,7 @@ void EventDispatcher::dispatchEventToListeners(EventListenerVector* listeners, c
     }
 }
 
-void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent)
+void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent, Touch* culledTouch)
 {
     bool shouldStopPropagation = false;
     auto fixedPriorityListeners = listeners->getFixedPriorityListeners();
@@ -847,6 +875,7 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
             // get a copy of cameras, prevent it's been modified in listener callback
             // if camera's depth is greater, process it earlier
             auto cameras = scene->getCameras();
+            std::vector<EventListener*> candidates;
             for (auto rit = cameras.rbegin(), ritRend = cameras.rend(); rit != ritRend; ++rit)
             {
                 Camera* camera = *rit;
@@ -857,7 +886,13 @@ void EventDispatcher::dispatchTouchEventToListeners(EventListenerVector* listene
                 
                 Camera::_visitingCamera = camera;
                 auto cameraFlag = (unsigned short)camera->getCameraFlag();
-                for (auto& l : sceneListeners)
+                const std::vector<EventListener*>* cameraListeners = &sceneListeners;
+                if (culledTouch)
+                {
+                    collectTouchCandidates(sceneListeners, camera, culledTouch, &candidates);
+                    cameraListeners = &candidates;
+                }
+                for (auto& l : *cameraListeners)
                 {
                     if (nullptr == l->getAssociatedNode() || 0 == (l->getAssociatedNode()->getCameraMask() & cameraFlag))
                     {
@@ -907,6 +942,11 @@ void EventDispatcher::dispatchEvent(Event* event)
     
     
     DispatchGuard guard(_inDispatch);
+
+    if (event->getType() != Event::Type::CUSTOM)
+    {
+        ++_inputEventCount;
+    }
     
     if (event->getType() == Event::Type::TOUCH)
     {
@@ -918,10 +958,6 @@ void EventDispatcher::dispatchEvent(Event* event)
     
     sortEventListeners(listenerID);
     
-    auto pfnDispatchEventToListeners = &EventDispatcher::dispatchEventToListeners;
-    if (event->getType() == Event::Type::MOUSE) {
-        pfnDispatchEventToListeners = &EventDispatcher::dispatchTouchEventToListeners;
-    }
     auto iter = _listenerMap.find(listenerID);
     if (iter != _listenerMap.end())
     {
@@ -933,7 +969,14 @@ void EventDispatcher::dispatchEvent(Event* event)
             return event->isStopped();
         };
         
-        (this->*pfnDispatchEventToListeners)(listeners, onEvent);
+        if (event->getType() == Event::Type::MOUSE)
+        {
+            dispatchTouchEventToListeners(listeners, onEvent);
+        }
+        else
+        {
+            dispatchEventToListeners(listeners, onEvent);
+        }
     }
     
     updateListeners(event);
@@ -1068,7 +1111,8 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
             };
             
             //
-            dispatchTouchEventToListeners(oneByOneListeners, onTouchEvent);
+            bool cullTouch = _touchCullingEnabled && event->getEventCode() == EventTouch::EventCode::BEGAN;
+            dispatchTouchEventToListeners(oneByOneListeners, onTouchEvent, cullTouch ? touches : nullptr);
             if (event->isStopped())
             {
                 return;
@@ -1144,6 +1188,157 @@ void EventDispatcher::dispatchTouchEvent(EventTouch* event)
     updateListeners(event);
 }
 
+void EventDispatcher::collectTouchCandidates(const std::vector<EventListener*>& listeners, const Camera* camera, Touch* touch, std::vector<EventListener*>* candidates)
+{
+    updateTouchHitGrid(listeners);
+    auto grid = _touchHitGrid;
+    candidates->clear();
+
+    // The culled nodes lie in the plane z = 0, find where the touch ray crosses it like isScreenPointInRect.
+    // If the ray is parallel to the plane, the hit tests of all the culled nodes fail.
+    const std::vector<int>* cell = nullptr;
+    Vec2 point;
+    const Vec2& location = touch->getLocation();
+    Vec3 nearPoint = camera->unprojectGL(Vec3(location.x, location.y, -1));
+    Vec3 farPoint = camera->unprojectGL(Vec3(location.x, location.y, 1));
+    float dz = farPoint.z - nearPoint.z;
+    if (dz != 0)
+    {
+        float t = -nearPoint.z / dz;
+        point.set(nearPoint.x + t * (farPoint.x - nearPoint.x), nearPoint.y + t * (farPoint.y - nearPoint.y));
+        if (grid->area.containsPoint(point))
+        {
+            int column = std::min(static_cast<int>((point.x - grid->area.getMinX()) / grid->cellWidth), grid->columns - 1);
+            int row = std::min(static_cast<int>((point.y - grid->area.getMinY()) / grid->cellHeight), grid->rows - 1);
+            cell = &grid->cells[row * grid->columns + column];
+        }
+    }
+
+    // merge the unculled listeners with the ones of the cell, both are sorted by dispatch order
+    size_t u = 0, c = 0;
+    size_t unculledCount = grid->unculled.size();
+    size_t cellCount = cell ? cell->size() : 0;
+    while (u < unculledCount || c < cellCount)
+    {
+        if (c == cellCount || (u < unculledCount && grid->unculled[u] < (*cell)[c]))
+        {
+            candidates->push_back(listeners[grid->unculled[u++]]);
+        }
+        else
+        {
+            int index = (*cell)[c++];
+            if (grid->bounds[index].containsPoint(point))
+            {
+                candidates->push_back(listeners[index]);
+            }
+        }
+    }
+}
+
+void EventDispatcher::updateTouchHitGrid(const std::vector<EventListener*>& listeners)
+{
+    auto grid = _touchHitGrid;
+
+    // The visits apply the transform changes by increasing Node::s_transformVersion,
+    // the ones made since the last visit are still flagged on the nodes or their ancestors.
+    if (grid->valid && grid->transformVersion == Node::s_transformVersion && grid->listeners == listeners)
+    {
+        bool moved = false;
+        for (auto node : grid->nodes)
+        {
+            for (auto n = node; n && !moved; n = n->_parent)
+            {
+                moved = n->_transformUpdated || n->_contentSizeDirty;
+            }
+            if (moved)
+                break;
+        }
+        if (!moved)
+            return;
+    }
+
+    int count = static_cast<int>(listeners.size());
+    grid->listeners = listeners;
+    grid->nodes.clear();
+    grid->bounds.assign(count, Rect::ZERO);
+    grid->unculled.clear();
+    grid->area = Rect::ZERO;
+    grid->transformVersion = Node::s_transformVersion;
+    grid->valid = true;
+
+    int culledCount = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        auto listener = static_cast<EventListenerTouchOneByOne*>(listeners[i]);
+        Node* node = listener->getAssociatedNode();
+        if (!listener->_cullTouchesOutsideNode || !node)
+        {
+            grid->unculled.push_back(i);
+            continue;
+        }
+
+        // only the nodes staying in the plane z = 0 are culled
+        Mat4 transform = node->getNodeToWorldTransform();
+        const float* m = transform.m;
+        if (m[2] != 0 || m[3] != 0 || m[6] != 0 || m[7] != 0 || m[14] != 0 || m[15] != 1)
+        {
+            grid->unculled.push_back(i);
+            continue;
+        }
+
+        grid->nodes.push_back(node);
+        const Size& size = node->getContentSize();
+        if (size.width <= 0 || size.height <= 0)
+            continue;
+
+        // one point of margin for the rounding differences with the hit test
+        Rect box = RectApplyTransform(Rect(0, 0, size.width, size.height), transform);
+        box.origin.x -= 1;
+        box.origin.y -= 1;
+        box.size.width += 2;
+        box.size.height += 2;
+        grid->bounds[i] = box;
+        if (culledCount++ == 0)
+            grid->area = box;
+        else
+            grid->area.merge(box);
+    }
+
+    int side = std::min(std::max(static_cast<int>(std::ceil(std::sqrt(static_cast<float>(culledCount)))), 1), TOUCH_HIT_GRID_MAX_SIDE);
+    grid->columns = side;
+    grid->rows = side;
+    grid->cellWidth = grid->area.size.width / side;
+    grid->cellHeight = grid->area.size.height / side;
+    grid->cells.resize(side * side);
+    for (auto& cell : grid->cells)
+    {
+        cell.clear();
+    }
+    if (culledCount == 0)
+        return;
+
+    float minX = grid->area.getMinX();
+    float minY = grid->area.getMinY();
+    for (int i = 0; i < count; ++i)
+    {
+        const Rect& box = grid->bounds[i];
+        if (box.size.width <= 0)
+            continue;
+
+        int column0 = std::min(static_cast<int>((box.getMinX() - minX) / grid->cellWidth), side - 1);
+        int column1 = std::min(static_cast<int>((box.getMaxX() - minX) / grid->cellWidth), side - 1);
+        int row0 = std::min(static_cast<int>((box.getMinY() - minY) / grid->cellHeight), side - 1);
+        int row1 = std::min(static_cast<int>((box.getMaxY() - minY) / grid->cellHeight), side - 1);
+        for (int row = row0; row <= row1; ++row)
+        {
+            for (int column = column0; column <= column1; ++column)
+            {
+                grid->cells[row * side + column].push_back(i);
+            }
+        }
+    }
+}
+
 void EventDispatcher::updateListeners(Event* event)
 {
     CCASSERT(_inDispatch > 0, "If program goes here, there should be event in dispatch.");
@@ -1527,6 +1722,16 @@ bool EventDispatcher::isEnabled() const
     return _isEnabled;
 }
 
+void EventDispatcher::setTouchCullingEnabled(bool enabled)
+{
+    _touchCullingEnabled = enabled;
+}
+
+bool EventDispatcher::isTouchCullingEnabled() const
+{
+    return _touchCullingEnabled;
+}
+
 void EventDispatcher::setDirtyForNode(Node* node)
 {
     // Mark the node dirty only when there is an eventlistener associated with it. 
@@ -1623,6 +1828,8 @@ void EventDispatcher::releaseListener(EventListener* listener)
         sEngine->releaseScriptObject(this, listener);
     }
 #endif // CC_ENABLE_GC_FOR_NATIVE_OBJECTS
+    // the address may be reused by a new listener, don't compare the grid with it
+    _touchHitGrid->valid = false;
     CC_SAFE_RELEASE(listener);
 }
 
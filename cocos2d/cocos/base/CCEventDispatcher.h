@@ -47,6 +47,8 @@ NS_CC_BEGIN
 class Event;
 class EventTouch;
 class Node;
+class Camera;
+class Touch;
 class EventCustom;
 class EventListenerCustom;
 
@@ -161,6 +163,29 @@ public:
      */
     bool isEnabled() const;
 
+    /** Gets the number of events other than custom ones dispatched so far, e.g. touches and keys.
+     * It tells whether the user did something since the last time it was read.
+     * @since v3.17
+     */
+    unsigned int getInputEventCount() const { return _inputEventCount; }
+
+    /** Whether to skip onTouchBegan of the listeners whose node isn't under the touch.
+     * Only the scene graph priority listeners with EventListenerTouchOneByOne::setCullTouchesOutsideNode are skipped,
+     * the others are called in the same order as before. The candidates are found in a grid over the world bounding
+     * boxes of the nodes, rebuilt when a node moves. Nodes with a 3D transform are never skipped.
+     *
+     * @param enabled True to enable the touch culling, false by default.
+     * @since v3.17
+     */
+    void setTouchCullingEnabled(bool enabled);
+
+    /** Checks whether the touch culling is enabled.
+     *
+     * @return True if the touch culling is enabled.
+     * @since v3.17
+     */
+    bool isTouchCullingEnabled() const;
+
     /////////////////////////////////////////////
     
     /** Dispatches the event.
@@ -292,8 +317,15 @@ protected:
      *      order by viewport/camera first, because the touch location convert
      *      to 3D world space is different by different camera.
      *  When listener process touch event, can get current camera by Camera::getVisitingCamera().
+     *  If culledTouch isn't null, the scene graph listeners whose node isn't under this beginning touch are skipped.
      */
-    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent);
+    void dispatchTouchEventToListeners(EventListenerVector* listeners, const std::function<bool(EventListener*)>& onEvent, Touch* culledTouch = nullptr);
+
+    /** Gets the scene graph listeners whose node may be under the touch seen from the camera, in the same order. */
+    void collectTouchCandidates(const std::vector<EventListener*>& listeners, const Camera* camera, Touch* touch, std::vector<EventListener*>* candidates);
+
+    /** Rebuilds the touch culling grid if the listeners or the transform of their nodes changed since it was built. */
+    void updateTouchHitGrid(const std::vector<EventListener*>& listeners);
     
     void releaseListener(EventListener* listener);
     
@@ -344,10 +376,18 @@ protected:
     
     /** Whether to enable dispatching event */
     bool _isEnabled;
+
+    /** Number of events other than custom ones dispatched */
+    unsigned int _inputEventCount;
     
     int _nodePriorityIndex;
     
     std::set<std::string> _internalCustomListenerIDs;
+
+    /** Spatial index of the touch listeners, used when the touch culling is enabled */
+    struct _touchHitGrid* _touchHitGrid;
+
+    bool _touchCullingEnabled;
 };
 
 
@@ -40,6 +40,7 @@ EventListenerTouchOneByOne::EventListenerTouchOneByOne()
 , onTouchEnded(nullptr)
 , onTouchCancelled(nullptr)
 , _needSwallow(false)
+, _cullTouchesOutsideNode(false)
 {
 }
 
@@ -68,6 +69,16 @@ bool EventListenerTouchOneByOne::isSwallowTouches()
     return _needSwallow;
 }
 
+void EventListenerTouchOneByOne::setCullTouchesOutsideNode(bool cull)
+{
+    _cullTouchesOutsideNode = cull;
+}
+
+bool EventListenerTouchOneByOne::isCullTouchesOutsideNode() const
+{
+    return _cullTouchesOutsideNode;
+}
+
 EventListenerTouchOneByOne* EventListenerTouchOneByOne::create()
 {
     auto ret = new (std::nothrow) EventListenerTouchOneByOne();
@@ -109,6 +120,7 @@ EventListenerTouchOneByOne* EventListenerTouchOneByOne::clone()
         
         ret->_claimedTouches = _claimedTouches;
         ret->_needSwallow = _needSwallow;
+        ret->_cullTouchesOutsideNode = _cullTouchesOutsideNode;
     }
     else
     {
@@ -68,6 +68,22 @@ public:
      * @return True if needs to swall touches.
      */
     bool isSwallowTouches();
+
+    /** Whether onTouchBegan may be skipped for the touches beginning outside the bounding box of the associated node.
+     * Set it when onTouchBegan never claims such touches, e.g. when it hit tests the node content size.
+     * It has no effect unless the touch culling of the EventDispatcher is enabled.
+     *
+     * @param cull True if the touches outside the node can be skipped.
+     * @see EventDispatcher::setTouchCullingEnabled
+     * @since v3.17
+     */
+    void setCullTouchesOutsideNode(bool cull);
+    /** Whether onTouchBegan may be skipped for the touches beginning outside the node.
+     *
+     * @return True if the touches outside the node can be skipped.
+     * @since v3.17
+     */
+    bool isCullTouchesOutsideNode() const;
     
     /// Overrides
     virtual EventListenerTouchOneByOne* clone() override;
@@ -91,6 +107,7 @@ CC_CONSTRUCTOR_ACCESS:
 private:
     std::vector<Touch*> _claimedTouches;
     bool _needSwallow;
+    bool _cullTouchesOutsideNode;
     
     friend class EventDispatcher;
 };
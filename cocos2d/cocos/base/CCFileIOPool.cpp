@@ -0,0 +1,439 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCFileIOPool.h"
+
+#include <algorithm>
+
+#include "base/CCDirector.h"
+#include "base/CCScheduler.h"
+#include "base/CCTracing.h"
+#include "platform/CCFileUtils.h"
+
+NS_CC_BEGIN
+
+FileIOPool::FileIOPool(int threadCount)
+: _stop(false)
+, _runningCount(0)
+, _nextId(0)
+, _nextSequence(0)
+, _prefetchedBytes(0)
+, _prefetchCacheSize(DEFAULT_PREFETCH_CACHE_SIZE)
+, _completionQueue(std::make_shared<tCompletionQueue>())
+{
+    _completionQueue->next = 0;
+    _completionQueue->scheduled = false;
+    for (int i = 0; i < threadCount; ++i)
+    {
+        _threads.emplace_back(&FileIOPool::run, this);
+    }
+}
+
+FileIOPool::~FileIOPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _condition.notify_all();
+    for (auto& thread : _threads)
+    {
+        thread.join();
+    }
+
+    // the waiting requests are dropped without completion
+    for (auto& waiting : _waiting)
+    {
+        delete waiting.second;
+    }
+}
+
+FileIOPool::tIORequest* FileIOPool::addRequest(const std::string& fullPath, bool write, Priority priority)
+{
+    auto request = new (std::nothrow) tIORequest();
+    if (request == nullptr)
+        return nullptr;
+
+    request->fullPath = fullPath;
+    request->write = write;
+    request->running = false;
+    request->priority = priority;
+    request->sequence = _nextSequence++;
+    _waiting.emplace(getOrder(request), request);
+    if (write)
+        _writes[fullPath] = request;
+    else
+        _reads[fullPath] = request;
+    raisePriority(request, priority);
+
+    _condition.notify_one();
+    return request;
+}
+
+void FileIOPool::raisePriority(tIORequest* request, Priority priority)
+{
+    // the earlier requests of the file are raised too, so that they still run first
+    std::vector<tIORequest*> raised;
+    for (auto iter = _waiting.begin(); iter != _waiting.end(); )
+    {
+        tIORequest* other = iter->second;
+        if (other->priority < priority && other->sequence <= request->sequence && other->fullPath == request->fullPath)
+        {
+            raised.push_back(other);
+            iter = _waiting.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+    for (auto other : raised)
+    {
+        other->priority = priority;
+        _waiting.emplace(getOrder(other), other);
+    }
+}
+
+void FileIOPool::removeRequest(tIORequest* request)
+{
+    auto& requests = request->write ? _writes : _reads;
+    auto iter = requests.find(request->fullPath);
+    if (iter != requests.end() && iter->second == request)
+        requests.erase(iter);
+}
+
+unsigned int FileIOPool::read(const std::string& fullPath, Priority priority, ReadHandler handler)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    unsigned int id = ++_nextId;
+
+    // not coalesced with a read made before a write of the file
+    tIORequest* request = nullptr;
+    auto iter = _reads.find(fullPath);
+    auto write = _writes.find(fullPath);
+    if (iter != _reads.end() && (write == _writes.end() || write->second->sequence < iter->second->sequence))
+    {
+        request = iter->second;
+        raisePriority(request, priority);
+    }
+    else
+    {
+        request = addRequest(fullPath, false, priority);
+        if (request == nullptr)
+            return 0;
+    }
+    request->readers.emplace_back(id, std::move(handler));
+    _requestsById.emplace(id, request);
+    return id;
+}
+
+unsigned int FileIOPool::write(const std::string& fullPath, Data data, Priority priority, std::function<void(bool)> callback)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    unsigned int id = ++_nextId;
+
+    // not coalesced with a write made before a read of the file
+    tIORequest* request = nullptr;
+    auto iter = _writes.find(fullPath);
+    auto read = _reads.find(fullPath);
+    if (iter != _writes.end() && (read == _reads.end() || read->second->sequence < iter->second->sequence))
+    {
+        request = iter->second;
+        raisePriority(request, priority);
+    }
+    else
+    {
+        request = addRequest(fullPath, true, priority);
+        if (request == nullptr)
+            return 0;
+    }
+    dropPrefetched(fullPath);
+    request->data = std::move(data);
+    request->writers.emplace_back(id, std::move(callback));
+    _requestsById.emplace(id, request);
+    return id;
+}
+
+void FileIOPool::prefetch(const std::string& fullPath)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_reads.find(fullPath) != _reads.end())
+        return;
+
+    for (const auto& prefetched : _prefetched)
+    {
+        if (prefetched.first == fullPath)
+            return;
+    }
+    addRequest(fullPath, false, Priority::LOW);
+}
+
+bool FileIOPool::cancel(unsigned int requestId)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto iter = _requestsById.find(requestId);
+    if (iter == _requestsById.end())
+    {
+        // the completion may be waiting for its delivery
+        auto queue = _completionQueue;
+        std::lock_guard<std::mutex> queueLock(queue->mutex);
+        for (size_t i = queue->next; i < queue->completions.size(); ++i)
+        {
+            if (queue->completions[i].first == requestId && queue->completions[i].second)
+            {
+                queue->completions[i].second = nullptr;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    tIORequest* request = iter->second;
+    _requestsById.erase(iter);
+    // completed, its completion is dropped by deliver
+    if (request == nullptr)
+        return true;
+
+    auto& readers = request->readers;
+    readers.erase(std::remove_if(readers.begin(), readers.end(), [requestId](const std::pair<unsigned int, ReadHandler>& reader) {
+        return reader.first == requestId;
+    }), readers.end());
+    auto& writers = request->writers;
+    writers.erase(std::remove_if(writers.begin(), writers.end(), [requestId](const std::pair<unsigned int, std::function<void(bool)>>& writer) {
+        return writer.first == requestId;
+    }), writers.end());
+
+    // a running request completes without the callback
+    if (!request->running && readers.empty() && writers.empty())
+    {
+        _waiting.erase(getOrder(request));
+        removeRequest(request);
+        delete request;
+    }
+    return true;
+}
+
+size_t FileIOPool::getRequestCount() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _waiting.size() + _runningCount;
+}
+
+void FileIOPool::setPrefetchCacheSize(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _prefetchCacheSize = bytes;
+    while (_prefetchedBytes > _prefetchCacheSize)
+    {
+        _prefetchedBytes -= _prefetched.front().second.getSize();
+        _prefetched.pop_front();
+    }
+}
+
+FileIOPool::tIORequest* FileIOPool::takeNextRequest()
+{
+    for (auto iter = _waiting.begin(); iter != _waiting.end(); ++iter)
+    {
+        tIORequest* request = iter->second;
+        if (_busyPaths.find(request->fullPath) != _busyPaths.end())
+            continue;
+
+        _waiting.erase(iter);
+        if (request->write)
+            removeRequest(request);
+        _busyPaths.insert(request->fullPath);
+        request->running = true;
+        ++_runningCount;
+        return request;
+    }
+    return nullptr;
+}
+
+bool FileIOPool::takePrefetched(const std::string& fullPath, Data* data)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto iter = _prefetched.begin(); iter != _prefetched.end(); ++iter)
+    {
+        if (iter->first == fullPath)
+        {
+            _prefetchedBytes -= iter->second.getSize();
+            *data = std::move(iter->second);
+            _prefetched.erase(iter);
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileIOPool::keepPrefetched(const std::string& fullPath, Data& data)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    size_t size = data.getSize();
+    if (data.isNull() || size > _prefetchCacheSize)
+        return;
+
+    while (_prefetchedBytes + size > _prefetchCacheSize)
+    {
+        _prefetchedBytes -= _prefetched.front().second.getSize();
+        _prefetched.pop_front();
+    }
+    _prefetched.emplace_back(fullPath, std::move(data));
+    _prefetchedBytes += size;
+}
+
+void FileIOPool::dropPrefetched(const std::string& fullPath)
+{
+    // _mutex is locked by the caller
+    for (auto iter = _prefetched.begin(); iter != _prefetched.end(); ++iter)
+    {
+        if (iter->first == fullPath)
+        {
+            _prefetchedBytes -= iter->second.getSize();
+            _prefetched.erase(iter);
+            return;
+        }
+    }
+}
+
+void FileIOPool::run()
+{
+    Tracer::setThreadName("FileIO");
+
+    for (;;)
+    {
+        tIORequest* request = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this, &request] { return _stop || (request = takeNextRequest()) != nullptr; });
+            if (!request)
+                return;
+        }
+
+        bool written = false;
+        Data data;
+        if (request->write)
+        {
+            CC_TRACE_SCOPE("FileIOPool::write");
+            written = FileUtils::getInstance()->writeDataToFile(request->data, request->fullPath);
+        }
+        else if (!takePrefetched(request->fullPath, &data))
+        {
+            CC_TRACE_SCOPE("FileIOPool::read");
+            data = FileUtils::getInstance()->getDataFromFile(request->fullPath);
+        }
+
+        std::vector<std::pair<unsigned int, ReadHandler>> readers;
+        std::vector<std::pair<unsigned int, std::function<void(bool)>>> writers;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _busyPaths.erase(request->fullPath);
+            --_runningCount;
+            if (!request->write)
+                removeRequest(request);
+            else
+                dropPrefetched(request->fullPath);  // read by a prefetch running before the write
+            readers.swap(request->readers);
+            writers.swap(request->writers);
+            for (const auto& reader : readers)
+                _requestsById[reader.first] = nullptr;
+            for (const auto& writer : writers)
+                _requestsById[writer.first] = nullptr;
+        }
+        // a request of the same file may be runnable now
+        _condition.notify_all();
+
+        std::vector<tCompletion> completions;
+        if (!request->write && readers.empty())
+        {
+            keepPrefetched(request->fullPath, data);
+        }
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            completions.emplace_back(readers[i].first, readers[i].second(data, i + 1 == readers.size()));
+        }
+        for (auto& writer : writers)
+        {
+            std::function<void()> completion;
+            if (writer.second)
+                completion = std::bind(writer.second, written);
+            completions.emplace_back(writer.first, std::move(completion));
+        }
+        delete request;
+
+        deliver(completions);
+    }
+}
+
+void FileIOPool::deliver(std::vector<tCompletion>& completions)
+{
+    if (completions.empty())
+        return;
+
+    auto queue = _completionQueue;
+    bool schedule = false;
+    {
+        // the requests cancelled since they completed are dropped,
+        // the others can be cancelled in the queue until they are delivered
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::lock_guard<std::mutex> queueLock(queue->mutex);
+        for (auto& completion : completions)
+        {
+            if (_requestsById.erase(completion.first) != 0 && completion.second)
+                queue->completions.push_back(std::move(completion));
+        }
+        if (!queue->scheduled && queue->next < queue->completions.size())
+        {
+            queue->scheduled = true;
+            schedule = true;
+        }
+    }
+
+    // the completions queued until the delivery ends are called with it
+    if (schedule)
+    {
+        Director::getInstance()->getScheduler()->performFunctionInCocosThread([queue] {
+            for (;;)
+            {
+                tCompletion completion;
+                {
+                    std::lock_guard<std::mutex> lock(queue->mutex);
+                    if (queue->next == queue->completions.size())
+                    {
+                        queue->completions.clear();
+                        queue->next = 0;
+                        queue->scheduled = false;
+                        break;
+                    }
+                    completion = std::move(queue->completions[queue->next++]);
+                }
+
+                // cancelled by a previous completion
+                if (completion.second)
+                    completion.second();
+            }
+        });
+    }
+}
+
+NS_CC_END
@@ -0,0 +1,187 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_FILE_IO_POOL_H__
+#define __CC_FILE_IO_POOL_H__
+
+#include <condition_variable>
+#include <functional>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCData.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ * @class FileIOPool
+ * @brief Threads reading and writing files for the asynchronous calls of FileUtils, e.g. FileUtils::readDataAsync.
+ *
+ * - The requests run by priority, then in the order they were made. A file is never read or written by two threads at once,
+ *   and its requests run in the order they were made: a request raises the priority of the earlier ones of its file.
+ * - The reads of a file waiting or running are coalesced, all the callers get its contents.
+ *   The writes of a file waiting are coalesced too, the last data is written.
+ *   A read or a write isn't coalesced with a request made before a request of the other kind of the same file.
+ * - A request can be cancelled until its completion is delivered, its callback isn't called then.
+ * - The completions are delivered to the cocos thread in batches, one Scheduler::performFunctionInCocosThread
+ *   for all the requests completed since the previous delivery.
+ * - prefetch reads a file ahead at a low priority and keeps it in memory for its next read, e.g. for the next
+ *   assets of a sequential stream. A write of the file drops it.
+ *
+ * @since v3.17
+ */
+class CC_DLL FileIOPool
+{
+public:
+    enum class Priority
+    {
+        LOW,
+        NORMAL,
+        HIGH,
+    };
+
+    /**
+     * Called on an I/O thread with the contents of a file, empty if it couldn't be read.
+     * It returns the completion to call on the cocos thread, e.g. with the file parsed. The data can be moved
+     * when last is true, the other handlers of the coalesced reads are called with it after.
+     */
+    typedef std::function<std::function<void()>(Data& data, bool last)> ReadHandler;
+
+    /** Size of the memory keeping the prefetched files by default, in bytes. */
+    static const size_t DEFAULT_PREFETCH_CACHE_SIZE = 8 * 1024 * 1024;
+
+    explicit FileIOPool(int threadCount = 2);
+    ~FileIOPool();
+
+    /**
+     * Reads a file.
+     *
+     * @param fullPath The full path of the file, see FileUtils::fullPathForFilename.
+     * @return The id of the request, for cancel, 0 if it couldn't be queued.
+     */
+    unsigned int read(const std::string& fullPath, Priority priority, ReadHandler handler);
+
+    /**
+     * Writes a file.
+     *
+     * @param callback Called on the cocos thread with whether the file was written, it can be empty.
+     * @return The id of the request, for cancel, 0 if it couldn't be queued.
+     */
+    unsigned int write(const std::string& fullPath, Data data, Priority priority, std::function<void(bool)> callback);
+
+    /** Reads a file at a low priority and keeps it for its next read, unless it is being read or already kept. */
+    void prefetch(const std::string& fullPath);
+
+    /**
+     * Cancels a request, the waiting requests without other callers are dropped.
+     * A running request still completes, e.g. a write still writes its file, only the callback isn't called.
+     * @return False if the request is unknown or its completion was already delivered.
+     */
+    bool cancel(unsigned int requestId);
+
+    /** Number of requests waiting or running. */
+    size_t getRequestCount() const;
+
+    /** Sets the size of the memory keeping the prefetched files, the oldest are dropped first. */
+    void setPrefetchCacheSize(size_t bytes);
+
+protected:
+    typedef struct _ioRequest
+    {
+        std::string fullPath;
+        bool write;
+        bool running;
+        Priority priority;
+        unsigned int sequence;
+        Data data;
+        std::vector<std::pair<unsigned int, ReadHandler>> readers;
+        std::vector<std::pair<unsigned int, std::function<void(bool)>>> writers;
+    } tIORequest;
+
+    // the completion of a request, empty when cancelled
+    typedef std::pair<unsigned int, std::function<void()>> tCompletion;
+
+    // shared with the pending deliveries, which may run after the pool is destroyed
+    typedef struct _completionQueue
+    {
+        std::mutex mutex;
+        std::vector<tCompletion> completions;
+        size_t next;    // the first completion not delivered yet
+        bool scheduled;
+    } tCompletionQueue;
+
+    // waiting requests order, the highest priority then the oldest first
+    typedef std::pair<int, unsigned int> tRequestOrder;
+    static tRequestOrder getOrder(const tIORequest* request) { return tRequestOrder(-(int)request->priority, request->sequence); }
+
+    tIORequest* addRequest(const std::string& fullPath, bool write, Priority priority);
+    void raisePriority(tIORequest* request, Priority priority);
+    void removeRequest(tIORequest* request);
+    tIORequest* takeNextRequest();
+    bool takePrefetched(const std::string& fullPath, Data* data);
+    void keepPrefetched(const std::string& fullPath, Data& data);
+    void dropPrefetched(const std::string& fullPath);
+    void run();
+    void deliver(std::vector<tCompletion>& completions);
+
+    std::vector<std::thread> _threads;
+    mutable std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _stop;
+
+    std::map<tRequestOrder, tIORequest*> _waiting;
+    std::unordered_map<std::string, tIORequest*> _reads;    // the last read waiting or running
+    std::unordered_map<std::string, tIORequest*> _writes;   // the last write waiting
+    std::unordered_map<unsigned int, tIORequest*> _requestsById;    // null once the request completed, until its completion is queued
+    std::unordered_set<std::string> _busyPaths;
+    size_t _runningCount;
+    unsigned int _nextId;
+    unsigned int _nextSequence;
+
+    std::list<std::pair<std::string, Data>> _prefetched;
+    size_t _prefetchedBytes;
+    size_t _prefetchCacheSize;
+
+    std::shared_ptr<tCompletionQueue> _completionQueue;
+};
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CC_FILE_IO_POOL_H__
@@ -27,11 +27,16 @@ THE SOFTWARE.
 ****************************************************************************/
 
 #include "base/CCScheduler.h"
+
+#include <algorithm>
+#include <unordered_map>
+
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
 #include "base/utlist.h"
-#include "base/ccCArray.h"
 #include "base/CCScriptSupport.h"
+#include "base/CCTracing.h"
+#include "base/allocator/CCAllocatorStrategyFrame.h"
 
 NS_CC_BEGIN
 
@@ -57,13 +62,30 @@ typedef struct _hashUpdateEntry
     UT_hash_handle      hh;
 } tHashUpdateEntry;
 
+// Hashes the bytes of a member function pointer
+struct SelectorHash
+{
+    size_t operator()(SEL_SCHEDULE selector) const
+    {
+        size_t words[(sizeof(selector) + sizeof(size_t) - 1) / sizeof(size_t)] = {};
+        memcpy(words, &selector, sizeof(selector));
+        size_t hash = 0;
+        for (auto word : words)
+        {
+            hash ^= std::hash<size_t>()(word) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+};
+
 // Hash Element used for "selectors with interval"
 typedef struct _hashSelectorEntry
 {
-    ccArray             *timers;
+    // the timers own a reference, looked up by key or selector
+    std::unordered_map<std::string, TimerTargetCallback*>                   callbackTimers;
+    std::unordered_map<SEL_SCHEDULE, TimerTargetSelector*, SelectorHash>    selectorTimers;
     void                *target;
-    int                 timerIndex;
-    Timer               *currentTimer;
+    double              pausedAt;      // scheduler time when the target was paused
     bool                paused;
     UT_hash_handle      hh;
 } tHashTimerEntry;
@@ -80,6 +102,11 @@ Timer::Timer()
 , _delay(0.0f)
 , _interval(0.0f)
 , _aborted(false)
+, _entry(nullptr)
+, _deadline(0.0)
+, _lastUpdate(0.0)
+, _sequence(0)
+, _heapIndex(-1)
 {
 }
 
@@ -151,6 +178,16 @@ bool Timer::isExhausted() const
     return !_runForever && _timesExecuted > _repeat;
 }
 
+float Timer::getTimeToNextTrigger() const
+{
+    // not started yet, the next update starts it
+    if (_elapsed == -1)
+    {
+        return 0;
+    }
+    return (_useDelay ? _delay : _interval) - _elapsed;
+}
+
 // TimerTargetSelector
 
 TimerTargetSelector::TimerTargetSelector()
@@ -178,7 +215,11 @@ void TimerTargetSelector::trigger(float dt)
 
 void TimerTargetSelector::cancel()
 {
-    _scheduler->unschedule(_selector, _target);
+    // an aborted timer is already unscheduled, possibly replaced by a timer for the same selector
+    if (!_aborted)
+    {
+        _scheduler->unschedule(_selector, _target);
+    }
 }
 
 // TimerTargetCallback
@@ -209,7 +250,11 @@ void TimerTargetCallback::trigger(float dt)
 
 void TimerTargetCallback::cancel()
 {
-    _scheduler->unschedule(_key, _target);
+    // an aborted timer is already unscheduled, possibly replaced by a timer for the same key
+    if (!_aborted)
+    {
+        _scheduler->unschedule(_key, _target);
+    }
 }
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -257,9 +302,10 @@ Scheduler::Scheduler(void)
 , _updatesPosList(nullptr)
 , _hashForUpdates(nullptr)
 , _hashForTimers(nullptr)
-, _currentTarget(nullptr)
-, _currentTargetSalvaged(false)
+, _timerSequence(0)
+, _timerClock(0.0)
 , _updateHashLocked(false)
+, _callbackCount(0)
 #if CC_ENABLE_SCRIPT_BINDING
 , _scriptHandlerEntries(20)
 #endif
@@ -271,67 +317,279 @@ Scheduler::Scheduler(void)
 Scheduler::~Scheduler(void)
 {
     unscheduleAll();
+
+    for (auto entry : _listEntryPool)
+        delete entry;
+    for (auto entry : _hashUpdateEntryPool)
+        delete entry;
+    for (auto entry : _hashTimerEntryPool)
+        delete entry;
 }
 
 void Scheduler::removeHashElement(_hashSelectorEntry *element)
 {
-    ccArrayFree(element->timers);
+    CCASSERT(element->callbackTimers.empty() && element->selectorTimers.empty(), "element's timers should be removed first");
     HASH_DEL(_hashForTimers, element);
-    free(element);
+    element->target = nullptr;
+    _hashTimerEntryPool.push_back(element);
 }
 
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+tHashTimerEntry* Scheduler::getTimerEntry(void *target, bool paused)
 {
-    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
-}
-
-void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
-{
-    CCASSERT(target, "Argument target must be non-nullptr");
-    CCASSERT(!key.empty(), "key should not be empty!");
-
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
 
     if (! element)
     {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
+        if (_hashTimerEntryPool.empty())
+        {
+            element = new (std::nothrow) tHashTimerEntry();
+        }
+        else
+        {
+            element = _hashTimerEntryPool.back();
+            _hashTimerEntryPool.pop_back();
+        }
+        memset(&element->hh, 0, sizeof(element->hh));
         element->target = target;
 
         HASH_ADD_PTR(_hashForTimers, target, element);
 
         // Is this the 1st element ? Then set the pause level to all the selectors of this target
         element->paused = paused;
+        element->pausedAt = _timerClock;
     }
     else
     {
         CCASSERT(element->paused == paused, "element's paused should be paused!");
     }
 
-    if (element->timers == nullptr)
+    return element;
+}
+
+void Scheduler::addTimer(tHashTimerEntry *element, Timer *timer)
+{
+    timer->_entry = element;
+    timer->_sequence = ++_timerSequence;
+    // due at the next update, which starts the timer
+    timer->_lastUpdate = timer->_deadline = element->paused ? element->pausedAt : _timerClock;
+    if (! element->paused)
+    {
+        pushTimer(timer);
+    }
+}
+
+void Scheduler::removeTimer(Timer *timer)
+{
+    // the timer may be running, aborting it stops its trigger loop
+    timer->setAborted();
+    eraseTimer(timer);
+    timer->release();
+}
+
+void Scheduler::restartTimer(Timer *timer)
+{
+    // a paused timer is shifted by the paused time when resumed
+    timer->_lastUpdate = timer->_deadline = timer->_entry->paused ? timer->_entry->pausedAt : _timerClock;
+    if (timer->_heapIndex >= 0)
+    {
+        siftTimerUp(timer->_heapIndex);
+    }
+}
+
+void Scheduler::pauseTimers(tHashTimerEntry *element)
+{
+    if (element->paused)
+    {
+        return;
+    }
+
+    element->paused = true;
+    element->pausedAt = _timerClock;
+    for (auto& iter : element->callbackTimers)
+        eraseTimer(iter.second);
+    for (auto& iter : element->selectorTimers)
+        eraseTimer(iter.second);
+}
+
+void Scheduler::resumeTimers(tHashTimerEntry *element)
+{
+    if (! element->paused)
+    {
+        return;
+    }
+
+    element->paused = false;
+
+    // the time spent paused doesn't count
+    double pausedTime = _timerClock - element->pausedAt;
+    auto resume = [this, pausedTime](Timer *timer) {
+        timer->_lastUpdate += pausedTime;
+        timer->_deadline += pausedTime;
+        if (timer->_heapIndex < 0)
+        {
+            pushTimer(timer);
+        }
+    };
+    for (auto& iter : element->callbackTimers)
+        resume(iter.second);
+    for (auto& iter : element->selectorTimers)
+        resume(iter.second);
+}
+
+void Scheduler::pushTimer(Timer *timer)
+{
+    timer->_heapIndex = (int)_timerHeap.size();
+    _timerHeap.push_back(timer);
+    siftTimerUp(timer->_heapIndex);
+}
+
+void Scheduler::eraseTimer(Timer *timer)
+{
+    int index = timer->_heapIndex;
+    if (index < 0)
+    {
+        return;
+    }
+
+    timer->_heapIndex = -1;
+    Timer *last = _timerHeap.back();
+    _timerHeap.pop_back();
+    if (last != timer)
+    {
+        _timerHeap[index] = last;
+        last->_heapIndex = index;
+        siftTimerUp(index);
+        siftTimerDown(last->_heapIndex);
+    }
+}
+
+// the timers due at the same time keep the order they were scheduled in
+bool Scheduler::isTimerBefore(const Timer *timer, const Timer *other)
+{
+    return timer->_deadline < other->_deadline
+        || (timer->_deadline == other->_deadline && timer->_sequence < other->_sequence);
+}
+
+void Scheduler::siftTimerUp(int index)
+{
+    Timer *timer = _timerHeap[index];
+    while (index > 0)
     {
-        element->timers = ccArrayNew(10);
+        int parent = (index - 1) / 2;
+        if (!isTimerBefore(timer, _timerHeap[parent]))
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[parent];
+        _timerHeap[index]->_heapIndex = index;
+        index = parent;
     }
-    else 
+    _timerHeap[index] = timer;
+    timer->_heapIndex = index;
+}
+
+void Scheduler::siftTimerDown(int index)
+{
+    Timer *timer = _timerHeap[index];
+    int count = (int)_timerHeap.size();
+    while (true)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        int child = index * 2 + 1;
+        if (child >= count)
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+            break;
+        }
+        if (child + 1 < count && isTimerBefore(_timerHeap[child + 1], _timerHeap[child]))
+        {
+            ++child;
+        }
+        if (!isTimerBefore(_timerHeap[child], timer))
+        {
+            break;
+        }
+        _timerHeap[index] = _timerHeap[child];
+        _timerHeap[index]->_heapIndex = index;
+        index = child;
+    }
+    _timerHeap[index] = timer;
+    timer->_heapIndex = index;
+}
 
-            if (timer && !timer->isExhausted() && key == timer->getKey())
-            {
-                CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
-                timer->setupTimerWithInterval(interval, repeat, delay);
-                return;
-            }
+tListEntry* Scheduler::newListEntry()
+{
+    if (_listEntryPool.empty())
+    {
+        return new (std::nothrow) tListEntry();
+    }
+
+    tListEntry *entry = _listEntryPool.back();
+    _listEntryPool.pop_back();
+    return entry;
+}
+
+void Scheduler::recycleListEntry(tListEntry *entry)
+{
+    // release what the callback captured
+    entry->callback = nullptr;
+    _listEntryPool.push_back(entry);
+}
+
+tHashUpdateEntry* Scheduler::newHashUpdateEntry()
+{
+    tHashUpdateEntry *entry = nullptr;
+    if (_hashUpdateEntryPool.empty())
+    {
+        entry = new (std::nothrow) tHashUpdateEntry();
+    }
+    else
+    {
+        entry = _hashUpdateEntryPool.back();
+        _hashUpdateEntryPool.pop_back();
+    }
+    memset(&entry->hh, 0, sizeof(entry->hh));
+    return entry;
+}
+
+void Scheduler::recycleHashUpdateEntry(tHashUpdateEntry *entry)
+{
+    entry->callback = nullptr;
+    _hashUpdateEntryPool.push_back(entry);
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, bool paused, const std::string& key)
+{
+    this->schedule(callback, target, interval, CC_REPEAT_FOREVER, 0.0f, paused, key);
+}
+
+void Scheduler::schedule(const ccSchedulerFunc& callback, void *target, float interval, unsigned int repeat, float delay, bool paused, const std::string& key)
+{
+    CCASSERT(target, "Argument target must be non-nullptr");
+    CCASSERT(!key.empty(), "key should not be empty!");
+
+    tHashTimerEntry *element = getTimerEntry(target, paused);
+
+    auto iter = element->callbackTimers.find(key);
+    if (iter != element->callbackTimers.end())
+    {
+        TimerTargetCallback *timer = iter->second;
+        if (!timer->isExhausted())
+        {
+            CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
+            timer->setupTimerWithInterval(interval, repeat, delay);
+            restartTimer(timer);
+            return;
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
+
+        // rescheduled from its last trigger, the new timer takes its place
+        element->callbackTimers.erase(iter);
+        removeTimer(timer);
     }
 
     TimerTargetCallback *timer = new (std::nothrow) TimerTargetCallback();
     timer->initWithCallback(this, callback, target, key, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
-    timer->release();
+    element->callbackTimers.emplace(key, timer);
+    addTimer(element, timer);
 }
 
 void Scheduler::unschedule(const std::string &key, void *target)
@@ -342,47 +600,21 @@ void Scheduler::unschedule(const std::string &key, void *target)
         return;
     }
 
-    //CCASSERT(target);
-    //CCASSERT(selector);
-
     tHashTimerEntry *element = nullptr;
     HASH_FIND_PTR(_hashForTimers, &target, element);
 
     if (element)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        auto iter = element->callbackTimers.find(key);
+        if (iter != element->callbackTimers.end())
         {
-            TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
+            TimerTargetCallback *timer = iter->second;
+            element->callbackTimers.erase(iter);
+            removeTimer(timer);
 
-            if (timer && key == timer->getKey())
+            if (element->callbackTimers.empty() && element->selectorTimers.empty())
             {
-                if (timer == element->currentTimer && (! timer->isAborted()))
-                {
-                    timer->retain();
-                    timer->setAborted();
-                }
-
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
-
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
-
-                return;
+                removeHashElement(element);
             }
         }
     }
@@ -390,7 +622,7 @@ void Scheduler::unschedule(const std::string &key, void *target)
 
 void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
+    tListEntry *listElement = newListEntry();
 
     listElement->callback = callback;
     listElement->target = target;
@@ -438,17 +670,16 @@ void Scheduler::priorityIn(tListEntry **list, const ccSchedulerFunc& callback, v
     }
 
     // update hash entry for quick access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
+    tHashUpdateEntry *hashElement = newHashUpdateEntry();
     hashElement->target = target;
     hashElement->list = list;
     hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
     HASH_ADD_PTR(_hashForUpdates, target, hashElement);
 }
 
 void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, void *target, bool paused)
 {
-    tListEntry *listElement = new (std::nothrow) tListEntry();
+    tListEntry *listElement = newListEntry();
 
     listElement->callback = callback;
     listElement->target = target;
@@ -459,11 +690,10 @@ void Scheduler::appendIn(_listEntry **list, const ccSchedulerFunc& callback, voi
     DL_APPEND(*list, listElement);
 
     // update hash entry for quicker access
-    tHashUpdateEntry *hashElement = (tHashUpdateEntry *)calloc(sizeof(*hashElement), 1);
+    tHashUpdateEntry *hashElement = newHashUpdateEntry();
     hashElement->target = target;
     hashElement->list = list;
     hashElement->entry = listElement;
-    memset(&hashElement->hh, 0, sizeof(hashElement->hh));
     HASH_ADD_PTR(_hashForUpdates, target, hashElement);
 }
 
@@ -516,22 +746,8 @@ bool Scheduler::isScheduled(const std::string& key, const void *target) const
         return false;
     }
     
-    if (element->timers == nullptr)
-    {
-        return false;
-    }
-    
-    for (int i = 0; i < element->timers->num; ++i)
-    {
-        TimerTargetCallback *timer = dynamic_cast<TimerTargetCallback*>(element->timers->arr[i]);
-        
-        if (timer && !timer->isExhausted() && key == timer->getKey())
-        {
-            return true;
-        }
-    }
-    
-    return false;
+    auto iter = element->callbackTimers.find(key);
+    return iter != element->callbackTimers.end() && !iter->second->isExhausted();
 }
 
 void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
@@ -544,7 +760,7 @@ void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
         // list entry
         DL_DELETE(*element->list, element->entry);
         if (!_updateHashLocked)
-            CC_SAFE_DELETE(element->entry);
+            recycleListEntry(element->entry);
         else
         {
             element->entry->markedForDeletion = true;
@@ -553,7 +769,7 @@ void Scheduler::removeUpdateFromHash(struct _listEntry *entry)
 
         // hash entry
         HASH_DEL(_hashForUpdates, element);
-        free(element);
+        recycleHashUpdateEntry(element);
     }
 }
 
@@ -636,22 +852,16 @@ void Scheduler::unscheduleAllForTarget(void *target)
 
     if (element)
     {
-        if (ccArrayContainsObject(element->timers, element->currentTimer)
-            && (! element->currentTimer->isAborted()))
-        {
-            element->currentTimer->retain();
-            element->currentTimer->setAborted();
-        }
-        ccArrayRemoveAllObjects(element->timers);
-
-        if (_currentTarget == element)
-        {
-            _currentTargetSalvaged = true;
-        }
-        else
-        {
-            removeHashElement(element);
-        }
+        auto callbackTimers = std::move(element->callbackTimers);
+        auto selectorTimers = std::move(element->selectorTimers);
+        element->callbackTimers.clear();
+        element->selectorTimers.clear();
+        removeHashElement(element);
+
+        for (auto& iter : callbackTimers)
+            removeTimer(iter.second);
+        for (auto& iter : selectorTimers)
+            removeTimer(iter.second);
     }
 
     // update selector
@@ -690,7 +900,7 @@ void Scheduler::resumeTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = false;
+        resumeTimers(element);
     }
 
     // update selector
@@ -712,7 +922,7 @@ void Scheduler::pauseTarget(void *target)
     HASH_FIND_PTR(_hashForTimers, &target, element);
     if (element)
     {
-        element->paused = true;
+        pauseTimers(element);
     }
 
     // update selector
@@ -761,7 +971,7 @@ std::set<void*> Scheduler::pauseAllTargetsWithMinPriority(int minPriority)
     for(tHashTimerEntry *element = _hashForTimers; element != nullptr;
         element = (tHashTimerEntry*)element->hh.next)
     {
-        element->paused = true;
+        pauseTimers(element);
         idsWithSelectors.insert(element->target);
     }
 
@@ -822,6 +1032,7 @@ void Scheduler::removeAllFunctionsToBePerformedInCocosThread()
 // main loop
 void Scheduler::update(float dt)
 {
+    CC_TRACE_SCOPE("Scheduler::update");
     _updateHashLocked = true;
 
     if (_timeScale != 1.0f)
@@ -842,6 +1053,8 @@ void Scheduler::update(float dt)
         if ((! entry->paused) && (! entry->markedForDeletion))
         {
             entry->callback(dt);
+            if (entry->priority != PRIORITY_SYSTEM)
+                ++_callbackCount;
         }
     }
 
@@ -851,6 +1064,7 @@ void Scheduler::update(float dt)
         if ((! entry->paused) && (! entry->markedForDeletion))
         {
             entry->callback(dt);
+            ++_callbackCount;
         }
     }
 
@@ -860,58 +1074,54 @@ void Scheduler::update(float dt)
         if ((! entry->paused) && (! entry->markedForDeletion))
         {
             entry->callback(dt);
+            ++_callbackCount;
         }
     }
 
-    // Iterate over all the custom selectors
-    for (tHashTimerEntry *elt = _hashForTimers; elt != nullptr; )
+    // Custom selectors: only the due timers are updated
+    _timerClock += dt;
+
+    // popped by deadline then sequence, so the timers due this frame are updated in that order
+    while (!_timerHeap.empty() && _timerHeap[0]->_deadline <= _timerClock)
     {
-        _currentTarget = elt;
-        _currentTargetSalvaged = false;
+        Timer *timer = _timerHeap[0];
+        eraseTimer(timer);
+        // The callbacks may unschedule any timer. To prevent a due timer from
+        // being deallocated before its step, it's retained until the step is done.
+        timer->retain();
+        _dueTimers.push_back(timer);
+    }
 
-        if (! _currentTarget->paused)
+    for (auto timer : _dueTimers)
+    {
+        // unscheduled or paused by a previous callback
+        if (!timer->isAborted() && !timer->_entry->paused)
         {
-            // The 'timers' array may change while inside this loop
-            for (elt->timerIndex = 0; elt->timerIndex < elt->timers->num; ++(elt->timerIndex))
-            {
-                elt->currentTimer = (Timer*)(elt->timers->arr[elt->timerIndex]);
-                CCASSERT
-                  ( !elt->currentTimer->isAborted(),
-                    "An aborted timer should not be updated" );
-
-                elt->currentTimer->update(dt);
+            // resumed by a previous callback
+            eraseTimer(timer);
 
-                if (elt->currentTimer->isAborted())
-                {
-                    // The currentTimer told the remove itself. To prevent the timer from
-                    // accidentally deallocating itself before finishing its step, we retained
-                    // it. Now that step is done, it's safe to release it.
-                    elt->currentTimer->release();
-                }
+            // the elapsed time is accumulated since the last update, the 1st update starts the timer
+            timer->update((float)(_timerClock - timer->_lastUpdate));
+            timer->_lastUpdate = _timerClock;
+            ++_callbackCount;
 
-                elt->currentTimer = nullptr;
+            if (!timer->isAborted() && !timer->_entry->paused && timer->_heapIndex < 0)
+            {
+                timer->_deadline = _timerClock + std::max(timer->getTimeToNextTrigger(), 0.0f);
+                pushTimer(timer);
             }
         }
-
-        // elt, at this moment, is still valid
-        // so it is safe to ask this here (issue #490)
-        elt = (tHashTimerEntry *)elt->hh.next;
-
-        // only delete currentTarget if no actions were scheduled during the cycle (issue #481)
-        if (_currentTargetSalvaged && _currentTarget->timers->num == 0)
-        {
-            removeHashElement(_currentTarget);
-        }
+        timer->release();
     }
+    _dueTimers.clear();
  
     // delete all updates that are removed in update
     for (auto &e : _updateDeleteVector)
-        delete e;
+        recycleListEntry(e);
 
     _updateDeleteVector.clear();
 
     _updateHashLocked = false;
-    _currentTarget = nullptr;
 
 #if CC_ENABLE_SCRIPT_BINDING
     //
@@ -931,6 +1141,7 @@ void Scheduler::update(float dt)
             else if (!eachEntry->isPaused())
             {
                 eachEntry->getTimer()->update(dt);
+                ++_callbackCount;
             }
         }
     }
@@ -944,12 +1155,16 @@ void Scheduler::update(float dt)
     if( !_functionsToPerform.empty() ) {
         _performMutex.lock();
         // fixed #4123: Save the callback functions, they must be invoked after '_performMutex.unlock()', otherwise if new functions are added in callback, it will cause thread deadlock.
-        auto temp = std::move(_functionsToPerform);
+        // the member keeps its capacity, the copy lives in the frame allocator
+        allocator::FrameVector<std::function<void()>> temp(std::make_move_iterator(_functionsToPerform.begin()),
+                                                           std::make_move_iterator(_functionsToPerform.end()));
+        _functionsToPerform.clear();
         _performMutex.unlock();
         
         for (const auto &function : temp) {
             function();
         }
+        _callbackCount += static_cast<unsigned int>(temp.size());
     }
 }
 
@@ -957,48 +1172,29 @@ void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, uns
 {
     CCASSERT(target, "Argument target must be non-nullptr");
     
-    tHashTimerEntry *element = nullptr;
-    HASH_FIND_PTR(_hashForTimers, &target, element);
-    
-    if (! element)
-    {
-        element = (tHashTimerEntry *)calloc(sizeof(*element), 1);
-        element->target = target;
-        
-        HASH_ADD_PTR(_hashForTimers, target, element);
-        
-        // Is this the 1st element ? Then set the pause level to all the selectors of this target
-        element->paused = paused;
-    }
-    else
-    {
-        CCASSERT(element->paused == paused, "element's paused should be paused.");
-    }
+    tHashTimerEntry *element = getTimerEntry(target, paused);
     
-    if (element->timers == nullptr)
+    auto iter = element->selectorTimers.find(selector);
+    if (iter != element->selectorTimers.end())
     {
-        element->timers = ccArrayNew(10);
-    }
-    else
-    {
-        for (int i = 0; i < element->timers->num; ++i)
+        TimerTargetSelector *timer = iter->second;
+        if (!timer->isExhausted())
         {
-            TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
-            
-            if (timer && !timer->isExhausted() && selector == timer->getSelector())
-            {
-                CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
-                timer->setupTimerWithInterval(interval, repeat, delay);
-                return;
-            }
+            CCLOG("CCScheduler#schedule. Reiniting timer with interval %.4f, repeat %u, delay %.4f", interval, repeat, delay);
+            timer->setupTimerWithInterval(interval, repeat, delay);
+            restartTimer(timer);
+            return;
         }
-        ccArrayEnsureExtraCapacity(element->timers, 1);
+        
+        // rescheduled from its last trigger, the new timer takes its place
+        element->selectorTimers.erase(iter);
+        removeTimer(timer);
     }
     
     TimerTargetSelector *timer = new (std::nothrow) TimerTargetSelector();
     timer->initWithSelector(this, selector, target, interval, repeat, delay);
-    ccArrayAppendObject(element->timers, timer);
-    timer->release();
+    element->selectorTimers.emplace(selector, timer);
+    addTimer(element, timer);
 }
 
 void Scheduler::schedule(SEL_SCHEDULE selector, Ref *target, float interval, bool paused)
@@ -1019,22 +1215,8 @@ bool Scheduler::isScheduled(SEL_SCHEDULE selector, const Ref *target) const
         return false;
     }
     
-    if (element->timers == nullptr)
-    {
-        return false;
-    }
-
-    for (int i = 0; i < element->timers->num; ++i)
-    {
-        TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
-        
-        if (timer && !timer->isExhausted() && selector == timer->getSelector())
-        {
-            return true;
-        }
-    }
-    
-    return false;
+    auto iter = element->selectorTimers.find(selector);
+    return iter != element->selectorTimers.end() && !iter->second->isExhausted();
 }
 
 void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
@@ -1050,39 +1232,16 @@ void Scheduler::unschedule(SEL_SCHEDULE selector, Ref *target)
     
     if (element)
     {
-        for (int i = 0; i < element->timers->num; ++i)
+        auto iter = element->selectorTimers.find(selector);
+        if (iter != element->selectorTimers.end())
         {
-            TimerTargetSelector *timer = dynamic_cast<TimerTargetSelector*>(element->timers->arr[i]);
+            TimerTargetSelector *timer = iter->second;
+            element->selectorTimers.erase(iter);
+            removeTimer(timer);
             
-            if (timer && selector == timer->getSelector())
+            if (element->callbackTimers.empty() && element->selectorTimers.empty())
             {
-                if (timer == element->currentTimer && !timer->isAborted())
-                {
-                    timer->retain();
-                    timer->setAborted();
-                }
-                
-                ccArrayRemoveObjectAtIndex(element->timers, i, true);
-                
-                // update timerIndex in case we are in tick:, looping over the actions
-                if (element->timerIndex >= i)
-                {
-                    element->timerIndex--;
-                }
-                
-                if (element->timers->num == 0)
-                {
-                    if (_currentTarget == element)
-                    {
-                        _currentTargetSalvaged = true;
-                    }
-                    else
-                    {
-                        removeHashElement(element);
-                    }
-                }
-                
-                return;
+                removeHashElement(element);
             }
         }
     }
@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include <functional>
 #include <mutex>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "base/CCRef.h"
 #include "base/CCVector.h"
@@ -40,6 +42,7 @@ THE SOFTWARE.
 NS_CC_BEGIN
 
 class Scheduler;
+struct _hashSelectorEntry;
 
 typedef std::function<void(float)> ccSchedulerFunc;
 
@@ -63,6 +66,11 @@ public:
     void update(float dt);
     
 protected:
+    friend class Scheduler;
+
+    /** Time left before the next trigger, from the elapsed time. */
+    float getTimeToNextTrigger() const;
+
     Scheduler* _scheduler; // weak ref
     float _elapsed;
     bool _runForever;
@@ -72,6 +80,13 @@ protected:
     float _delay;
     float _interval;
     bool _aborted;
+
+    // Scheduler bookkeeping
+    struct _hashSelectorEntry* _entry; // weak ref, the target entry owning the timer
+    double _deadline;   // scheduler time of the next update
+    double _lastUpdate; // scheduler time of the last update
+    unsigned long long _sequence; // order of scheduling, the timers due at the same time are updated in it
+    int _heapIndex;     // index in the scheduler heap, -1 when out of it
 };
 
 
@@ -141,7 +156,6 @@ private:
  */
 
 struct _listEntry;
-struct _hashSelectorEntry;
 struct _hashUpdateEntry;
 
 #if CC_ENABLE_SCRIPT_BINDING
@@ -158,6 +172,9 @@ There are 2 different types of callbacks (selectors):
 
 The 'custom selectors' should be avoided when possible. It is faster, and consumes less memory to use the 'update selector'.
 
+The custom selectors are kept in a min-heap ordered by their next trigger time, so each frame
+only touches the timers that are due, no matter how many callbacks are scheduled.
+
 */
 class CC_DLL Scheduler : public Ref
 {
@@ -205,6 +222,12 @@ public:
     */
     void setTimeScale(float timeScale) { _timeScale = timeScale; }
 
+    /** Gets the number of callbacks called so far, the system ones such as the ActionManager's excluded.
+     * The functions given to performFunctionInCocosThread are counted too.
+     * @since v3.17
+     */
+    unsigned int getCallbackCount() const { return _callbackCount; }
+
     /** 'update' the scheduler.
      * You should NEVER call this method, unless you know what you are doing.
      * @lua NA
@@ -510,6 +533,28 @@ protected:
     void removeHashElement(struct _hashSelectorEntry *element);
     void removeUpdateFromHash(struct _listEntry *entry);
 
+    // custom selectors specific
+
+    struct _hashSelectorEntry* getTimerEntry(void *target, bool paused);
+    void addTimer(struct _hashSelectorEntry *element, Timer *timer);
+    void removeTimer(Timer *timer);
+    void restartTimer(Timer *timer);
+    void pauseTimers(struct _hashSelectorEntry *element);
+    void resumeTimers(struct _hashSelectorEntry *element);
+
+    void pushTimer(Timer *timer);
+    void eraseTimer(Timer *timer);
+    static bool isTimerBefore(const Timer *timer, const Timer *other);
+    void siftTimerUp(int index);
+    void siftTimerDown(int index);
+
+    // entry pools
+
+    struct _listEntry* newListEntry();
+    void recycleListEntry(struct _listEntry *entry);
+    struct _hashUpdateEntry* newHashUpdateEntry();
+    void recycleHashUpdateEntry(struct _hashUpdateEntry *entry);
+
     // update specific
 
     void priorityIn(struct _listEntry **list, const ccSchedulerFunc& callback, void *target, int priority, bool paused);
@@ -529,10 +574,18 @@ protected:
 
     // Used for "selectors with interval"
     struct _hashSelectorEntry *_hashForTimers;
-    struct _hashSelectorEntry *_currentTarget;
-    bool _currentTargetSalvaged;
+    std::vector<Timer*> _timerHeap;     // timers of the running targets, min-heap on their deadline then sequence
+    unsigned long long _timerSequence;  // sequence of the last scheduled timer
+    std::vector<Timer*> _dueTimers;     // timers being updated this frame
+    double _timerClock;                 // scaled time elapsed since the scheduler creation
     // If true unschedule will not remove anything from a hash. Elements will only be marked for deletion.
     bool _updateHashLocked;
+    unsigned int _callbackCount;        // callbacks called, the system ones excluded
+
+    // Recycled entries, so that scheduling doesn't allocate once the pools are warm
+    std::vector<struct _listEntry *> _listEntryPool;
+    std::vector<struct _hashUpdateEntry *> _hashUpdateEntryPool;
+    std::vector<struct _hashSelectorEntry *> _hashTimerEntryPool;
     
 #if CC_ENABLE_SCRIPT_BINDING
     Vector<SchedulerScriptHandlerEntry*> _scriptHandlerEntries;
@@ -0,0 +1,572 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCStreamReader.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "base/ccMacros.h"
+#include "base/ccUTF8.h"
+#include "base/ccUtils.h"
+#include "platform/CCFileUtils.h"
+#include "platform/CCSAXParser.h"
+#include "json/reader.h"
+#include "json/memorystream.h"
+#include "json/error/en.h"
+
+NS_CC_BEGIN
+
+StreamSchema::StreamSchema()
+{
+}
+
+StreamSchema::tSchemaField& StreamSchema::addField(const std::string& key, FieldType type)
+{
+    _fields.emplace_back();
+    tSchemaField& field = _fields.back();
+    field.key = key;
+    field.type = type;
+    field.required = false;
+    return field;
+}
+
+const StreamSchema::tSchemaField* StreamSchema::findField(const char* key, size_t length) const
+{
+    for (const auto& field : _fields)
+    {
+        if (field.key.size() == length && memcmp(field.key.data(), key, length) == 0)
+            return &field;
+    }
+    return nullptr;
+}
+
+StreamSchema& StreamSchema::onInt(const std::string& key, const std::function<bool(int)>& callback)
+{
+    addField(key, FieldType::INTEGER).intCallback = callback;
+    return *this;
+}
+
+StreamSchema& StreamSchema::onDouble(const std::string& key, const std::function<bool(double)>& callback)
+{
+    addField(key, FieldType::DOUBLE).doubleCallback = callback;
+    return *this;
+}
+
+StreamSchema& StreamSchema::onBool(const std::string& key, const std::function<bool(bool)>& callback)
+{
+    addField(key, FieldType::BOOLEAN).boolCallback = callback;
+    return *this;
+}
+
+StreamSchema& StreamSchema::onString(const std::string& key, const std::function<bool(const char*, size_t)>& callback)
+{
+    addField(key, FieldType::STRING).stringCallback = callback;
+    return *this;
+}
+
+StreamSchema& StreamSchema::onObject(const std::string& key, const StreamSchema& schema, const Callback& begin, const Callback& end)
+{
+    tSchemaField& field = addField(key, FieldType::OBJECT);
+    field.schema = std::make_shared<StreamSchema>(schema);
+    field.begin = begin;
+    field.end = end;
+    return *this;
+}
+
+StreamSchema& StreamSchema::onArray(const std::string& key, const StreamSchema& elementSchema, const Callback& beginElement, const Callback& endElement)
+{
+    tSchemaField& field = addField(key, FieldType::ARRAY);
+    field.schema = std::make_shared<StreamSchema>(elementSchema);
+    field.begin = beginElement;
+    field.end = endElement;
+    return *this;
+}
+
+StreamSchema& StreamSchema::required()
+{
+    CCASSERT(!_fields.empty(), "required() follows the key it applies to");
+    // the keys seen in an object are tracked in 64 bits
+    CCASSERT(_fields.size() <= 64, "at most 64 keys in a schema with required keys");
+    _fields.back().required = true;
+    return *this;
+}
+
+// Matches the events of a document against a schema, the JSON and plist readers below produce the events.
+class StreamReaderHandler
+{
+public:
+    StreamReaderHandler(const StreamSchema& schema, std::string* error)
+    : _schema(schema)
+    , _error(error)
+    , _skippedDepth(0)
+    , _rootRead(false)
+    {
+    }
+
+    bool failed() const { return !_error->empty(); }
+
+    // called after the document was read without error
+    bool finish()
+    {
+        if (!_rootRead)
+        {
+            *_error = "the root isn't an object";
+            return false;
+        }
+        return true;
+    }
+
+    bool startObject()
+    {
+        if (_skippedDepth > 0)
+        {
+            ++_skippedDepth;
+            return true;
+        }
+
+        tReadFrame frame;
+        frame.array = false;
+        frame.valueField = nullptr;
+        frame.seen = 0;
+        if (_frames.empty())
+        {
+            // the top level values after the root are ignored
+            if (_rootRead)
+            {
+                ++_skippedDepth;
+                return true;
+            }
+            _rootRead = true;
+            frame.schema = &_schema;
+            frame.end = nullptr;
+        }
+        else
+        {
+            bool element = _frames.back().array;
+            const StreamSchema::tSchemaField* field = takeValueField();
+            if (!field)
+            {
+                ++_skippedDepth;
+                return true;
+            }
+            if (!element && field->type != StreamSchema::FieldType::OBJECT)
+                return fail("an object", field);
+
+            // an object of an array is read with the element schema
+            if (field->begin && !field->begin())
+                return stop();
+            frame.schema = field->schema.get();
+            frame.end = &field->end;
+        }
+        _frames.push_back(frame);
+        return true;
+    }
+
+    bool endObject()
+    {
+        if (_skippedDepth > 0)
+        {
+            --_skippedDepth;
+            return true;
+        }
+
+        const tReadFrame& frame = _frames.back();
+        const auto& fields = frame.schema->_fields;
+        for (size_t i = 0; i < fields.size(); ++i)
+        {
+            if (fields[i].required && (frame.seen & ((uint64_t)1 << i)) == 0)
+            {
+                *_error = StringUtils::format("missing key \"%s\"", fields[i].key.c_str());
+                return false;
+            }
+        }
+
+        const StreamSchema::Callback* end = frame.end;
+        _frames.pop_back();
+        if (end && *end && !(*end)())
+            return stop();
+        return true;
+    }
+
+    bool startArray()
+    {
+        if (_skippedDepth > 0 || _frames.empty())
+        {
+            ++_skippedDepth;
+            return true;
+        }
+
+        const StreamSchema::tSchemaField* field = takeValueField();
+        if (!field)
+        {
+            ++_skippedDepth;
+            return true;
+        }
+        if (field->type != StreamSchema::FieldType::ARRAY)
+            return fail("an array", field);
+
+        tReadFrame frame;
+        frame.schema = field->schema.get();
+        frame.array = true;
+        frame.valueField = field;
+        frame.seen = 0;
+        frame.end = nullptr;
+        _frames.push_back(frame);
+        return true;
+    }
+
+    bool endArray()
+    {
+        if (_skippedDepth > 0)
+        {
+            --_skippedDepth;
+            return true;
+        }
+        _frames.pop_back();
+        return true;
+    }
+
+    bool key(const char* key, size_t length)
+    {
+        if (_skippedDepth > 0)
+            return true;
+
+        tReadFrame& frame = _frames.back();
+        frame.valueField = frame.schema->findField(key, length);
+        if (frame.valueField && frame.valueField->required)
+            frame.seen |= (uint64_t)1 << (frame.valueField - &frame.schema->_fields[0]);
+        return true;
+    }
+
+    bool intValue(int64_t value)
+    {
+        const StreamSchema::tSchemaField* field = takeScalarField();
+        if (!field)
+            return !failed();
+
+        if (field->type == StreamSchema::FieldType::INTEGER && value >= INT_MIN && value <= INT_MAX)
+            return field->intCallback((int)value) || stop();
+        if (field->type == StreamSchema::FieldType::DOUBLE)
+            return field->doubleCallback((double)value) || stop();
+        return fail("an integer", field);
+    }
+
+    bool doubleValue(double value)
+    {
+        const StreamSchema::tSchemaField* field = takeScalarField();
+        if (!field)
+            return !failed();
+
+        if (field->type == StreamSchema::FieldType::DOUBLE)
+            return field->doubleCallback(value) || stop();
+        return fail("a number", field);
+    }
+
+    bool boolValue(bool value)
+    {
+        const StreamSchema::tSchemaField* field = takeScalarField();
+        if (!field)
+            return !failed();
+
+        if (field->type == StreamSchema::FieldType::BOOLEAN)
+            return field->boolCallback(value) || stop();
+        return fail("a boolean", field);
+    }
+
+    bool stringValue(const char* value, size_t length)
+    {
+        const StreamSchema::tSchemaField* field = takeScalarField();
+        if (!field)
+            return !failed();
+
+        if (field->type == StreamSchema::FieldType::STRING)
+            return field->stringCallback(value, length) || stop();
+        return fail("a string", field);
+    }
+
+    bool nullValue()
+    {
+        // a null value is like a missing one
+        if (_skippedDepth == 0 && !_frames.empty() && !_frames.back().array)
+        {
+            tReadFrame& frame = _frames.back();
+            if (frame.valueField && frame.valueField->required)
+                frame.seen &= ~((uint64_t)1 << (frame.valueField - &frame.schema->_fields[0]));
+            frame.valueField = nullptr;
+        }
+        return true;
+    }
+
+private:
+    typedef struct _readFrame
+    {
+        const StreamSchema* schema;     // of the keys of an object, or of the elements of an array
+        bool array;
+        const StreamSchema::tSchemaField* valueField;  // of the next value of an object, or the field of an array
+        uint64_t seen;                  // the required keys seen
+        const StreamSchema::Callback* end;
+    } tReadFrame;
+
+    // the field of the container value starting, nullptr to skip it
+    const StreamSchema::tSchemaField* takeValueField()
+    {
+        tReadFrame& frame = _frames.back();
+        const StreamSchema::tSchemaField* field = frame.valueField;
+        if (!frame.array)
+            frame.valueField = nullptr;
+        return field;
+    }
+
+    // the field of the scalar value read, nullptr to skip it
+    const StreamSchema::tSchemaField* takeScalarField()
+    {
+        if (_skippedDepth > 0 || _frames.empty() || failed())
+            return nullptr;
+
+        tReadFrame& frame = _frames.back();
+        if (!frame.array)
+        {
+            const StreamSchema::tSchemaField* field = frame.valueField;
+            frame.valueField = nullptr;
+            return field;
+        }
+
+        const StreamSchema::tSchemaField* field = frame.schema->findField("", 0);
+        if (!field)
+            *_error = StringUtils::format("unexpected value in \"%s\"", frame.valueField->key.c_str());
+        return field;
+    }
+
+    bool fail(const char* expected, const StreamSchema::tSchemaField* field)
+    {
+        *_error = StringUtils::format("\"%s\" is %s, not of the type of the schema", field->key.c_str(), expected);
+        return false;
+    }
+
+    bool stop()
+    {
+        if (_error->empty())
+            *_error = "stopped by a callback";
+        return false;
+    }
+
+    const StreamSchema& _schema;
+    std::string* _error;
+    std::vector<tReadFrame> _frames;
+    int _skippedDepth;
+    bool _rootRead;
+};
+
+// rapidjson SAX handler
+class JsonStreamHandler : public RAPIDJSON_NAMESPACE::BaseReaderHandler<RAPIDJSON_NAMESPACE::UTF8<>, JsonStreamHandler>
+{
+public:
+    explicit JsonStreamHandler(StreamReaderHandler* handler) : _handler(handler) {}
+
+    bool Null() { return _handler->nullValue(); }
+    bool Bool(bool b) { return _handler->boolValue(b); }
+    bool Int(int i) { return _handler->intValue(i); }
+    bool Uint(unsigned u) { return _handler->intValue(u); }
+    bool Int64(int64_t i) { return _handler->intValue(i); }
+    bool Uint64(uint64_t u) { return u <= (uint64_t)INT64_MAX ? _handler->intValue((int64_t)u) : _handler->doubleValue((double)u); }
+    bool Double(double d) { return _handler->doubleValue(d); }
+    bool String(const char* str, RAPIDJSON_NAMESPACE::SizeType length, bool /*copy*/) { return _handler->stringValue(str, length); }
+    bool StartObject() { return _handler->startObject(); }
+    bool Key(const char* str, RAPIDJSON_NAMESPACE::SizeType length, bool /*copy*/) { return _handler->key(str, length); }
+    bool EndObject(RAPIDJSON_NAMESPACE::SizeType /*memberCount*/) { return _handler->endObject(); }
+    bool StartArray() { return _handler->startArray(); }
+    bool EndArray(RAPIDJSON_NAMESPACE::SizeType /*elementCount*/) { return _handler->endArray(); }
+
+private:
+    StreamReaderHandler* _handler;
+};
+
+// plist SAX delegator, reads the elements like DictMaker in CCFileUtils.cpp
+class PlistStreamHandler : public SAXDelegator
+{
+public:
+    explicit PlistStreamHandler(StreamReaderHandler* handler)
+    : _handler(handler)
+    , _textElement(TEXT_NONE)
+    {
+    }
+
+    void startElement(void* /*ctx*/, const char* name, const char** /*atts*/) override
+    {
+        if (_handler->failed())
+            return;
+
+        _textElement = TEXT_NONE;
+        if (strcmp(name, "dict") == 0)
+        {
+            _handler->startObject();
+        }
+        else if (strcmp(name, "array") == 0)
+        {
+            _handler->startArray();
+        }
+        else if (strcmp(name, "key") == 0)
+        {
+            _textElement = TEXT_KEY;
+        }
+        else if (strcmp(name, "string") == 0 || strcmp(name, "data") == 0 || strcmp(name, "date") == 0)
+        {
+            _textElement = TEXT_STRING;
+        }
+        else if (strcmp(name, "integer") == 0)
+        {
+            _textElement = TEXT_INTEGER;
+        }
+        else if (strcmp(name, "real") == 0)
+        {
+            _textElement = TEXT_REAL;
+        }
+        _text.clear();
+    }
+
+    void endElement(void* /*ctx*/, const char* name) override
+    {
+        if (_handler->failed())
+            return;
+
+        if (strcmp(name, "dict") == 0)
+        {
+            _handler->endObject();
+        }
+        else if (strcmp(name, "array") == 0)
+        {
+            _handler->endArray();
+        }
+        else if (strcmp(name, "true") == 0 || strcmp(name, "false") == 0)
+        {
+            _handler->boolValue(name[0] == 't');
+        }
+        else if (_textElement == TEXT_KEY)
+        {
+            _handler->key(_text.data(), _text.size());
+        }
+        else if (_textElement == TEXT_STRING)
+        {
+            _handler->stringValue(_text.c_str(), _text.size());
+        }
+        else if (_textElement == TEXT_INTEGER)
+        {
+            _handler->intValue(atoll(_text.c_str()));
+        }
+        else if (_textElement == TEXT_REAL)
+        {
+            _handler->doubleValue(utils::atof(_text.c_str()));
+        }
+        _textElement = TEXT_NONE;
+    }
+
+    void textHandler(void* /*ctx*/, const char* s, size_t len) override
+    {
+        if (_textElement != TEXT_NONE)
+        {
+            _text.append(s, len);
+        }
+    }
+
+private:
+    enum TextElement
+    {
+        TEXT_NONE,
+        TEXT_KEY,
+        TEXT_STRING,
+        TEXT_INTEGER,
+        TEXT_REAL,
+    };
+
+    StreamReaderHandler* _handler;
+    TextElement _textElement;
+    std::string _text;
+};
+
+StreamReader::StreamReader()
+{
+}
+
+bool StreamReader::parseJson(const char* data, size_t size, const StreamSchema& schema)
+{
+    _error.clear();
+    if (!data || size == 0)
+    {
+        _error = "empty document";
+        return false;
+    }
+
+    StreamReaderHandler handler(schema, &_error);
+    JsonStreamHandler jsonHandler(&handler);
+    RAPIDJSON_NAMESPACE::MemoryStream stream(data, size);
+    RAPIDJSON_NAMESPACE::Reader reader;
+    RAPIDJSON_NAMESPACE::ParseResult result = reader.Parse(stream, jsonHandler);
+    if (!result)
+    {
+        if (_error.empty())
+            _error = StringUtils::format("%s at offset %u", RAPIDJSON_NAMESPACE::GetParseError_En(result.Code()), (unsigned int)result.Offset());
+        return false;
+    }
+    return handler.finish();
+}
+
+bool StreamReader::parseJsonFile(const std::string& filename, const StreamSchema& schema)
+{
+    std::string content = FileUtils::getInstance()->getStringFromFile(filename);
+    return parseJson(content.data(), content.size(), schema);
+}
+
+bool StreamReader::parsePlist(const char* data, size_t size, const StreamSchema& schema)
+{
+    _error.clear();
+    if (!data || size == 0)
+    {
+        _error = "empty document";
+        return false;
+    }
+
+    // parsed in place, on a terminated copy
+    std::string xml(data, size);
+    StreamReaderHandler handler(schema, &_error);
+    PlistStreamHandler plistHandler(&handler);
+    SAXParser parser;
+    parser.setDelegator(&plistHandler);
+    if (!parser.parseIntrusive(&xml.front(), xml.size()))
+    {
+        if (_error.empty())
+            _error = "invalid plist";
+        return false;
+    }
+    return _error.empty() && handler.finish();
+}
+
+bool StreamReader::parsePlistFile(const std::string& filename, const StreamSchema& schema)
+{
+    std::string content = FileUtils::getInstance()->getStringFromFile(filename);
+    return parsePlist(content.data(), content.size(), schema);
+}
+
+NS_CC_END
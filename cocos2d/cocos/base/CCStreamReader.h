@@ -0,0 +1,159 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_STREAM_READER_H__
+#define __CC_STREAM_READER_H__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/**
+ * @class StreamSchema
+ * @brief The keys read from an object by StreamReader, with the callbacks receiving their values.
+ *
+ * The values are passed to the callbacks as they are parsed, the keys not in the schema are skipped with their values.
+ * A callback returns false to stop the parsing, e.g. when a value is out of range.
+ * @code
+ * StreamSchema position;
+ * position.onDouble("x", [&](double x) { card.position.x = x; return true; }).required()
+ *         .onDouble("y", [&](double y) { card.position.y = y; return true; }).required();
+ * StreamSchema cardSchema;
+ * cardSchema.onInt("face", [&](int face) { card.face = face; return true; }).required()
+ *           .onObject("position", position);
+ * StreamSchema root;
+ * root.onArray("cards", cardSchema, [&]() { card = Card(); return true; }, [&]() { cards.push_back(card); return true; });
+ * @endcode
+ *
+ * @since v3.17
+ */
+class CC_DLL StreamSchema
+{
+public:
+    typedef std::function<bool()> Callback;
+
+    StreamSchema();
+
+    /** An integer value. */
+    StreamSchema& onInt(const std::string& key, const std::function<bool(int)>& callback);
+    /** A number value, integer or real. */
+    StreamSchema& onDouble(const std::string& key, const std::function<bool(double)>& callback);
+    StreamSchema& onBool(const std::string& key, const std::function<bool(bool)>& callback);
+    /** A string value, valid during the call. */
+    StreamSchema& onString(const std::string& key, const std::function<bool(const char* value, size_t length)>& callback);
+
+    /**
+     * An object value, whose keys are read with a schema.
+     * @param begin Called before the keys of the object, it can be empty.
+     * @param end Called after them, it can be empty.
+     */
+    StreamSchema& onObject(const std::string& key, const StreamSchema& schema, const Callback& begin = nullptr, const Callback& end = nullptr);
+
+    /**
+     * An array value. Its objects are read with the element schema, between beginElement and endElement.
+     * Its other values are passed to the callback of the element schema with an empty key, e.g. onInt("", ...).
+     */
+    StreamSchema& onArray(const std::string& key, const StreamSchema& elementSchema, const Callback& beginElement = nullptr, const Callback& endElement = nullptr);
+
+    /** The last key added is required, the parsing fails when an object doesn't have it. */
+    StreamSchema& required();
+
+private:
+    friend class StreamReaderHandler;
+
+    enum class FieldType
+    {
+        INTEGER,
+        DOUBLE,
+        BOOLEAN,
+        STRING,
+        OBJECT,
+        ARRAY,
+    };
+
+    typedef struct _schemaField
+    {
+        std::string key;
+        FieldType type;
+        bool required;
+        std::function<bool(int)> intCallback;
+        std::function<bool(double)> doubleCallback;
+        std::function<bool(bool)> boolCallback;
+        std::function<bool(const char*, size_t)> stringCallback;
+        std::shared_ptr<StreamSchema> schema;   // of an object, or of the elements of an array
+        Callback begin;
+        Callback end;
+    } tSchemaField;
+
+    tSchemaField& addField(const std::string& key, FieldType type);
+    const tSchemaField* findField(const char* key, size_t length) const;
+
+    std::vector<tSchemaField> _fields;
+};
+
+/**
+ * @class StreamReader
+ * @brief Reads a JSON or plist document into the callbacks of a StreamSchema, without building the tree of the document.
+ *
+ * JSON is read by the SAX reader of rapidjson, plist by SAXParser. The root of the document must be an object,
+ * a dict for a plist, and is read with the schema.
+ *
+ * @since v3.17
+ */
+class CC_DLL StreamReader
+{
+public:
+    StreamReader();
+
+    /** Reads a JSON document. @return False if it isn't valid or doesn't match the schema, see getError. */
+    bool parseJson(const char* data, size_t size, const StreamSchema& schema);
+    bool parseJsonFile(const std::string& filename, const StreamSchema& schema);
+
+    /** Reads a plist document. @return False if it isn't valid or doesn't match the schema, see getError. */
+    bool parsePlist(const char* data, size_t size, const StreamSchema& schema);
+    bool parsePlistFile(const std::string& filename, const StreamSchema& schema);
+
+    /** Why the last parsing failed, empty if it succeeded. */
+    const std::string& getError() const { return _error; }
+
+private:
+    std::string _error;
+};
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CC_STREAM_READER_H__
@@ -0,0 +1,266 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#include "base/CCTracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "platform/CCFileUtils.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <pthread.h>
+#endif
+
+NS_CC_BEGIN
+
+typedef struct _traceEvent
+{
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+} tTraceEvent;
+
+// Ring buffer of a thread, only written by it. The buffers are never freed, the one of an exited thread is
+// kept for the exports until another thread takes it.
+typedef struct _traceBuffer
+{
+    tTraceEvent events[Tracer::BUFFER_CAPACITY];
+    std::atomic<uint64_t> written;
+    std::atomic<bool> inUse;
+    unsigned int threadId;
+    char threadName[32];
+} tTraceBuffer;
+
+// the buffer and name of a thread, the buffer is given back when the thread exits
+typedef struct _traceThread
+{
+    tTraceBuffer* buffer;
+    char name[32];
+
+    _traceThread()
+    : buffer(nullptr)
+    {
+        name[0] = '\0';
+    }
+
+    ~_traceThread()
+    {
+        if (buffer)
+            buffer->inUse.store(false, std::memory_order_release);
+    }
+} tTraceThread;
+
+std::atomic<bool> Tracer::s_enabled(false);
+
+static std::mutex s_traceMutex;
+// leaked, threads can still record while the static destructors run
+static std::vector<tTraceBuffer*>* s_traceBuffers = new std::vector<tTraceBuffer*>();
+static unsigned int s_traceThreadCount = 0;
+static std::atomic<uint64_t> s_traceClearTime(0);
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+
+static tTraceThread& getTraceThread()
+{
+    static thread_local tTraceThread traceThread;
+    return traceThread;
+}
+
+#else
+
+// thread_local needs iOS 9 with Apple clang, the threads are kept with a pthread key like JniHelper does
+static pthread_key_t s_traceThreadKey;
+static pthread_once_t s_traceThreadKeyOnce = PTHREAD_ONCE_INIT;
+
+static void deleteTraceThread(void* traceThread)
+{
+    delete static_cast<tTraceThread*>(traceThread);
+}
+
+static void createTraceThreadKey()
+{
+    pthread_key_create(&s_traceThreadKey, deleteTraceThread);
+}
+
+static tTraceThread& getTraceThread()
+{
+    pthread_once(&s_traceThreadKeyOnce, createTraceThreadKey);
+    auto traceThread = static_cast<tTraceThread*>(pthread_getspecific(s_traceThreadKey));
+    if (!traceThread)
+    {
+        traceThread = new tTraceThread();
+        pthread_setspecific(s_traceThreadKey, traceThread);
+    }
+    return *traceThread;
+}
+
+#endif
+
+static tTraceBuffer* getThreadBuffer()
+{
+    tTraceThread& traceThread = getTraceThread();
+    if (traceThread.buffer)
+        return traceThread.buffer;
+
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    tTraceBuffer* buffer = nullptr;
+    for (auto b : *s_traceBuffers)
+    {
+        if (!b->inUse.load(std::memory_order_acquire))
+        {
+            buffer = b;
+            break;
+        }
+    }
+    if (!buffer)
+    {
+        buffer = new tTraceBuffer;
+        s_traceBuffers->push_back(buffer);
+    }
+    buffer->written.store(0, std::memory_order_relaxed);
+    buffer->inUse.store(true, std::memory_order_relaxed);
+    buffer->threadId = ++s_traceThreadCount;
+    strncpy(buffer->threadName, traceThread.name, sizeof(buffer->threadName));
+
+    traceThread.buffer = buffer;
+    return buffer;
+}
+
+void Tracer::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracer::record(const char* name, uint64_t start, uint64_t end)
+{
+    auto buffer = getThreadBuffer();
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    auto& event = buffer->events[index % BUFFER_CAPACITY];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const char* name)
+{
+    tTraceThread& traceThread = getTraceThread();
+    strncpy(traceThread.name, name, sizeof(traceThread.name) - 1);
+    if (traceThread.buffer)
+    {
+        std::lock_guard<std::mutex> lock(s_traceMutex);
+        strncpy(traceThread.buffer->threadName, traceThread.name, sizeof(traceThread.buffer->threadName));
+    }
+}
+
+void Tracer::clear()
+{
+    s_traceClearTime.store(now(), std::memory_order_relaxed);
+}
+
+static void appendJsonString(std::string& json, const char* str)
+{
+    json += '"';
+    for (; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            json += '\\';
+        if ((unsigned char)*str >= 0x20)
+            json += *str;
+    }
+    json += '"';
+}
+
+std::string Tracer::exportChromeTrace()
+{
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    std::vector<tTraceEvent> events;
+    uint64_t clearTime = s_traceClearTime.load(std::memory_order_relaxed);
+    bool first = true;
+    char buf[128];
+
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    for (auto buffer : *s_traceBuffers)
+    {
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t begin = written > (uint64_t)BUFFER_CAPACITY ? written - BUFFER_CAPACITY : 0;
+        events.clear();
+        for (uint64_t i = begin; i < written; ++i)
+        {
+            events.push_back(buffer->events[i % BUFFER_CAPACITY]);
+        }
+
+        // the scopes overwritten by the thread while copying are dropped, including the one being written
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = buffer->written.load(std::memory_order_relaxed);
+        uint64_t valid = after + 1 > (uint64_t)BUFFER_CAPACITY ? after + 1 - BUFFER_CAPACITY : 0;
+        size_t skipped = valid > begin ? (size_t)std::min(valid - begin, (uint64_t)events.size()) : 0;
+
+        json += first ? "" : ",";
+        first = false;
+        snprintf(buf, sizeof(buf), "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer->threadId);
+        json += buf;
+        if (buffer->threadName[0])
+        {
+            appendJsonString(json, buffer->threadName);
+        }
+        else
+        {
+            snprintf(buf, sizeof(buf), "\"thread %u\"", buffer->threadId);
+            json += buf;
+        }
+        json += "}}";
+
+        for (size_t i = skipped; i < events.size(); ++i)
+        {
+            const auto& event = events[i];
+            if (event.start < clearTime)
+                continue;
+
+            json += ",\n{\"name\":";
+            appendJsonString(json, event.name);
+            snprintf(buf, sizeof(buf), ",\"cat\":\"cocos\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     buffer->threadId, event.start / 1000.0, (event.end - event.start) / 1000.0);
+            json += buf;
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+bool Tracer::writeChromeTrace(const std::string& path)
+{
+    return FileUtils::getInstance()->writeStringToFile(exportChromeTrace(), path);
+}
+
+NS_CC_END
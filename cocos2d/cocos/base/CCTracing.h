@@ -0,0 +1,124 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __CC_TRACING_H__
+#define __CC_TRACING_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include "base/ccConfig.h"
+#include "platform/CCPlatformMacros.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+/** @class Tracer
+ * @brief Tracing profiler recording the duration of named scopes, see CC_TRACE_SCOPE.
+ * Each thread records in its own ring buffer without locking, the last scopes of all the threads
+ * can be exported at any time as Chrome trace JSON, to open in chrome://tracing or Perfetto.
+ * Recording is off by default, a scope then costs a load and a branch.
+ * @since v3.17
+ */
+class CC_DLL Tracer
+{
+public:
+    /** Number of scopes kept per thread, the oldest are overwritten. */
+    static const int BUFFER_CAPACITY = 16384;
+
+    /** Starts or stops recording. */
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /** Monotonic time in nanoseconds. */
+    static uint64_t now();
+
+    /** Records a scope of the calling thread.
+     * @param name The scope name, it must outlive the tracer, e.g. a string literal.
+     * @param start The start time given by now().
+     * @param end The end time given by now().
+     */
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    /** Names the calling thread in the exported traces. */
+    static void setThreadName(const char* name);
+
+    /** Leaves the scopes recorded until now out of the next exports. */
+    static void clear();
+
+    /** Returns the recorded scopes of all the threads as Chrome trace JSON, it can be called from any thread. */
+    static std::string exportChromeTrace();
+
+    /** Writes exportChromeTrace to a file.
+     * @return True if the file was written.
+     */
+    static bool writeChromeTrace(const std::string& path);
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+/** @class TraceScope
+ * @brief Records the lifetime of the object with Tracer when it is enabled.
+ * @since v3.17
+ */
+class CC_DLL TraceScope
+{
+public:
+    explicit TraceScope(const char* name)
+    : _name(Tracer::isEnabled() ? name : nullptr)
+    , _start(_name ? Tracer::now() : 0)
+    {}
+
+    ~TraceScope()
+    {
+        if (_name)
+            Tracer::record(_name, _start, Tracer::now());
+    }
+
+private:
+    const char* _name;
+    uint64_t _start;
+};
+
+NS_CC_END
+
+#define CC_TRACE_CONCAT_IMPL(__a__, __b__) __a__##__b__
+#define CC_TRACE_CONCAT(__a__, __b__) CC_TRACE_CONCAT_IMPL(__a__, __b__)
+
+#if CC_ENABLE_TRACING
+/** Records the rest of the enclosing block under the given name, which must be a string literal. */
+#define CC_TRACE_SCOPE(__name__) NS_CC::TraceScope CC_TRACE_CONCAT(__ccTraceScope, __LINE__)(__name__)
+#else
+#define CC_TRACE_SCOPE(__name__) do {} while (0)
+#endif
+
+// end of base group
+/// @}
+
+#endif // __CC_TRACING_H__
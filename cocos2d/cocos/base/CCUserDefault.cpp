@@ -30,6 +30,12 @@ THE SOFTWARE.
 #include "base/base64.h"
 #include "base/ccUtils.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+
 #if (CC_TARGET_PLATFORM != CC_PLATFORM_IOS && CC_TARGET_PLATFORM != CC_PLATFORM_MAC && CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
 
 // root name of xml
@@ -42,116 +48,216 @@ using namespace std;
 NS_CC_BEGIN
 
 /**
- * define the functions here because we don't want to
- * export xmlNodePtr and other types in "CCUserDefault.h"
+ * The values are kept in memory, loaded once from the xml file. The setters change them there and wake a thread,
+ * which writes the file after USERDEFAULT_WRITE_DELAY so that the values set meanwhile are written at once.
+ * The file is written to a temporary file renamed over it, it is never left half written.
  */
 
-static tinyxml2::XMLElement* getXMLNodeForKey(const char* pKey, tinyxml2::XMLElement** rootNode, tinyxml2::XMLDocument **doc)
+// delay coalescing the writes, in milliseconds
+#define USERDEFAULT_WRITE_DELAY 200
+
+class UserDefaultStore
 {
-    tinyxml2::XMLElement* curNode = nullptr;
+public:
+    explicit UserDefaultStore(const std::string& filePath)
+    : _filePath(filePath)
+    , _dirty(false)
+    , _scheduled(false)
+    , _stop(false)
+    {
+        load();
+    }
 
-    // check the key value
-    if (! pKey)
+    ~UserDefaultStore()
     {
-        return nullptr;
+        if (_thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+            _condition.notify_one();
+            _thread.join();
+        }
+        save();
     }
 
-    do 
+    bool getValue(const char* key, std::string* value)
     {
-        tinyxml2::XMLDocument* xmlDoc = new (std::nothrow) tinyxml2::XMLDocument();
-        *doc = xmlDoc;
-        *rootNode = nullptr;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _values.find(key);
+        if (iter == _values.end())
+            return false;
 
-        std::string xmlBuffer = FileUtils::getInstance()->getStringFromFile(UserDefault::getInstance()->getXMLFilePath());
+        *value = iter->second;
+        return true;
+    }
 
-        if (!xmlBuffer.empty())
+    void setValue(const char* key, const char* value)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _values.find(key);
+        if (iter != _values.end())
         {
-            xmlDoc->Parse(xmlBuffer.c_str(), xmlBuffer.size());
-
-            // get root node
-            *rootNode = xmlDoc->RootElement();
+            if (iter->second == value)
+                return;
+            iter->second = value;
         }
-
-        if (nullptr == *rootNode)
+        else
         {
-            // try to insert xml declaration
-            if (!xmlDoc->FirstChild())
-            {
-                tinyxml2::XMLDeclaration *xmlDeclaration = xmlDoc->NewDeclaration(nullptr);
-                if (nullptr != xmlDeclaration)
-                {
-                    xmlDoc->LinkEndChild(xmlDeclaration);
-                }
-            }
+            _values.emplace(key, value);
+        }
+        scheduleSave();
+    }
 
-            // create root element
-            tinyxml2::XMLElement *rootEle = xmlDoc->NewElement(USERDEFAULT_ROOT_NAME);
-            if (nullptr == rootEle)
-                break;
+    void deleteValue(const char* key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_values.erase(key) != 0)
+            scheduleSave();
+    }
 
-            xmlDoc->LinkEndChild(rootEle);
-            *rootNode = rootEle;
+    // writes the values changed since the last write, if any
+    bool save()
+    {
+        // the writes are serialized so that an older snapshot never replaces a newer one
+        std::lock_guard<std::mutex> saveLock(_saveMutex);
+        std::map<std::string, std::string> values;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_dirty)
+                return true;
+            values = _values;
+            _dirty = false;
         }
 
-        // find the node
-        curNode = (*rootNode)->FirstChildElement();
-        while (nullptr != curNode)
+        bool ret = writeFile(values);
+        if (!ret)
         {
-            const char* nodeName = curNode->Value();
-            if (!strcmp(nodeName, pKey))
-            {
-                break;
-            }
+            // written again with the next change or flush
+            std::lock_guard<std::mutex> lock(_mutex);
+            _dirty = true;
+        }
+        return ret;
+    }
+
+private:
+    void load()
+    {
+        std::string xmlBuffer = FileUtils::getInstance()->getStringFromFile(_filePath);
+        if (xmlBuffer.empty())
+            return;
+
+        tinyxml2::XMLDocument xmlDoc;
+        xmlDoc.Parse(xmlBuffer.c_str(), xmlBuffer.size());
+        tinyxml2::XMLElement* rootNode = xmlDoc.RootElement();
+        if (!rootNode)
+            return;
 
-            curNode = curNode->NextSiblingElement();
+        for (auto node = rootNode->FirstChildElement(); node; node = node->NextSiblingElement())
+        {
+            // a key without text reads as unset, like a missing key
+            if (node->FirstChild())
+                _values[node->Value()] = node->FirstChild()->Value();
         }
-    } while (0);
+    }
 
-    return curNode;
-}
+    // called with _mutex locked
+    void scheduleSave()
+    {
+        _dirty = true;
+        if (_scheduled)
+            return;
 
-static void setValueForKey(const char* pKey, const char* pValue)
-{
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-    // check the params
-    if (! pKey || ! pValue)
+        _scheduled = true;
+        if (!_thread.joinable())
+            _thread = std::thread(&UserDefaultStore::run, this);
+        else
+            _condition.notify_one();
+    }
+
+    void run()
     {
-        return;
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            _condition.wait(lock, [this] { return _stop || _scheduled; });
+            if (_stop)
+                return;
+
+            // let the values set meanwhile join this write, the destructor writes them if it stops first
+            if (_condition.wait_for(lock, std::chrono::milliseconds(USERDEFAULT_WRITE_DELAY), [this] { return _stop; }))
+                return;
+
+            _scheduled = false;
+            lock.unlock();
+            save();
+            lock.lock();
+        }
     }
-    // find the node
-    node = getXMLNodeForKey(pKey, &rootNode, &doc);
-    // if node exist, change the content
-    if (node)
+
+    bool writeFile(const std::map<std::string, std::string>& values)
     {
-        if (node->FirstChild())
+        tinyxml2::XMLDocument xmlDoc;
+        xmlDoc.LinkEndChild(xmlDoc.NewDeclaration(nullptr));
+        tinyxml2::XMLElement* rootNode = xmlDoc.NewElement(USERDEFAULT_ROOT_NAME);
+        xmlDoc.LinkEndChild(rootNode);
+        for (const auto& value : values)
         {
-            node->FirstChild()->SetValue(pValue);
+            tinyxml2::XMLElement* node = xmlDoc.NewElement(value.first.c_str());
+            node->LinkEndChild(xmlDoc.NewText(value.second.c_str()));
+            rootNode->LinkEndChild(node);
         }
-        else
+
+        auto fileUtils = FileUtils::getInstance();
+        std::string tempPath = _filePath + ".tmp";
+        if (tinyxml2::XML_SUCCESS != xmlDoc.SaveFile(fileUtils->getSuitableFOpen(tempPath).c_str()))
         {
-            tinyxml2::XMLText* content = doc->NewText(pValue);
-            node->LinkEndChild(content);
+            CCLOGERROR("UserDefault: failed to write %s", tempPath.c_str());
+            return false;
         }
+        return fileUtils->renameFile(tempPath, _filePath);
     }
-    else
+
+    std::string _filePath;
+    std::map<std::string, std::string> _values;
+
+    std::mutex _mutex;
+    std::mutex _saveMutex;
+    std::condition_variable _condition;
+    std::thread _thread;
+    bool _dirty;        // the values differ from the file
+    bool _scheduled;    // the thread will write them
+    bool _stop;
+};
+
+static UserDefaultStore* s_store = nullptr;
+
+// loaded again after the instance is destroyed, e.g. if it is replaced by setDelegate
+static UserDefaultStore* getStore()
+{
+    if (!s_store)
+        s_store = new (std::nothrow) UserDefaultStore(UserDefault::getXMLFilePath());
+    return s_store;
+}
+
+static bool getValueForKey(const char* pKey, std::string* value)
+{
+    if (! pKey)
     {
-        if (rootNode)
-        {
-            tinyxml2::XMLElement* tmpNode = doc->NewElement(pKey);//new tinyxml2::XMLElement(pKey);
-            rootNode->LinkEndChild(tmpNode);
-            tinyxml2::XMLText* content = doc->NewText(pValue);//new tinyxml2::XMLText(pValue);
-            tmpNode->LinkEndChild(content);
-        }    
+        return false;
     }
+    return getStore()->getValue(pKey, value);
+}
 
-    // save file and free doc
-    if (doc)
+static void setValueForKey(const char* pKey, const char* pValue)
+{
+    // check the params
+    if (! pKey || ! pValue)
     {
-        doc->SaveFile(FileUtils::getInstance()->getSuitableFOpen(UserDefault::getInstance()->getXMLFilePath()).c_str());
-        delete doc;
+        return;
     }
+    getStore()->setValue(pKey, pValue);
 }
 
 /**
@@ -164,6 +270,8 @@ bool UserDefault::_isFilePathInitialized = false;
 
 UserDefault::~UserDefault()
 {
+    // writes the values not written yet
+    CC_SAFE_DELETE(s_store);
 }
 
 UserDefault::UserDefault()
@@ -177,26 +285,14 @@ bool UserDefault::getBoolForKey(const char* pKey)
 
 bool UserDefault::getBoolForKey(const char* pKey, bool defaultValue)
 {
-    const char* value = nullptr;
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-    node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-    // find the node
-    if (node && node->FirstChild())
-    {
-        value = (const char*)(node->FirstChild()->Value());
-    }
-
+    std::string value;
     bool ret = defaultValue;
 
-    if (value)
+    if (getValueForKey(pKey, &value))
     {
-        ret = (! strcmp(value, "true"));
+        ret = (value == "true");
     }
 
-    if (doc) delete doc;
-
     return ret;
 }
 
@@ -207,30 +303,14 @@ int UserDefault::getIntegerForKey(const char* pKey)
 
 int UserDefault::getIntegerForKey(const char* pKey, int defaultValue)
 {
-    const char* value = nullptr;
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-    node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-    // find the node
-    if (node && node->FirstChild())
-    {
-        value = (const char*)(node->FirstChild()->Value());
-    }
-
+    std::string value;
     int ret = defaultValue;
 
-    if (value)
-    {
-        ret = atoi(value);
-    }
-
-    if(doc)
+    if (getValueForKey(pKey, &value))
     {
-        delete doc;
+        ret = atoi(value.c_str());
     }
 
-
     return ret;
 }
 
@@ -253,26 +333,14 @@ double  UserDefault::getDoubleForKey(const char* pKey)
 
 double UserDefault::getDoubleForKey(const char* pKey, double defaultValue)
 {
-    const char* value = nullptr;
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-    node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-    // find the node
-    if (node && node->FirstChild())
-    {
-        value = (const char*)(node->FirstChild()->Value());
-    }
-
+    std::string value;
     double ret = defaultValue;
 
-    if (value)
+    if (getValueForKey(pKey, &value))
     {
-        ret = utils::atof(value);
+        ret = utils::atof(value.c_str());
     }
 
-    if (doc) delete doc;
-
     return ret;
 }
 
@@ -283,25 +351,9 @@ std::string UserDefault::getStringForKey(const char* pKey)
 
 string UserDefault::getStringForKey(const char* pKey, const std::string & defaultValue)
 {
-    const char* value = nullptr;
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-    node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-    // find the node
-    if (node && node->FirstChild())
-    {
-        value = (const char*)(node->FirstChild()->Value());
-    }
-
     string ret = defaultValue;
 
-    if (value)
-    {
-        ret = string(value);
-    }
-
-    if (doc) delete doc;
+    getValueForKey(pKey, &ret);
 
     return ret;
 }
@@ -313,31 +365,19 @@ Data UserDefault::getDataForKey(const char* pKey)
 
 Data UserDefault::getDataForKey(const char* pKey, const Data& defaultValue)
 {
-    const char* encodedData = nullptr;
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-    node =  getXMLNodeForKey(pKey, &rootNode, &doc);
-    // find the node
-    if (node && node->FirstChild())
-    {
-        encodedData = (const char*)(node->FirstChild()->Value());
-    }
-    
+    std::string encodedData;
     Data ret = defaultValue;
     
-    if (encodedData)
+    if (getValueForKey(pKey, &encodedData))
     {
         unsigned char * decodedData = nullptr;
-        int decodedDataLen = base64Decode((unsigned char*)encodedData, (unsigned int)strlen(encodedData), &decodedData);
+        int decodedDataLen = base64Decode((const unsigned char*)encodedData.c_str(), (unsigned int)encodedData.size(), &decodedData);
         
         if (decodedData) {
             ret.fastSet(decodedData, decodedDataLen);
         }
     }
     
-    if (doc) delete doc;
-    
     return ret;    
 }
 
@@ -517,14 +557,14 @@ const string& UserDefault::getXMLFilePath()
 
 void UserDefault::flush()
 {
+    if (s_store)
+    {
+        s_store->save();
+    }
 }
 
 void UserDefault::deleteValueForKey(const char* key)
 {
-    tinyxml2::XMLElement* rootNode;
-    tinyxml2::XMLDocument* doc;
-    tinyxml2::XMLElement* node;
-
     // check the params
     if (!key)
     {
@@ -532,25 +572,7 @@ void UserDefault::deleteValueForKey(const char* key)
         return;
     }
 
-    // find the node
-    node = getXMLNodeForKey(key, &rootNode, &doc);
-
-    // if node not exist, don't need to delete
-    if (!node)
-    {
-        CC_SAFE_DELETE(doc);
-        return;
-    }
-
-    // save file and free doc
-    if (doc)
-    {
-        doc->DeleteNode(node);
-        doc->SaveFile(FileUtils::getInstance()->getSuitableFOpen(UserDefault::getInstance()->getXMLFilePath()).c_str());
-        delete doc;
-    }
-
-    flush();
+    getStore()->deleteValue(key);
 }
 
 NS_CC_END
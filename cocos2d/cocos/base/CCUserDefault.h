@@ -202,6 +202,8 @@ public:
     virtual void setDataForKey(const char* key, const Data& value);
     /**
      * You should invoke this function to save values set by setXXXForKey().
+     * On desktop platforms the values are also saved in the background shortly after they are set,
+     * flush saves them at once, e.g. before the application is suspended.
      * @js NA
      */
     virtual void flush();
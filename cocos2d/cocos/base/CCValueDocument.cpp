@@ -0,0 +1,611 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/CCValueDocument.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#include "base/ccUtils.h"
+#include "platform/CCSAXParser.h"
+
+NS_CC_BEGIN
+
+// the strings of a document are allocated in blocks of this size, the larger ones alone
+static const size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+typedef struct _documentNode
+{
+    Value::Type type;
+    uint32_t count;                 // the string length or the number of values
+    union
+    {
+        int intValue;
+        double doubleValue;
+        bool boolValue;
+        const char* stringValue;
+        uint32_t first;             // the first entry of a map or item of a vector
+    };
+} tDocumentNode;
+
+typedef struct _documentEntry
+{
+    const char* key;                // interned
+    uint32_t keyLength;
+    uint32_t node;
+} tDocumentEntry;
+
+class ValueDocumentPrivate
+{
+public:
+    ValueDocumentPrivate()
+    : blockUsed(ARENA_BLOCK_SIZE)
+    , arenaSize(0)
+    {
+    }
+
+    ~ValueDocumentPrivate()
+    {
+        for (auto block : blocks)
+        {
+            free(block);
+        }
+    }
+
+    const char* addString(const char* string, size_t length)
+    {
+        char* bytes = nullptr;
+        if (length + 1 > ARENA_BLOCK_SIZE / 4)
+        {
+            bytes = (char*)malloc(length + 1);
+            // the current block stays the last one
+            blocks.insert(blocks.empty() ? blocks.end() : blocks.end() - 1, bytes);
+        }
+        else
+        {
+            if (blockUsed + length + 1 > ARENA_BLOCK_SIZE)
+            {
+                blocks.push_back((char*)malloc(ARENA_BLOCK_SIZE));
+                blockUsed = 0;
+            }
+            bytes = blocks.back() + blockUsed;
+            blockUsed += length + 1;
+        }
+        arenaSize += length + 1;
+        memcpy(bytes, string, length);
+        bytes[length] = '\0';
+        return bytes;
+    }
+
+    const tDocumentEntry* findEntry(const tDocumentNode& node, const std::string& key) const
+    {
+        if (node.type != Value::Type::MAP)
+            return nullptr;
+
+        auto begin = entries.data() + node.first;
+        auto end = begin + node.count;
+        auto it = std::lower_bound(begin, end, key, [](const tDocumentEntry& entry, const std::string& k) {
+            int cmp = memcmp(entry.key, k.data(), std::min((size_t)entry.keyLength, k.size()));
+            return cmp < 0 || (cmp == 0 && entry.keyLength < k.size());
+        });
+        if (it == end || it->keyLength != key.size() || memcmp(it->key, key.data(), key.size()) != 0)
+            return nullptr;
+        return it;
+    }
+
+    std::vector<tDocumentNode> nodes;
+    std::vector<tDocumentEntry> entries;
+    std::vector<uint32_t> items;
+    std::vector<char*> blocks;
+    size_t blockUsed;
+    size_t arenaSize;
+};
+
+// builds a document from the plist elements, like DictMaker in CCFileUtils.cpp builds a ValueMap
+class ValueDocumentBuilder : public SAXDelegator
+{
+public:
+    explicit ValueDocumentBuilder(ValueDocumentPrivate* document)
+    : _document(document)
+    , _key(nullptr)
+    , _keyLength(0)
+    , _textElement(TEXT_NONE)
+    , _ignoredDepth(0)
+    {
+    }
+
+    void startElement(void* /*ctx*/, const char* name, const char** /*atts*/) override
+    {
+        _textElement = TEXT_NONE;
+        if (strcmp(name, "dict") == 0)
+        {
+            openContainer(Value::Type::MAP);
+        }
+        else if (strcmp(name, "array") == 0)
+        {
+            openContainer(Value::Type::VECTOR);
+        }
+        else if (strcmp(name, "key") == 0)
+        {
+            _textElement = TEXT_KEY;
+        }
+        else if (strcmp(name, "string") == 0)
+        {
+            _textElement = TEXT_STRING;
+        }
+        else if (strcmp(name, "integer") == 0)
+        {
+            _textElement = TEXT_INTEGER;
+        }
+        else if (strcmp(name, "real") == 0)
+        {
+            _textElement = TEXT_REAL;
+        }
+        _text.clear();
+    }
+
+    void endElement(void* /*ctx*/, const char* name) override
+    {
+        if (strcmp(name, "dict") == 0 || strcmp(name, "array") == 0)
+        {
+            closeContainer();
+        }
+        else if (strcmp(name, "key") == 0)
+        {
+            internKey();
+        }
+        else if (strcmp(name, "true") == 0 || strcmp(name, "false") == 0)
+        {
+            tDocumentNode node;
+            node.type = Value::Type::BOOLEAN;
+            node.count = 0;
+            node.boolValue = name[0] == 't';
+            addValue(node);
+        }
+        else if (_textElement == TEXT_STRING)
+        {
+            tDocumentNode node;
+            node.type = Value::Type::STRING;
+            node.count = (uint32_t)_text.size();
+            node.stringValue = _document->addString(_text.data(), _text.size());
+            addValue(node);
+        }
+        else if (_textElement == TEXT_INTEGER)
+        {
+            tDocumentNode node;
+            node.type = Value::Type::INTEGER;
+            node.count = 0;
+            node.intValue = atoi(_text.c_str());
+            addValue(node);
+        }
+        else if (_textElement == TEXT_REAL)
+        {
+            tDocumentNode node;
+            node.type = Value::Type::DOUBLE;
+            node.count = 0;
+            node.doubleValue = std::atof(_text.c_str());
+            addValue(node);
+        }
+        _textElement = TEXT_NONE;
+    }
+
+    void textHandler(void* /*ctx*/, const char* s, size_t len) override
+    {
+        if (_textElement != TEXT_NONE)
+        {
+            _text.append(s, len);
+        }
+    }
+
+private:
+    enum TextElement
+    {
+        TEXT_NONE,
+        TEXT_KEY,
+        TEXT_STRING,
+        TEXT_INTEGER,
+        TEXT_REAL,
+    };
+
+    typedef struct _openContainer
+    {
+        uint32_t node;
+        size_t firstPending;        // in _pendingEntries or _pendingItems
+    } tOpenContainer;
+
+    void internKey()
+    {
+        auto iter = _keys.find(_text);
+        if (iter == _keys.end())
+        {
+            iter = _keys.emplace(_text, _document->addString(_text.data(), _text.size())).first;
+        }
+        _key = iter->second;
+        _keyLength = (uint32_t)_text.size();
+    }
+
+    uint32_t addValue(const tDocumentNode& node)
+    {
+        uint32_t index = (uint32_t)_document->nodes.size();
+        _document->nodes.push_back(node);
+        if (_containers.empty())
+            return index;
+
+        // the values of the open containers wait for their end, to be stored next to each other
+        if (_document->nodes[_containers.back().node].type == Value::Type::MAP)
+        {
+            if (_key)
+            {
+                tDocumentEntry entry = { _key, _keyLength, index };
+                _pendingEntries.push_back(entry);
+            }
+            _key = nullptr;
+        }
+        else
+        {
+            _pendingItems.push_back(index);
+        }
+        return index;
+    }
+
+    void openContainer(Value::Type type)
+    {
+        // the first container is the root, the next top level ones are ignored like by DictMaker
+        if (_containers.empty() && !_document->nodes.empty())
+        {
+            _ignoredDepth++;
+            return;
+        }
+
+        tDocumentNode node;
+        node.type = type;
+        node.count = 0;
+        node.first = 0;
+        tOpenContainer container;
+        container.node = addValue(node);
+        container.firstPending = type == Value::Type::MAP ? _pendingEntries.size() : _pendingItems.size();
+        _containers.push_back(container);
+    }
+
+    void closeContainer()
+    {
+        if (_ignoredDepth > 0)
+        {
+            _ignoredDepth--;
+            return;
+        }
+        if (_containers.empty())
+            return;
+
+        tOpenContainer container = _containers.back();
+        _containers.pop_back();
+        tDocumentNode& node = _document->nodes[container.node];
+        if (node.type == Value::Type::MAP)
+        {
+            auto begin = _pendingEntries.begin() + container.firstPending;
+            auto end = _pendingEntries.end();
+            std::stable_sort(begin, end, [](const tDocumentEntry& a, const tDocumentEntry& b) {
+                int cmp = memcmp(a.key, b.key, std::min(a.keyLength, b.keyLength));
+                return cmp < 0 || (cmp == 0 && a.keyLength < b.keyLength);
+            });
+
+            // a key set twice keeps its last value, like in a ValueMap
+            node.first = (uint32_t)_document->entries.size();
+            for (auto it = begin; it != end; ++it)
+            {
+                if (it + 1 != end && (it + 1)->key == it->key)
+                    continue;
+                _document->entries.push_back(*it);
+            }
+            node.count = (uint32_t)(_document->entries.size() - node.first);
+            _pendingEntries.erase(begin, end);
+        }
+        else
+        {
+            node.first = (uint32_t)_document->items.size();
+            node.count = (uint32_t)(_pendingItems.size() - container.firstPending);
+            _document->items.insert(_document->items.end(), _pendingItems.begin() + container.firstPending, _pendingItems.end());
+            _pendingItems.resize(container.firstPending);
+        }
+    }
+
+    ValueDocumentPrivate* _document;
+    std::unordered_map<std::string, const char*> _keys;
+    const char* _key;
+    uint32_t _keyLength;
+    TextElement _textElement;
+    std::string _text;
+    std::vector<tOpenContainer> _containers;
+    std::vector<tDocumentEntry> _pendingEntries;
+    std::vector<uint32_t> _pendingItems;
+    int _ignoredDepth;
+};
+
+// --------------------- ValueDocument::Node ---------------------
+
+ValueDocument::Node::Node()
+: _document(nullptr)
+, _index(0)
+{
+}
+
+ValueDocument::Node::Node(const ValueDocumentPrivate* document, uint32_t index)
+: _document(document)
+, _index(index)
+{
+}
+
+Value::Type ValueDocument::Node::getType() const
+{
+    return _document ? _document->nodes[_index].type : Value::Type::NONE;
+}
+
+int ValueDocument::Node::asInt() const
+{
+    if (!_document)
+        return 0;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    switch (node.type)
+    {
+        case Value::Type::INTEGER:
+            return node.intValue;
+        case Value::Type::STRING:
+            return atoi(node.stringValue);
+        default:
+            return toValue().asInt();
+    }
+}
+
+unsigned int ValueDocument::Node::asUnsignedInt() const
+{
+    return _document ? toValue().asUnsignedInt() : 0;
+}
+
+float ValueDocument::Node::asFloat() const
+{
+    if (!_document)
+        return 0.0f;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    switch (node.type)
+    {
+        case Value::Type::DOUBLE:
+            return static_cast<float>(node.doubleValue);
+        case Value::Type::STRING:
+            return utils::atof(node.stringValue);
+        default:
+            return toValue().asFloat();
+    }
+}
+
+double ValueDocument::Node::asDouble() const
+{
+    if (!_document)
+        return 0.0;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    switch (node.type)
+    {
+        case Value::Type::DOUBLE:
+            return node.doubleValue;
+        case Value::Type::STRING:
+            return static_cast<double>(utils::atof(node.stringValue));
+        default:
+            return toValue().asDouble();
+    }
+}
+
+bool ValueDocument::Node::asBool() const
+{
+    if (!_document)
+        return false;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    return node.type == Value::Type::BOOLEAN ? node.boolValue : toValue().asBool();
+}
+
+std::string ValueDocument::Node::asString() const
+{
+    if (!_document)
+        return "";
+
+    const tDocumentNode& node = _document->nodes[_index];
+    return node.type == Value::Type::STRING ? std::string(node.stringValue, node.count) : toValue().asString();
+}
+
+const char* ValueDocument::Node::getCString() const
+{
+    if (!_document || _document->nodes[_index].type != Value::Type::STRING)
+        return nullptr;
+    return _document->nodes[_index].stringValue;
+}
+
+size_t ValueDocument::Node::size() const
+{
+    if (!_document)
+        return 0;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    return node.type == Value::Type::MAP || node.type == Value::Type::VECTOR ? node.count : 0;
+}
+
+bool ValueDocument::Node::hasKey(const std::string& key) const
+{
+    return _document && _document->findEntry(_document->nodes[_index], key) != nullptr;
+}
+
+ValueDocument::Node ValueDocument::Node::operator[](const std::string& key) const
+{
+    const tDocumentEntry* entry = _document ? _document->findEntry(_document->nodes[_index], key) : nullptr;
+    return entry ? Node(_document, entry->node) : Node();
+}
+
+ValueDocument::Node ValueDocument::Node::operator[](size_t index) const
+{
+    if (index >= size())
+        return Node();
+
+    const tDocumentNode& node = _document->nodes[_index];
+    if (node.type == Value::Type::MAP)
+        return Node(_document, _document->entries[node.first + index].node);
+    return Node(_document, _document->items[node.first + index]);
+}
+
+std::string ValueDocument::Node::getKey(size_t index) const
+{
+    if (getType() != Value::Type::MAP || index >= size())
+        return "";
+
+    const tDocumentEntry& entry = _document->entries[_document->nodes[_index].first + index];
+    return std::string(entry.key, entry.keyLength);
+}
+
+Value ValueDocument::Node::toValue() const
+{
+    if (!_document)
+        return Value::Null;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    switch (node.type)
+    {
+        case Value::Type::INTEGER:
+            return Value(node.intValue);
+        case Value::Type::DOUBLE:
+            return Value(node.doubleValue);
+        case Value::Type::BOOLEAN:
+            return Value(node.boolValue);
+        case Value::Type::STRING:
+            return Value(std::string(node.stringValue, node.count));
+        case Value::Type::VECTOR:
+            return Value(toValueVector());
+        case Value::Type::MAP:
+            return Value(toValueMap());
+        default:
+            return Value::Null;
+    }
+}
+
+ValueMap ValueDocument::Node::toValueMap() const
+{
+    ValueMap map;
+    if (getType() != Value::Type::MAP)
+        return map;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    map.reserve(node.count);
+    for (uint32_t i = 0; i < node.count; ++i)
+    {
+        const tDocumentEntry& entry = _document->entries[node.first + i];
+        map.emplace(std::string(entry.key, entry.keyLength), Node(_document, entry.node).toValue());
+    }
+    return map;
+}
+
+ValueVector ValueDocument::Node::toValueVector() const
+{
+    ValueVector vector;
+    if (getType() != Value::Type::VECTOR)
+        return vector;
+
+    const tDocumentNode& node = _document->nodes[_index];
+    vector.reserve(node.count);
+    for (uint32_t i = 0; i < node.count; ++i)
+    {
+        vector.push_back(Node(_document, _document->items[node.first + i]).toValue());
+    }
+    return vector;
+}
+
+// --------------------- ValueDocument ---------------------
+
+ValueDocument::ValueDocument()
+: _data(new ValueDocumentPrivate)
+{
+}
+
+ValueDocument::~ValueDocument()
+{
+    CC_SAFE_DELETE(_data);
+}
+
+ValueDocument::ValueDocument(ValueDocument&& other)
+: _data(other._data)
+{
+    other._data = new ValueDocumentPrivate;
+}
+
+ValueDocument& ValueDocument::operator=(ValueDocument&& other)
+{
+    if (this != &other)
+    {
+        std::swap(_data, other._data);
+    }
+    return *this;
+}
+
+bool ValueDocument::initWithPlistData(const char* data, size_t size)
+{
+    CC_SAFE_DELETE(_data);
+    _data = new ValueDocumentPrivate;
+    if (!data || size == 0)
+        return false;
+
+    // parsed in place, on a terminated copy
+    std::string xml(data, size);
+    ValueDocumentBuilder builder(_data);
+    SAXParser parser;
+    parser.setDelegator(&builder);
+    if (!parser.parseIntrusive(&xml.front(), xml.size()) || _data->nodes.empty())
+    {
+        CC_SAFE_DELETE(_data);
+        _data = new ValueDocumentPrivate;
+        return false;
+    }
+
+    _data->nodes.shrink_to_fit();
+    _data->entries.shrink_to_fit();
+    _data->items.shrink_to_fit();
+    return true;
+}
+
+ValueDocument::Node ValueDocument::getRoot() const
+{
+    return _data->nodes.empty() ? Node() : Node(_data, 0);
+}
+
+size_t ValueDocument::getMemorySize() const
+{
+    return sizeof(ValueDocumentPrivate)
+        + _data->nodes.capacity() * sizeof(tDocumentNode)
+        + _data->entries.capacity() * sizeof(tDocumentEntry)
+        + _data->items.capacity() * sizeof(uint32_t)
+        + _data->blocks.capacity() * sizeof(char*)
+        + _data->arenaSize;
+}
+
+NS_CC_END
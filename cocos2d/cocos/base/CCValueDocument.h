@@ -0,0 +1,136 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_VALUE_DOCUMENT_H__
+#define __CC_VALUE_DOCUMENT_H__
+
+#include <stdint.h>
+#include <string>
+
+#include "platform/CCPlatformMacros.h"
+#include "base/CCValue.h"
+
+/**
+ * @addtogroup base
+ * @{
+ */
+
+NS_CC_BEGIN
+
+class ValueDocumentPrivate;
+
+/**
+ * @class ValueDocument
+ * @brief Immutable tree of values parsed from a plist, e.g. a large configuration read by FileUtils::getValueDocumentFromFile.
+ *
+ * Unlike a ValueMap, the strings of a document are allocated in one arena, its keys are interned and its maps are
+ * flat arrays sorted by key, so that parsing it makes a few allocations and destroying it frees a few blocks.
+ * Its nodes are read like Value, ValueMap and ValueVector, and Node::toValue converts them for the existing consumers.
+ *
+ * @since v3.17
+ */
+class CC_DLL ValueDocument
+{
+public:
+    /** Read-only handle on a value of a document, valid as long as the document. */
+    class CC_DLL Node
+    {
+    public:
+        /** A null node, of type Value::Type::NONE. */
+        Node();
+
+        /** Value::Type::INTEGER, DOUBLE, BOOLEAN, STRING, VECTOR or MAP, NONE for a null node. */
+        Value::Type getType() const;
+        bool isNull() const { return getType() == Value::Type::NONE; }
+
+        /** Converts a scalar like the Value methods of the same name. */
+        int asInt() const;
+        unsigned int asUnsignedInt() const;
+        float asFloat() const;
+        double asDouble() const;
+        bool asBool() const;
+        std::string asString() const;
+
+        /** The string in place, nullptr if the node isn't a string. */
+        const char* getCString() const;
+
+        /** Number of values of a vector or a map, 0 for a scalar. */
+        size_t size() const;
+
+        /** Check whether a map has a key. */
+        bool hasKey(const std::string& key) const;
+
+        /** The value of a key in a map, a null node if the node isn't a map or hasn't the key. */
+        Node operator[](const std::string& key) const;
+
+        /** A value of a vector, or of a map in the order of its keys, a null node if the index is out of range. */
+        Node operator[](size_t index) const;
+
+        /** A key of a map in the order of the keys, empty if the node isn't a map or the index is out of range. */
+        std::string getKey(size_t index) const;
+
+        /** Copies the node and its children in a Value. */
+        Value toValue() const;
+        ValueMap toValueMap() const;
+        ValueVector toValueVector() const;
+
+    private:
+        friend class ValueDocument;
+        Node(const ValueDocumentPrivate* document, uint32_t index);
+
+        const ValueDocumentPrivate* _document;
+        uint32_t _index;
+    };
+
+    ValueDocument();
+    ~ValueDocument();
+    ValueDocument(ValueDocument&& other);
+    ValueDocument& operator=(ValueDocument&& other);
+
+    /**
+     * Parses a plist, the root of the document is its top dict or array.
+     *
+     * @return False if the data isn't a plist, the document is empty then.
+     */
+    bool initWithPlistData(const char* data, size_t size);
+
+    /** The root value, a null node if the document is empty. */
+    Node getRoot() const;
+
+    /** The memory used by the document, in bytes. */
+    size_t getMemorySize() const;
+
+private:
+    ValueDocument(const ValueDocument&) = delete;
+    ValueDocument& operator=(const ValueDocument&) = delete;
+
+    ValueDocumentPrivate* _data;
+};
+
+NS_CC_END
+
+// end of base group
+/// @}
+
+#endif // __CC_VALUE_DOCUMENT_H__
@@ -39,8 +39,19 @@
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
+#include "base/CCAssetPack.h"
 #include "platform/CCFileUtils.h"
 #include <map>
+#include <algorithm>
+#include <vector>
+#include <string.h>
+#include <limits.h>
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 // FIXME: Other platforms should use upstream minizip like mingw-w64  
 #ifdef MINIZIP_FROM_SYSTEM
@@ -496,27 +507,423 @@ void ZipUtils::setPvrEncryptionKey(unsigned int keyPart1, unsigned int keyPart2,
 }
 
 // --------------------- ZipFile ---------------------
-// from unzip.cpp
-#define UNZ_MAXFILENAMEINZIP 256
 
 static const std::string emptyFilename("");
 
-struct ZipEntryInfo
+static const uint32_t ZIP_LOCAL_HEADER_SIGNATURE = 0x04034b50;
+static const uint32_t ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+static const uint32_t ZIP_END_SIGNATURE = 0x06054b50;
+static const uint32_t ZIP64_END_SIGNATURE = 0x06064b50;
+static const uint32_t ZIP64_LOCATOR_SIGNATURE = 0x07064b50;
+static const size_t ZIP_LOCAL_HEADER_SIZE = 30;
+static const size_t ZIP_CENTRAL_HEADER_SIZE = 46;
+static const size_t ZIP_END_SIZE = 22;
+static const size_t ZIP64_END_SIZE = 56;
+static const size_t ZIP64_LOCATOR_SIZE = 20;
+static const size_t ZIP_MAX_COMMENT_SIZE = 0xffff;
+
+static inline uint16_t readUInt16(const unsigned char* p)
 {
-    unz_file_pos pos;
-    uLong uncompressed_size;
-};
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t readUInt32(const unsigned char* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
 
+static inline uint64_t readUInt64(const unsigned char* p)
+{
+    return (uint64_t)readUInt32(p) | ((uint64_t)readUInt32(p + 4) << 32);
+}
+
+// an entry of the central directory
+typedef struct _zipEntry
+{
+    uint64_t localHeaderOffset;
+    uint64_t compressedSize;
+    uint64_t uncompressedSize;
+    uint32_t nameOffset;
+    uint16_t nameLength;
+    uint16_t method;
+    bool encrypted;
+} tZipEntry;
+
+/**
+ * The central directory read once, the entries are then read with no shared state, so that several
+ * threads can read and inflate them at once. The archive is mapped, or read with pread where it can't be.
+ */
 class ZipFilePrivate
 {
 public:
-    unzFile zipFile;
-    
-    // std::unordered_map is faster if available on the platform
-    typedef std::unordered_map<std::string, struct ZipEntryInfo> FileListContainer;
-    FileListContainer fileList;
+    ZipFilePrivate();
+    ~ZipFilePrivate();
+
+    bool open(const std::string& fullPath);
+    bool openBuffer(const void* buffer, size_t size);
+    bool isOpen() const { return _bytes != nullptr || _fd >= 0; }
+
+    void setFilter(const std::string& filter);
+    const tZipEntry* findEntry(const std::string& fileName) const;
+    std::string getName(const tZipEntry& entry) const { return _names.substr(entry.nameOffset, entry.nameLength); }
+
+    // the stored entry bytes in place, nullptr if the archive isn't in memory or the entry is compressed
+    const unsigned char* getStoredData(const tZipEntry& entry) const;
+    bool readEntry(const tZipEntry& entry, unsigned char* out) const;
+
+    std::vector<tZipEntry> entries;     // in the central directory order
+    size_t nextFilename;                // getNextFilename cursor
+
+private:
+    bool readAt(uint64_t offset, void* out, size_t length) const;
+    bool getDataOffset(const tZipEntry& entry, uint64_t* offset) const;
+    bool readCentralDirectory();
+    void close();
+
+    const unsigned char* _bytes;
+    uint64_t _size;
+    bool _mapped;
+    Data _data;                         // the archive read in memory when it can't be mapped nor read with pread
+    int _fd;
+    std::string _names;
+    std::vector<uint32_t> _sortedEntries;   // the entries of the filter, sorted by name
 };
 
+ZipFilePrivate::ZipFilePrivate()
+: nextFilename(0)
+, _bytes(nullptr)
+, _size(0)
+, _mapped(false)
+, _fd(-1)
+{
+}
+
+ZipFilePrivate::~ZipFilePrivate()
+{
+    close();
+}
+
+void ZipFilePrivate::close()
+{
+    if (_mapped)
+    {
+        AssetPack::unmapFile((unsigned char*)_bytes, (size_t)_size);
+    }
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+    }
+#endif
+    _data.clear();
+    _bytes = nullptr;
+    _size = 0;
+    _mapped = false;
+    _fd = -1;
+    entries.clear();
+    _names.clear();
+    _sortedEntries.clear();
+    nextFilename = 0;
+}
+
+bool ZipFilePrivate::open(const std::string& fullPath)
+{
+    close();
+
+    size_t size = 0;
+    _bytes = AssetPack::mapFile(fullPath, &size);
+    _mapped = _bytes != nullptr;
+    _size = size;
+    if (!_mapped)
+    {
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+        // e.g. out of address space for a large archive on a 32 bits device
+        _fd = ::open(fullPath.c_str(), O_RDONLY);
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+        struct stat64 statBuf;
+        if (_fd >= 0 && fstat64(_fd, &statBuf) == 0)
+            _size = statBuf.st_size;
+#else
+        struct stat statBuf;
+        if (_fd >= 0 && fstat(_fd, &statBuf) == 0)
+            _size = statBuf.st_size;
+#endif
+#else
+        if (FileUtils::getInstance()->getContents(fullPath, &_data) == FileUtils::Status::OK)
+        {
+            _bytes = _data.getBytes();
+            _size = _data.getSize();
+        }
+#endif
+    }
+
+    if (isOpen() && readCentralDirectory())
+        return true;
+
+    close();
+    return false;
+}
+
+bool ZipFilePrivate::openBuffer(const void* buffer, size_t size)
+{
+    close();
+
+    // used in place like unzOpenBuffer, the caller keeps it
+    _bytes = (const unsigned char*)buffer;
+    _size = size;
+    if (readCentralDirectory())
+        return true;
+
+    close();
+    return false;
+}
+
+bool ZipFilePrivate::readAt(uint64_t offset, void* out, size_t length) const
+{
+    if (offset > _size || length > _size - offset)
+        return false;
+
+    if (_bytes)
+    {
+        memcpy(out, _bytes + offset, length);
+        return true;
+    }
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+    unsigned char* bytes = (unsigned char*)out;
+    while (length > 0)
+    {
+#if CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID
+        // off_t is 32 bits on the 32 bits devices, and the archives read here are the ones too large to map
+        ssize_t count = pread64(_fd, bytes, length, (off64_t)offset);
+#else
+        ssize_t count = pread(_fd, bytes, length, (off_t)offset);
+#endif
+        if (count <= 0)
+            return false;
+        bytes += count;
+        offset += count;
+        length -= count;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ZipFilePrivate::readCentralDirectory()
+{
+    // the end of central directory record is followed by the archive comment
+    size_t tailSize = (size_t)std::min<uint64_t>(_size, ZIP_END_SIZE + ZIP_MAX_COMMENT_SIZE);
+    std::vector<unsigned char> tail(tailSize);
+    if (tailSize < ZIP_END_SIZE || !readAt(_size - tailSize, tail.data(), tailSize))
+        return false;
+
+    size_t endPosition = tailSize - ZIP_END_SIZE;
+    while (readUInt32(&tail[endPosition]) != ZIP_END_SIGNATURE)
+    {
+        if (endPosition == 0)
+            return false;
+        --endPosition;
+    }
+    const unsigned char* end = &tail[endPosition];
+    uint64_t endOffset = _size - tailSize + endPosition;
+
+    uint64_t entryCount = readUInt16(end + 10);
+    uint64_t directorySize = readUInt32(end + 12);
+    uint64_t directoryOffset = readUInt32(end + 16);
+    uint64_t directoryEnd = endOffset;
+    if (entryCount == 0xffff || directorySize == 0xffffffff || directoryOffset == 0xffffffff)
+    {
+        unsigned char locator[ZIP64_LOCATOR_SIZE];
+        unsigned char end64[ZIP64_END_SIZE];
+        if (endOffset < ZIP64_LOCATOR_SIZE
+            || !readAt(endOffset - ZIP64_LOCATOR_SIZE, locator, sizeof(locator))
+            || readUInt32(locator) != ZIP64_LOCATOR_SIGNATURE)
+            return false;
+
+        directoryEnd = readUInt64(locator + 8);
+        if (!readAt(directoryEnd, end64, sizeof(end64)) || readUInt32(end64) != ZIP64_END_SIGNATURE)
+            return false;
+        entryCount = readUInt64(end64 + 32);
+        directorySize = readUInt64(end64 + 40);
+        directoryOffset = readUInt64(end64 + 48);
+    }
+
+    // the offsets are relative to the archive start, data may precede it, e.g. in a self-extracting archive
+    if (directoryEnd < directorySize || directoryEnd - directorySize < directoryOffset)
+        return false;
+    uint64_t archiveStart = directoryEnd - directorySize - directoryOffset;
+    if (directorySize > _size || entryCount > directorySize / ZIP_CENTRAL_HEADER_SIZE)
+        return false;
+
+    std::vector<unsigned char> directory((size_t)directorySize);
+    if (!readAt(archiveStart + directoryOffset, directory.data(), directory.size()))
+        return false;
+
+    entries.reserve((size_t)entryCount);
+    const unsigned char* p = directory.data();
+    const unsigned char* directoryLast = p + directory.size();
+    for (uint64_t i = 0; i < entryCount; ++i)
+    {
+        if (directoryLast - p < (ptrdiff_t)ZIP_CENTRAL_HEADER_SIZE || readUInt32(p) != ZIP_CENTRAL_HEADER_SIGNATURE)
+            return false;
+
+        uint16_t nameLength = readUInt16(p + 28);
+        uint16_t extraLength = readUInt16(p + 30);
+        uint16_t commentLength = readUInt16(p + 32);
+        const unsigned char* name = p + ZIP_CENTRAL_HEADER_SIZE;
+        const unsigned char* extra = name + nameLength;
+        const unsigned char* next = extra + extraLength + commentLength;
+        if (next > directoryLast)
+            return false;
+
+        tZipEntry entry;
+        entry.encrypted = (readUInt16(p + 8) & 1) != 0;
+        entry.method = readUInt16(p + 10);
+        entry.compressedSize = readUInt32(p + 20);
+        entry.uncompressedSize = readUInt32(p + 24);
+        entry.localHeaderOffset = readUInt32(p + 42);
+        entry.nameOffset = (uint32_t)_names.size();
+        entry.nameLength = nameLength;
+
+        // the zip64 extended information holds the sizes and offset which don't fit, in this order
+        for (const unsigned char* field = extra; field + 4 <= extra + extraLength; )
+        {
+            uint16_t fieldId = readUInt16(field);
+            uint16_t fieldSize = readUInt16(field + 2);
+            const unsigned char* value = field + 4;
+            const unsigned char* fieldEnd = value + fieldSize;
+            if (fieldEnd > extra + extraLength)
+                break;
+            if (fieldId == 0x0001)
+            {
+                uint64_t* values[] = { &entry.uncompressedSize, &entry.compressedSize, &entry.localHeaderOffset };
+                for (auto v : values)
+                {
+                    if (*v == 0xffffffff && value + 8 <= fieldEnd)
+                    {
+                        *v = readUInt64(value);
+                        value += 8;
+                    }
+                }
+            }
+            field = fieldEnd;
+        }
+
+        entry.localHeaderOffset += archiveStart;
+        _names.append((const char*)name, nameLength);
+        entries.push_back(entry);
+        p = next;
+    }
+
+    setFilter(emptyFilename);
+    return true;
+}
+
+void ZipFilePrivate::setFilter(const std::string& filter)
+{
+    _sortedEntries.clear();
+    _sortedEntries.reserve(entries.size());
+    for (uint32_t i = 0; i < (uint32_t)entries.size(); ++i)
+    {
+        const auto& entry = entries[i];
+        if (entry.nameLength >= filter.size() && memcmp(_names.data() + entry.nameOffset, filter.data(), filter.size()) == 0)
+            _sortedEntries.push_back(i);
+    }
+
+    const char* names = _names.data();
+    const tZipEntry* entryData = entries.data();
+    std::stable_sort(_sortedEntries.begin(), _sortedEntries.end(), [names, entryData](uint32_t a, uint32_t b) {
+        const tZipEntry& entryA = entryData[a];
+        const tZipEntry& entryB = entryData[b];
+        int cmp = memcmp(names + entryA.nameOffset, names + entryB.nameOffset, std::min(entryA.nameLength, entryB.nameLength));
+        return cmp < 0 || (cmp == 0 && entryA.nameLength < entryB.nameLength);
+    });
+}
+
+const tZipEntry* ZipFilePrivate::findEntry(const std::string& fileName) const
+{
+    const char* names = _names.data();
+    const tZipEntry* entryData = entries.data();
+    auto it = std::upper_bound(_sortedEntries.begin(), _sortedEntries.end(), fileName, [names, entryData](const std::string& key, uint32_t index) {
+        const tZipEntry& entry = entryData[index];
+        int cmp = memcmp(key.data(), names + entry.nameOffset, std::min((size_t)entry.nameLength, key.size()));
+        return cmp < 0 || (cmp == 0 && key.size() < entry.nameLength);
+    });
+
+    if (it == _sortedEntries.begin())
+        return nullptr;
+
+    // a name may be in the archive twice, e.g. when appended to, the last one is used
+    const tZipEntry& entry = entries[*(it - 1)];
+    if (entry.nameLength != fileName.size() || memcmp(names + entry.nameOffset, fileName.data(), fileName.size()) != 0)
+        return nullptr;
+    return &entry;
+}
+
+bool ZipFilePrivate::getDataOffset(const tZipEntry& entry, uint64_t* offset) const
+{
+    // the local header may have another extra field than the central directory
+    unsigned char header[ZIP_LOCAL_HEADER_SIZE];
+    if (!readAt(entry.localHeaderOffset, header, sizeof(header)) || readUInt32(header) != ZIP_LOCAL_HEADER_SIGNATURE)
+        return false;
+
+    *offset = entry.localHeaderOffset + ZIP_LOCAL_HEADER_SIZE + readUInt16(header + 26) + readUInt16(header + 28);
+    return *offset <= _size && entry.compressedSize <= _size - *offset;
+}
+
+const unsigned char* ZipFilePrivate::getStoredData(const tZipEntry& entry) const
+{
+    uint64_t offset = 0;
+    if (!_bytes || entry.method != 0 || entry.encrypted || entry.compressedSize != entry.uncompressedSize
+        || !getDataOffset(entry, &offset))
+        return nullptr;
+    return _bytes + offset;
+}
+
+bool ZipFilePrivate::readEntry(const tZipEntry& entry, unsigned char* out) const
+{
+    uint64_t offset = 0;
+    if (entry.encrypted || !getDataOffset(entry, &offset))
+        return false;
+
+    if (entry.method == 0)
+    {
+        return entry.compressedSize == entry.uncompressedSize && readAt(offset, out, (size_t)entry.uncompressedSize);
+    }
+    if (entry.method != Z_DEFLATED || entry.uncompressedSize > UINT_MAX || entry.compressedSize > UINT_MAX)
+    {
+        return false;
+    }
+
+    std::vector<unsigned char> compressed;
+    const unsigned char* in = _bytes ? _bytes + offset : nullptr;
+    if (!in)
+    {
+        compressed.resize((size_t)entry.compressedSize);
+        if (!readAt(offset, compressed.data(), compressed.size()))
+            return false;
+        in = compressed.data();
+    }
+
+    // a stream of its own per read, the entries can be inflated on several threads
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+        return false;
+
+    stream.next_in = (Bytef*)in;
+    stream.avail_in = (uInt)entry.compressedSize;
+    stream.next_out = out;
+    stream.avail_out = (uInt)entry.uncompressedSize;
+    int err = inflate(&stream, Z_FINISH);
+    bool ok = (err == Z_STREAM_END || (err == Z_BUF_ERROR && entry.uncompressedSize == 0))
+        && stream.total_out == entry.uncompressedSize;
+    inflateEnd(&stream);
+    return ok;
+}
+
 ZipFile *ZipFile::createWithBuffer(const void* buffer, uLong size)
 {
     ZipFile *zip = new (std::nothrow) ZipFile();
@@ -531,23 +938,19 @@ ZipFile *ZipFile::createWithBuffer(const void* buffer, uLong size)
 ZipFile::ZipFile()
 : _data(new ZipFilePrivate)
 {
-    _data->zipFile = nullptr;
 }
 
 ZipFile::ZipFile(const std::string &zipFile, const std::string &filter)
 : _data(new ZipFilePrivate)
 {
-    _data->zipFile = unzOpen(FileUtils::getInstance()->getSuitableFOpen(zipFile).c_str());
-    setFilter(filter);
+    if (_data->open(zipFile))
+    {
+        setFilter(filter);
+    }
 }
 
 ZipFile::~ZipFile()
 {
-    if (_data && _data->zipFile)
-    {
-        unzClose(_data->zipFile);
-    }
-
     CC_SAFE_DELETE(_data);
 }
 
@@ -557,41 +960,10 @@ bool ZipFile::setFilter(const std::string &filter)
     do
     {
         CC_BREAK_IF(!_data);
-        CC_BREAK_IF(!_data->zipFile);
-        
-        // clear existing file list
-        _data->fileList.clear();
-        
-        // UNZ_MAXFILENAMEINZIP + 1 - it is done so in unzLocateFile
-        char szCurrentFileName[UNZ_MAXFILENAMEINZIP + 1];
-        unz_file_info64 fileInfo;
-        
-        // go through all files and store position information about the required files
-        int err = unzGoToFirstFile64(_data->zipFile, &fileInfo,
-                                     szCurrentFileName, sizeof(szCurrentFileName) - 1);
-        while (err == UNZ_OK)
-        {
-            unz_file_pos posInfo;
-            int posErr = unzGetFilePos(_data->zipFile, &posInfo);
-            if (posErr == UNZ_OK)
-            {
-                std::string currentFileName = szCurrentFileName;
-                // cache info about filtered files only (like 'assets/')
-                if (filter.empty()
-                    || currentFileName.substr(0, filter.length()) == filter)
-                {
-                    ZipEntryInfo entry;
-                    entry.pos = posInfo;
-                    entry.uncompressed_size = (uLong)fileInfo.uncompressed_size;
-                    _data->fileList[currentFileName] = entry;
-                }
-            }
-            // next file - also get the information about it
-            err = unzGoToNextFile64(_data->zipFile, &fileInfo,
-                                    szCurrentFileName, sizeof(szCurrentFileName) - 1);
-        }
+        CC_BREAK_IF(!_data->isOpen());
+
+        _data->setFilter(filter);
         ret = true;
-        
     } while(false);
     
     return ret;
@@ -604,7 +976,7 @@ bool ZipFile::fileExists(const std::string &fileName) const
     {
         CC_BREAK_IF(!_data);
         
-        ret = _data->fileList.find(fileName) != _data->fileList.end();
+        ret = _data->findEntry(fileName) != nullptr;
     } while(false);
     
     return ret;
@@ -618,29 +990,24 @@ unsigned char *ZipFile::getFileData(const std::string &fileName, ssize_t *size)
 
     do
     {
-        CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
         
-        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
-        CC_BREAK_IF(it ==  _data->fileList.end());
+        const tZipEntry* entry = _data->findEntry(fileName);
+        CC_BREAK_IF(!entry);
         
-        ZipEntryInfo fileInfo = it->second;
-        
-        int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
-        CC_BREAK_IF(UNZ_OK != nRet);
-        
-        nRet = unzOpenCurrentFile(_data->zipFile);
-        CC_BREAK_IF(UNZ_OK != nRet);
-        
-        buffer = (unsigned char*)malloc(fileInfo.uncompressed_size);
-        int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, buffer, static_cast<unsigned int>(fileInfo.uncompressed_size));
-        CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
+        buffer = (unsigned char*)malloc((size_t)entry->uncompressedSize);
+        CC_BREAK_IF(!buffer);
+        if (!_data->readEntry(*entry, buffer))
+        {
+            free(buffer);
+            buffer = nullptr;
+            break;
+        }
         
         if (size)
         {
-            *size = fileInfo.uncompressed_size;
+            *size = (ssize_t)entry->uncompressedSize;
         }
-        unzCloseCurrentFile(_data->zipFile);
     } while (0);
     
     return buffer;
@@ -651,69 +1018,51 @@ bool ZipFile::getFileData(const std::string &fileName, ResizableBuffer* buffer)
     bool res = false;
     do
     {
-        CC_BREAK_IF(!_data->zipFile);
         CC_BREAK_IF(fileName.empty());
         
-        ZipFilePrivate::FileListContainer::const_iterator it = _data->fileList.find(fileName);
-        CC_BREAK_IF(it ==  _data->fileList.end());
-        
-        ZipEntryInfo fileInfo = it->second;
-        
-        int nRet = unzGoToFilePos(_data->zipFile, &fileInfo.pos);
-        CC_BREAK_IF(UNZ_OK != nRet);
+        const tZipEntry* entry = _data->findEntry(fileName);
+        CC_BREAK_IF(!entry);
         
-        nRet = unzOpenCurrentFile(_data->zipFile);
-        CC_BREAK_IF(UNZ_OK != nRet);
-        
-        buffer->resize(fileInfo.uncompressed_size);
-        int CC_UNUSED nSize = unzReadCurrentFile(_data->zipFile, buffer->buffer(), static_cast<unsigned int>(fileInfo.uncompressed_size));
-        CCASSERT(nSize == 0 || nSize == (int)fileInfo.uncompressed_size, "the file size is wrong");
-        unzCloseCurrentFile(_data->zipFile);
+        buffer->resize((size_t)entry->uncompressedSize);
+        if (!_data->readEntry(*entry, (unsigned char*)buffer->buffer()))
+        {
+            buffer->resize(0);
+            break;
+        }
         res = true;
     } while (0);
     
     return res;
 }
 
-std::string ZipFile::getFirstFilename()
+unsigned char *ZipFile::getMappedData(const std::string &fileName, ssize_t *size) const
 {
-    if (unzGoToFirstFile(_data->zipFile) != UNZ_OK) return emptyFilename;
-    std::string path;
-    unz_file_info info;
-    getCurrentFileInfo(&path, &info);
-    return path;
+    const tZipEntry* entry = _data->findEntry(fileName);
+    const unsigned char* bytes = entry ? _data->getStoredData(*entry) : nullptr;
+    if (bytes && size)
+    {
+        *size = (ssize_t)entry->uncompressedSize;
+    }
+    return (unsigned char*)bytes;
 }
 
-std::string ZipFile::getNextFilename()
+std::string ZipFile::getFirstFilename()
 {
-    if (unzGoToNextFile(_data->zipFile) != UNZ_OK) return emptyFilename;
-    std::string path;
-    unz_file_info info;
-    getCurrentFileInfo(&path, &info);
-    return path;
+    _data->nextFilename = 0;
+    return getNextFilename();
 }
 
-int ZipFile::getCurrentFileInfo(std::string *filename, unz_file_info *info)
+std::string ZipFile::getNextFilename()
 {
-    char path[FILENAME_MAX + 1];
-    int ret = unzGetCurrentFileInfo(_data->zipFile, info, path, sizeof(path), nullptr, 0, nullptr, 0);
-    if (ret != UNZ_OK) {
-        *filename = emptyFilename;
-    } else {
-        filename->assign(path);
-    }
-    return ret;
+    if (_data->nextFilename >= _data->entries.size()) return emptyFilename;
+    return _data->getName(_data->entries[_data->nextFilename++]);
 }
 
 bool ZipFile::initWithBuffer(const void *buffer, uLong size)
 {
     if (!buffer || size == 0) return false;
     
-    _data->zipFile = unzOpenBuffer(buffer, size);
-    if (!_data->zipFile) return false;
-    
-    setFilter(emptyFilename);
-    return true;
+    return _data->openBuffer(buffer, size);
 }
 
 NS_CC_END
@@ -221,7 +221,6 @@ typedef struct unz_file_info_s unz_file_info;
 
     // forward declaration
     class ZipFilePrivate;
-    struct unz_file_info_s;
 
     /**
     * Zip file - reader helper class.
@@ -229,6 +228,9 @@ typedef struct unz_file_info_s unz_file_info;
     * It will cache the file list of a particular zip file with positions inside an archive,
     * so it would be much faster to read some particular files or to check their existence.
     *
+    * The archive is mapped in memory, or read with pread where it can't be, and the reads share no state:
+    * the files can be read and inflated on several threads at once, while the filter isn't changed.
+    *
     * @since v2.0.5
     */
     class CC_DLL ZipFile
@@ -286,6 +288,16 @@ typedef struct unz_file_info_s unz_file_info;
         */
         bool getFileData(const std::string &fileName, ResizableBuffer* buffer);
 
+        /**
+        * Get a file stored without compression in place, valid as long as the zip file is open.
+        * @param fileName File name
+        * @param[out] size If the file is found, it will be the data size.
+        * @return The file bytes, nullptr if the file isn't found, is compressed or the zip file isn't in memory.
+        *
+        * @since v3.17
+        */
+        unsigned char *getMappedData(const std::string &fileName, ssize_t *size) const;
+
         std::string getFirstFilename();
         std::string getNextFilename();
         
@@ -296,7 +308,6 @@ typedef struct unz_file_info_s unz_file_info;
         ZipFile();
         
         bool initWithBuffer(const void *buffer, unsigned long size);
-        int getCurrentFileInfo(std::string *filename, unz_file_info *info);
         
         /** Internal data like zip file pointer / file list array and so on */
         ZipFilePrivate *_data;
@@ -28,6 +28,8 @@
 #define CC_ALLOCATOR_MACROS_H
 /// @cond DO_NOT_SHOW
 
+#include <new>
+
 #include "base/ccConfig.h"
 #include "platform/CCPlatformMacros.h"
 
@@ -88,6 +90,37 @@
             A.deallocate((T*)object, size); \
         }
 
+    // @brief declares the new/delete operators of a class, allocating its instances from a pool.
+    // The pool is defined in the class source file with CC_DEFINE_ALLOCATOR_POOL,
+    // the instances of derived classes, which have another size, fall back to the global allocator.
+    #define CC_DECLARE_ALLOCATOR_POOL(T) \
+        static void* allocateFromPool(size_t size); \
+        static void deallocateToPool(void* object, size_t size); \
+        void* operator new (size_t size) \
+        { \
+            return allocateFromPool(size); \
+        } \
+        void* operator new (size_t size, const std::nothrow_t&) \
+        { \
+            return allocateFromPool(size); \
+        } \
+        void operator delete (void* object, size_t size) \
+        { \
+            deallocateToPool(object, size); \
+        }
+
+    // @brief defines the pool declared by CC_DECLARE_ALLOCATOR_POOL, see cocos2d::allocator::pooledObjectAllocator.
+    // @param pageSize number of objects added to the pool when it is empty, can be overridden in the configuration with the class name.
+    #define CC_DEFINE_ALLOCATOR_POOL(T, pageSize) \
+        void* T::allocateFromPool(size_t size) \
+        { \
+            return NS_CC_ALLOCATOR::pooledObjectAllocator<T>(#T, pageSize).allocate(size); \
+        } \
+        void T::deallocateToPool(void* object, size_t size) \
+        { \
+            NS_CC_ALLOCATOR::pooledObjectAllocator<T>(#T, pageSize).deallocate(object, size); \
+        }
+
 #else
 
     // macros for new/delete
@@ -105,6 +138,8 @@
 
     // throw these away if not enabled
     #define CC_USE_ALLOCATOR_POOL(...)
+    #define CC_DECLARE_ALLOCATOR_POOL(...)
+    #define CC_DEFINE_ALLOCATOR_POOL(...)
     #define CC_OVERRIDE_GLOBAL_NEWDELETE_WITH_ALLOCATOR(...)
 
 #endif
@@ -76,6 +76,7 @@ public:
         , _pages(nullptr)
         , _pageSize(pageSize)
         , _allocated(0)
+        , _pageCount(0)
     {
 #if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
         _highestCount = 0;
@@ -94,7 +95,7 @@ public:
         {
             intptr_t* page = (intptr_t*)_pages;
             intptr_t* next = (intptr_t*)*page;
-            ccAllocatorGlobal.deallocate(page);
+            ccAllocatorGlobal.deallocate((void*)page[1]);
             _pages = (void*)next;
         }
     }
@@ -160,7 +161,8 @@ public:
     std::string diagnostics() const
     {
         std::stringstream s;
-        s << AllocatorBase::tag() << " initial:" << _pageSize << " count:" << _allocated << " highest:" << _highestCount << "\n";
+        s << AllocatorBase::tag() << " initial:" << _pageSize << " count:" << _allocated << " highest:" << _highestCount
+          << " pages:" << _pageCount << " free:" << _pageCount * _pageSize - _allocated << "\n";
         return s.str();
     }
     size_t _highestCount;
@@ -231,8 +233,11 @@ protected:
     // and adds all the blocks to the free list.
     CC_ALLOCATOR_INLINE void allocatePage()
     {
-        uint8_t* p = (uint8_t*)AllocatorBase::aligned(ccAllocatorGlobal.allocate(pageSize()));
+        // the global allocator may return 8 byte aligned memory, the header of the page keeps the address to free
+        void* memory = ccAllocatorGlobal.allocate(pageSize() + AllocatorBase::kDefaultAlignment);
+        uint8_t* p = (uint8_t*)AllocatorBase::aligned(memory);
         intptr_t* page = (intptr_t*)p;
+        page[1] = (intptr_t)memory;
         if (nullptr == _pages)
         {
             _pages = page;
@@ -247,6 +252,7 @@ protected:
         p += AllocatorBase::kDefaultAlignment; // step past the linked list node
         
         _allocated += _pageSize;
+        ++_pageCount;
         size_t aligned_size = AllocatorBase::nextPow2BlockSize(block_size);
         uint8_t* block = (uint8_t*)p;
         for (unsigned int i = 0; i < _pageSize; ++i, block += aligned_size)
@@ -268,6 +274,9 @@ protected:
     
     // @brief Number of blocks that are currently allocated.
     size_t _allocated;
+
+    // @brief Number of pages allocated, they are only freed with the allocator.
+    size_t _pageCount;
 };
 
 NS_CC_ALLOCATOR_END
@@ -0,0 +1,75 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#include "base/allocator/CCAllocatorStrategyFrame.h"
+
+#if (CC_TARGET_PLATFORM != CC_PLATFORM_WIN32) && (CC_TARGET_PLATFORM != CC_PLATFORM_WINRT)
+#include <pthread.h>
+#endif
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+#if (CC_TARGET_PLATFORM == CC_PLATFORM_WIN32) || (CC_TARGET_PLATFORM == CC_PLATFORM_WINRT)
+
+AllocatorStrategyFrame& AllocatorStrategyFrame::getThreadAllocator()
+{
+    // created on the first use of each thread, freed when the thread exits
+    static thread_local AllocatorStrategyFrame allocator;
+    return allocator;
+}
+
+#else
+
+// thread_local needs iOS 9 with Apple clang, the allocators are kept with a pthread key like JniHelper does
+static pthread_key_t s_allocatorKey;
+static pthread_once_t s_allocatorKeyOnce = PTHREAD_ONCE_INIT;
+
+static void deleteThreadAllocator(void* allocator)
+{
+    delete static_cast<AllocatorStrategyFrame*>(allocator);
+}
+
+static void createThreadAllocatorKey()
+{
+    pthread_key_create(&s_allocatorKey, deleteThreadAllocator);
+}
+
+AllocatorStrategyFrame& AllocatorStrategyFrame::getThreadAllocator()
+{
+    // created on the first use of each thread, freed when the thread exits
+    pthread_once(&s_allocatorKeyOnce, createThreadAllocatorKey);
+    auto allocator = static_cast<AllocatorStrategyFrame*>(pthread_getspecific(s_allocatorKey));
+    if (!allocator)
+    {
+        allocator = new AllocatorStrategyFrame();
+        pthread_setspecific(s_allocatorKey, allocator);
+    }
+    return *allocator;
+}
+
+#endif
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
@@ -0,0 +1,207 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef CC_ALLOCATOR_STRATEGY_FRAME_H
+#define CC_ALLOCATOR_STRATEGY_FRAME_H
+/// @cond DO_NOT_SHOW
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+
+#include "base/allocator/CCAllocatorMacros.h"
+#include "base/allocator/CCAllocatorBase.h"
+
+NS_CC_BEGIN
+NS_CC_ALLOCATOR_BEGIN
+
+// @brief
+// Linear allocator for the data living at most until the end of the frame.
+// Allocations bump a pointer in large pages, deallocations are ignored unless they free the last allocation,
+// and reset() takes everything back in one step while keeping the pages for the next frame.
+// Each thread has its own instance, the one of the cocos thread is reset at the end of Director::drawScene,
+// the ones of the AsyncTaskPool threads after each task. It isn't thread safe, memory must be freed on the
+// thread which allocated it.
+class CC_DLL AllocatorStrategyFrame
+    : public AllocatorBase
+{
+public:
+
+    enum { kDefaultPageSize = 64 * 1024 };
+
+    AllocatorStrategyFrame(size_t pageSize = kDefaultPageSize)
+        : _pageSize(pageSize)
+        , _pageIndex(0)
+        , _current(nullptr)
+        , _end(nullptr)
+        , _frameBytes(0)
+        , _peakFrameBytes(0)
+        , _allocationCount(0)
+        , _allocatedBytes(0)
+        , _heapAllocationCount(0)
+        , _heapAllocatedBytes(0)
+    {}
+
+    virtual ~AllocatorStrategyFrame()
+    {
+        reset();
+        for (auto page : _pages)
+            free(page);
+    }
+
+    // @brief Returns the allocator of the calling thread.
+    static AllocatorStrategyFrame& getThreadAllocator();
+
+    CC_ALLOCATOR_INLINE void* allocate(size_t size, size_t alignment = kDefaultAlignment)
+    {
+        // the large blocks don't waste the end of a page
+        if (size > _pageSize / 4)
+        {
+            void* block = malloc(size);
+            _largeBlocks.push_back(block);
+            ++_heapAllocationCount;
+            _heapAllocatedBytes += size;
+            return block;
+        }
+
+        char* address = (char*)aligned(_current, alignment);
+        if (nullptr == _current || address + size > _end)
+        {
+            nextPage();
+            address = (char*)aligned(_current, alignment);
+        }
+        _frameBytes += address + size - _current;
+        if (_frameBytes > _peakFrameBytes)
+            _peakFrameBytes = _frameBytes;
+        _current = address + size;
+        ++_allocationCount;
+        _allocatedBytes += size;
+        return address;
+    }
+
+    CC_ALLOCATOR_INLINE void deallocate(void* address, size_t size = 0)
+    {
+        // only the last allocation is given back, e.g. the buffer of a growing vector
+        if (nullptr != address && (char*)address + size == _current)
+        {
+            _current = (char*)address;
+            _frameBytes -= size;
+        }
+    }
+
+    // @brief Frees all the allocations made since the last reset, the pages are kept.
+    void reset()
+    {
+        for (auto block : _largeBlocks)
+            free(block);
+        _largeBlocks.clear();
+
+        _pageIndex = 0;
+        _current = _pages.empty() ? nullptr : _pages[0];
+        _end = _pages.empty() ? nullptr : _pages[0] + _pageSize;
+        _frameBytes = 0;
+    }
+
+    // @brief Number of allocations and bytes served from the pages since the allocator was created.
+    size_t getAllocationCount() const { return _allocationCount; }
+    size_t getAllocatedBytes() const { return _allocatedBytes; }
+
+    // @brief Number of pages and large blocks taken from the heap since the allocator was created.
+    size_t getHeapAllocationCount() const { return _heapAllocationCount; }
+    size_t getHeapAllocatedBytes() const { return _heapAllocatedBytes; }
+
+    // @brief Most bytes used in the pages between two resets, padding included.
+    size_t getPeakFrameBytes() const { return _peakFrameBytes; }
+
+protected:
+
+    void nextPage()
+    {
+        // the space left in the current page counts as used until the reset
+        if (nullptr != _current)
+            _frameBytes += _end - _current;
+
+        if (nullptr != _current)
+            ++_pageIndex;
+        if (_pageIndex == _pages.size())
+        {
+            _pages.push_back((char*)malloc(_pageSize));
+            ++_heapAllocationCount;
+            _heapAllocatedBytes += _pageSize;
+        }
+        _current = _pages[_pageIndex];
+        _end = _current + _pageSize;
+    }
+
+    size_t _pageSize;
+    std::vector<char*> _pages;
+    std::vector<void*> _largeBlocks;
+    size_t _pageIndex;
+    char* _current;
+    char* _end;
+    size_t _frameBytes;
+    size_t _peakFrameBytes;
+    size_t _allocationCount;
+    size_t _allocatedBytes;
+    size_t _heapAllocationCount;
+    size_t _heapAllocatedBytes;
+};
+
+// @brief
+// STL allocator on the frame allocator of the calling thread, for the containers of a function running within a frame.
+// e.g. FrameVector<Node*> nodes;
+template <typename T>
+class FrameAllocator
+{
+public:
+
+    typedef T value_type;
+
+    FrameAllocator() {}
+    template <typename U> FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        const size_t defaultAlignment = static_cast<size_t>(AllocatorBase::kDefaultAlignment);
+        size_t alignment = alignof(T) > defaultAlignment ? alignof(T) : defaultAlignment;
+        return static_cast<T*>(AllocatorStrategyFrame::getThreadAllocator().allocate(n * sizeof(T), alignment));
+    }
+
+    void deallocate(T* address, size_t n)
+    {
+        AllocatorStrategyFrame::getThreadAllocator().deallocate(address, n * sizeof(T));
+    }
+
+    template <typename U> bool operator==(const FrameAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const FrameAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+NS_CC_ALLOCATOR_END
+NS_CC_END
+
+/// @endcond
+#endif//CC_ALLOCATOR_STRATEGY_FRAME_H
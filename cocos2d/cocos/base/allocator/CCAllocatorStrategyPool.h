@@ -82,6 +82,26 @@ public:
     }
 };
 
+/**
+ * ObjectTraits of the objects allocated by their new operator, see CC_DECLARE_ALLOCATOR_POOL.
+ * The pool only hands out the memory, the object is constructed and destroyed by new and delete.
+ *
+ * @param T Type of object.
+ * @param _alignment Alignment of object T, 16 bytes for the SSE math members.
+ */
+template <typename T, size_t _alignment = AllocatorBase::kDefaultAlignment>
+class PooledObjectTraits
+    : public ObjectTraits<T, _alignment>
+{
+public:
+
+    void construct(T* /*address*/)
+    {}
+
+    void destroy(T* /*address*/)
+    {}
+};
+
 /**
  * Fixed sized pool allocator strategy for objects of type T.
  *
@@ -108,6 +128,9 @@ public:
     
     AllocatorStrategyPool(const char* tag = nullptr, size_t poolSize = 100)
         : tParentStrategy(tag)
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+        , _fallbackCount(0)
+#endif
     {
         poolSize = Configuration::getInstance()->getValue(tag, Value((int)poolSize)).asInt();
         tParentStrategy::_pageSize = poolSize;
@@ -129,6 +152,11 @@ public:
         else
         {
             object = (T*)ccAllocatorGlobal.allocate(size);
+#if CC_ENABLE_ALLOCATOR_DIAGNOSTICS
+            tParentStrategy::lock();
+            ++_fallbackCount;
+            tParentStrategy::unlock();
+#endif
         }
         O::construct(object);
         return object;
@@ -160,12 +188,33 @@ public:
     std::string diagnostics() const
     {
         std::stringstream s;
-        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount << "\n";
+        s << AllocatorBase::tag() << " initial:" << tParentStrategy::_pageSize << " count:" << tParentStrategy::_allocated << " highest:" << tParentStrategy::_highestCount
+          << " pages:" << tParentStrategy::_pageCount << " free:" << tParentStrategy::_pageCount * tParentStrategy::_pageSize - tParentStrategy::_allocated
+          << " fallback:" << _fallbackCount << "\n";
         return s.str();
-    }    
+    }
+
+    // @brief Number of allocations of another size than T, which went to the global allocator.
+    size_t _fallbackCount;
 #endif
 };
 
+/**
+ * Returns the thread safe pool of the objects of type T allocated by CC_DECLARE_ALLOCATOR_POOL.
+ *
+ * The pool is created on the first allocation and never destroyed,
+ * since objects can still be released after the static destructors ran.
+ *
+ * @param tag The name of the pool in the diagnostics and configuration.
+ * @param pageSize Number of objects added to the pool when it is empty.
+ */
+template <typename T>
+AllocatorStrategyPool<T, PooledObjectTraits<T>, locking_semantics>& pooledObjectAllocator(const char* tag, size_t pageSize)
+{
+    static auto pool = new AllocatorStrategyPool<T, PooledObjectTraits<T>, locking_semantics>(tag, pageSize);
+    return *pool;
+}
+
 NS_CC_ALLOCATOR_END
 NS_CC_END
 
@@ -247,6 +247,16 @@ THE SOFTWARE.
 #define CC_ENABLE_PROFILERS 0
 #endif
 
+/** @def CC_ENABLE_TRACING
+ * If enabled, the CC_TRACE_SCOPE scopes are compiled in, they are recorded once Tracer::setEnabled(true) is called
+ * or "trace on" is typed in the console. A scope costs a load and a branch while the tracer is off.
+ * To disable set it to 0. Enabled by default.
+ * @since v3.17
+ */
+#ifndef CC_ENABLE_TRACING
+#define CC_ENABLE_TRACING 1
+#endif
+
 /** Enable Lua engine debug log. */
 #ifndef CC_LUA_ENGINE_DEBUG
 #define CC_LUA_ENGINE_DEBUG 0
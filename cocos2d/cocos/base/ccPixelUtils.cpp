@@ -0,0 +1,624 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "base/ccPixelUtils.h"
+
+#include <string.h>
+
+//#define INCLUDE_SSE2      : SSE2 code included, SSE2 is always available on the targets including it
+//#define INCLUDE_AVX2      : AVX2 code included, used when the CPU supports it
+//#define INCLUDE_NEON      : NEON code included, NEON is always available on the targets including it
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined (INCLUDE_SSE2) && (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define INCLUDE_AVX2
+#include <immintrin.h>
+#define CC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define INCLUDE_NEON
+#include <arm_neon.h>
+#endif
+
+NS_CC_BEGIN
+
+namespace PixelUtils
+{
+
+bool isSSE2Enabled()
+{
+#ifdef INCLUDE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool isAVX2Enabled()
+{
+#ifdef INCLUDE_AVX2
+    static const bool enabled = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return enabled;
+#else
+    return false;
+#endif
+}
+
+bool isNeonEnabled()
+{
+#ifdef INCLUDE_NEON
+    return true;
+#else
+    return false;
+#endif
+}
+
+//////////////////////////////////////////////////////////////////////////
+// scalar kernels, they also handle the pixels left by the SIMD kernels
+
+static void premultiplyAlphaScalar(unsigned char* data, ssize_t pixelCount)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        unsigned int alpha = data[3] + 1;
+        data[0] = (unsigned char)((data[0] * alpha) >> 8);
+        data[1] = (unsigned char)((data[1] * alpha) >> 8);
+        data[2] = (unsigned char)((data[2] * alpha) >> 8);
+    }
+}
+
+static void convertRGB888ToRGBA8888Scalar(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 3)
+    {
+        *outData++ = data[0];         //R
+        *outData++ = data[1];         //G
+        *outData++ = data[2];         //B
+        *outData++ = 0xFF;            //A
+    }
+}
+
+static void convertRGBA8888ToRGB888Scalar(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *outData++ = data[0];         //R
+        *outData++ = data[1];         //G
+        *outData++ = data[2];         //B
+    }
+}
+
+static void convertRGBA8888ToRGB565Scalar(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *out16++ = (data[0] & 0x00F8) << 8    //R
+            | (data[1] & 0x00FC) << 3         //G
+            | (data[2] & 0x00F8) >> 3;        //B
+    }
+}
+
+static void convertRGBA8888ToA8Scalar(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *outData++ = data[3]; //A
+    }
+}
+
+static void convertRGBA8888ToRGBA4444Scalar(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *out16++ = (data[0] & 0x00F0) << 8    //R
+            | (data[1] & 0x00F0) << 4         //G
+            | (data[2] & 0xF0)                //B
+            | (data[3] & 0xF0) >> 4;          //A
+    }
+}
+
+static void convertRGBA8888ToRGB5A1Scalar(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    unsigned short* out16 = (unsigned short*)outData;
+    for (ssize_t i = 0; i < pixelCount; ++i, data += 4)
+    {
+        *out16++ = (data[0] & 0x00F8) << 8    //R
+            | (data[1] & 0x00F8) << 3         //G
+            | (data[2] & 0x00F8) >> 2         //B
+            | (data[3] & 0x0080) >> 7;        //A
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////
+// SSE2 kernels, each one returns the number of pixels it converted
+
+#ifdef INCLUDE_SSE2
+
+// c * (a + 1) >> 8 on the RGB words of 2 pixels, the alpha words are kept
+static inline __m128i premultiplyWordsSSE2(__m128i px, __m128i one, __m128i alphaMask)
+{
+    __m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i mul = _mm_srli_epi16(_mm_mullo_epi16(px, _mm_add_epi16(alpha, one)), 8);
+    return _mm_or_si128(_mm_andnot_si128(alphaMask, mul), _mm_and_si128(alphaMask, px));
+}
+
+static ssize_t premultiplyAlphaSSE2(unsigned char* data, ssize_t pixelCount)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+    ssize_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128i* p = (__m128i*)(data + i * 4);
+        __m128i px = _mm_loadu_si128(p);
+        __m128i lo = premultiplyWordsSSE2(_mm_unpacklo_epi8(px, zero), one, alphaMask);
+        __m128i hi = premultiplyWordsSSE2(_mm_unpackhi_epi8(px, zero), one, alphaMask);
+        _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA is read as a little endian 32 bits word, the result is in the low 16 bits
+
+static inline __m128i toRGB565SSE2(__m128i v)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_and_si128(_mm_slli_epi32(v, 8), _mm_set1_epi32(0xF800)),
+        _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x07E0))),
+        _mm_and_si128(_mm_srli_epi32(v, 19), _mm_set1_epi32(0x001F)));
+}
+
+static inline __m128i toRGBA4444SSE2(__m128i v)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_and_si128(_mm_slli_epi32(v, 8), _mm_set1_epi32(0xF000)),
+        _mm_and_si128(_mm_srli_epi32(v, 4), _mm_set1_epi32(0x0F00))),
+        _mm_or_si128(
+        _mm_and_si128(_mm_srli_epi32(v, 16), _mm_set1_epi32(0x00F0)),
+        _mm_srli_epi32(v, 28)));
+}
+
+static inline __m128i toRGB5A1SSE2(__m128i v)
+{
+    return _mm_or_si128(_mm_or_si128(
+        _mm_and_si128(_mm_slli_epi32(v, 8), _mm_set1_epi32(0xF800)),
+        _mm_and_si128(_mm_srli_epi32(v, 5), _mm_set1_epi32(0x07C0))),
+        _mm_or_si128(
+        _mm_and_si128(_mm_srli_epi32(v, 18), _mm_set1_epi32(0x003E)),
+        _mm_srli_epi32(v, 31)));
+}
+
+// sign extends the low 16 bits so that the saturating pack keeps them unchanged
+static inline __m128i packLow16SSE2(__m128i a, __m128i b)
+{
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+template <__m128i (*Pack)(__m128i)>
+static ssize_t convertRGBA8888To16SSE2(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        __m128i a = Pack(_mm_loadu_si128((const __m128i*)(data + i * 4)));
+        __m128i b = Pack(_mm_loadu_si128((const __m128i*)(data + i * 4 + 16)));
+        _mm_storeu_si128((__m128i*)(outData + i * 2), packLow16SSE2(a, b));
+    }
+    return i;
+}
+
+static ssize_t convertRGBA8888ToA8SSE2(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        const __m128i* p = (const __m128i*)(data + i * 4);
+        __m128i a = _mm_srli_epi32(_mm_loadu_si128(p), 24);
+        __m128i b = _mm_srli_epi32(_mm_loadu_si128(p + 1), 24);
+        __m128i c = _mm_srli_epi32(_mm_loadu_si128(p + 2), 24);
+        __m128i d = _mm_srli_epi32(_mm_loadu_si128(p + 3), 24);
+        _mm_storeu_si128((__m128i*)(outData + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+    }
+    return i;
+}
+
+#endif // INCLUDE_SSE2
+
+//////////////////////////////////////////////////////////////////////////
+// AVX2 kernels, only called when isAVX2Enabled() returns true
+
+#ifdef INCLUDE_AVX2
+
+CC_TARGET_AVX2 static inline __m256i premultiplyWordsAVX2(__m256i px, __m256i one, __m256i alphaMask)
+{
+    __m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i mul = _mm256_srli_epi16(_mm256_mullo_epi16(px, _mm256_add_epi16(alpha, one)), 8);
+    return _mm256_or_si256(_mm256_andnot_si256(alphaMask, mul), _mm256_and_si256(alphaMask, px));
+}
+
+CC_TARGET_AVX2 static ssize_t premultiplyAlphaAVX2(unsigned char* data, ssize_t pixelCount)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i one = _mm256_set1_epi16(1);
+    const __m256i alphaMask = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        __m256i* p = (__m256i*)(data + i * 4);
+        __m256i px = _mm256_loadu_si256(p);
+        // unpack and pack work on each 128 bits lane, the pixel order is kept
+        __m256i lo = premultiplyWordsAVX2(_mm256_unpacklo_epi8(px, zero), one, alphaMask);
+        __m256i hi = premultiplyWordsAVX2(_mm256_unpackhi_epi8(px, zero), one, alphaMask);
+        _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+    }
+    return i;
+}
+
+CC_TARGET_AVX2 static inline __m256i toRGB565AVX2(__m256i v)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_and_si256(_mm256_slli_epi32(v, 8), _mm256_set1_epi32(0xF800)),
+        _mm256_and_si256(_mm256_srli_epi32(v, 5), _mm256_set1_epi32(0x07E0))),
+        _mm256_and_si256(_mm256_srli_epi32(v, 19), _mm256_set1_epi32(0x001F)));
+}
+
+CC_TARGET_AVX2 static inline __m256i toRGBA4444AVX2(__m256i v)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_and_si256(_mm256_slli_epi32(v, 8), _mm256_set1_epi32(0xF000)),
+        _mm256_and_si256(_mm256_srli_epi32(v, 4), _mm256_set1_epi32(0x0F00))),
+        _mm256_or_si256(
+        _mm256_and_si256(_mm256_srli_epi32(v, 16), _mm256_set1_epi32(0x00F0)),
+        _mm256_srli_epi32(v, 28)));
+}
+
+CC_TARGET_AVX2 static inline __m256i toRGB5A1AVX2(__m256i v)
+{
+    return _mm256_or_si256(_mm256_or_si256(
+        _mm256_and_si256(_mm256_slli_epi32(v, 8), _mm256_set1_epi32(0xF800)),
+        _mm256_and_si256(_mm256_srli_epi32(v, 5), _mm256_set1_epi32(0x07C0))),
+        _mm256_or_si256(
+        _mm256_and_si256(_mm256_srli_epi32(v, 18), _mm256_set1_epi32(0x003E)),
+        _mm256_srli_epi32(v, 31)));
+}
+
+template <__m256i (*Pack)(__m256i)>
+CC_TARGET_AVX2 static ssize_t convertRGBA8888To16AVX2(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 16 <= pixelCount; i += 16)
+    {
+        __m256i a = Pack(_mm256_loadu_si256((const __m256i*)(data + i * 4)));
+        __m256i b = Pack(_mm256_loadu_si256((const __m256i*)(data + i * 4 + 32)));
+        a = _mm256_srai_epi32(_mm256_slli_epi32(a, 16), 16);
+        b = _mm256_srai_epi32(_mm256_slli_epi32(b, 16), 16);
+        // the pack interleaves the 128 bits lanes of a and b, put them back in order
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i*)(outData + i * 2), packed);
+    }
+    return i;
+}
+
+CC_TARGET_AVX2 static ssize_t convertRGBA8888ToA8AVX2(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+    ssize_t i = 0;
+    for (; i + 32 <= pixelCount; i += 32)
+    {
+        const __m256i* p = (const __m256i*)(data + i * 4);
+        __m256i a = _mm256_srli_epi32(_mm256_loadu_si256(p), 24);
+        __m256i b = _mm256_srli_epi32(_mm256_loadu_si256(p + 1), 24);
+        __m256i c = _mm256_srli_epi32(_mm256_loadu_si256(p + 2), 24);
+        __m256i d = _mm256_srli_epi32(_mm256_loadu_si256(p + 3), 24);
+        __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+        _mm256_storeu_si256((__m256i*)(outData + i), _mm256_permutevar8x32_epi32(packed, order));
+    }
+    return i;
+}
+
+// the byte shuffles only need SSSE3, which every AVX2 CPU has
+
+CC_TARGET_AVX2 static ssize_t convertRGB888ToRGBA8888AVX2(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32((int)0xFF000000);
+
+    ssize_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        // read exactly the 12 bytes of the 4 pixels
+        const unsigned char* p = data + i * 3;
+        int tail;
+        memcpy(&tail, p + 8, sizeof(tail));
+        __m128i px = _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*)p), _mm_cvtsi32_si128(tail));
+        _mm_storeu_si128((__m128i*)(outData + i * 4), _mm_or_si128(_mm_shuffle_epi8(px, shuffle), alpha));
+    }
+    return i;
+}
+
+CC_TARGET_AVX2 static ssize_t convertRGBA8888ToRGB888AVX2(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    ssize_t i = 0;
+    for (; i + 4 <= pixelCount; i += 4)
+    {
+        __m128i rgb = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + i * 4)), shuffle);
+        // write exactly the 12 bytes of the 4 pixels
+        unsigned char* p = outData + i * 3;
+        _mm_storel_epi64((__m128i*)p, rgb);
+        int tail = _mm_cvtsi128_si32(_mm_srli_si128(rgb, 8));
+        memcpy(p + 8, &tail, sizeof(tail));
+    }
+    return i;
+}
+
+#endif // INCLUDE_AVX2
+
+//////////////////////////////////////////////////////////////////////////
+// NEON kernels
+
+#ifdef INCLUDE_NEON
+
+static ssize_t premultiplyAlphaNeon(unsigned char* data, ssize_t pixelCount)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t px = vld4_u8(data + i * 4);
+        // c * (a + 1) == c * a + c
+        px.val[0] = vshrn_n_u16(vaddw_u8(vmull_u8(px.val[0], px.val[3]), px.val[0]), 8);
+        px.val[1] = vshrn_n_u16(vaddw_u8(vmull_u8(px.val[1], px.val[3]), px.val[1]), 8);
+        px.val[2] = vshrn_n_u16(vaddw_u8(vmull_u8(px.val[2], px.val[3]), px.val[2]), 8);
+        vst4_u8(data + i * 4, px);
+    }
+    return i;
+}
+
+static ssize_t convertRGB888ToRGBA8888Neon(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x3_t rgb = vld3_u8(data + i * 3);
+        uint8x8x4_t rgba;
+        rgba.val[0] = rgb.val[0];
+        rgba.val[1] = rgb.val[1];
+        rgba.val[2] = rgb.val[2];
+        rgba.val[3] = vdup_n_u8(0xFF);
+        vst4_u8(outData + i * 4, rgba);
+    }
+    return i;
+}
+
+static ssize_t convertRGBA8888ToRGB888Neon(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t rgba = vld4_u8(data + i * 4);
+        uint8x8x3_t rgb;
+        rgb.val[0] = rgba.val[0];
+        rgb.val[1] = rgba.val[1];
+        rgb.val[2] = rgba.val[2];
+        vst3_u8(outData + i * 3, rgb);
+    }
+    return i;
+}
+
+static ssize_t convertRGBA8888ToA8Neon(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t rgba = vld4_u8(data + i * 4);
+        vst1_u8(outData + i, rgba.val[3]);
+    }
+    return i;
+}
+
+static ssize_t convertRGBA8888ToRGB565Neon(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t rgba = vld4_u8(data + i * 4);
+        uint16x8_t r = vshll_n_u8(vand_u8(rgba.val[0], vdup_n_u8(0xF8)), 8);
+        uint16x8_t g = vshll_n_u8(vand_u8(rgba.val[1], vdup_n_u8(0xFC)), 3);
+        uint16x8_t b = vmovl_u8(vshr_n_u8(rgba.val[2], 3));
+        vst1q_u16((uint16_t*)(outData + i * 2), vorrq_u16(vorrq_u16(r, g), b));
+    }
+    return i;
+}
+
+static ssize_t convertRGBA8888ToRGBA4444Neon(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t rgba = vld4_u8(data + i * 4);
+        uint16x8_t r = vshll_n_u8(vand_u8(rgba.val[0], vdup_n_u8(0xF0)), 8);
+        uint16x8_t g = vshll_n_u8(vand_u8(rgba.val[1], vdup_n_u8(0xF0)), 4);
+        uint16x8_t b = vmovl_u8(vand_u8(rgba.val[2], vdup_n_u8(0xF0)));
+        uint16x8_t a = vmovl_u8(vshr_n_u8(rgba.val[3], 4));
+        vst1q_u16((uint16_t*)(outData + i * 2), vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, a)));
+    }
+    return i;
+}
+
+static ssize_t convertRGBA8888ToRGB5A1Neon(const unsigned char* data, ssize_t pixelCount, unsigned char* outData)
+{
+    ssize_t i = 0;
+    for (; i + 8 <= pixelCount; i += 8)
+    {
+        uint8x8x4_t rgba = vld4_u8(data + i * 4);
+        uint16x8_t r = vshll_n_u8(vand_u8(rgba.val[0], vdup_n_u8(0xF8)), 8);
+        uint16x8_t g = vshll_n_u8(vand_u8(rgba.val[1], vdup_n_u8(0xF8)), 3);
+        uint16x8_t b = vmovl_u8(vshr_n_u8(vand_u8(rgba.val[2], vdup_n_u8(0xF8)), 2));
+        uint16x8_t a = vmovl_u8(vshr_n_u8(rgba.val[3], 7));
+        vst1q_u16((uint16_t*)(outData + i * 2), vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, a)));
+    }
+    return i;
+}
+
+#endif // INCLUDE_NEON
+
+//////////////////////////////////////////////////////////////////////////
+// dispatch
+
+void premultiplyAlpha(unsigned char* data, ssize_t pixelCount)
+{
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = premultiplyAlphaAVX2(data, pixelCount);
+    else
+        done = premultiplyAlphaSSE2(data, pixelCount);
+#elif defined (INCLUDE_SSE2)
+    done = premultiplyAlphaSSE2(data, pixelCount);
+#elif defined (INCLUDE_NEON)
+    done = premultiplyAlphaNeon(data, pixelCount);
+#endif
+    premultiplyAlphaScalar(data + done * 4, pixelCount - done);
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBB -> RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA
+void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t pixelCount = dataLen / 3;
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = convertRGB888ToRGBA8888AVX2(data, pixelCount, outData);
+#elif defined (INCLUDE_NEON)
+    done = convertRGB888ToRGBA8888Neon(data, pixelCount, outData);
+#endif
+    convertRGB888ToRGBA8888Scalar(data + done * 3, pixelCount - done, outData + done * 4);
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRRRRGGGGGGGGBBBBBBBB
+void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t pixelCount = dataLen / 4;
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = convertRGBA8888ToRGB888AVX2(data, pixelCount, outData);
+#elif defined (INCLUDE_NEON)
+    done = convertRGBA8888ToRGB888Neon(data, pixelCount, outData);
+#endif
+    convertRGBA8888ToRGB888Scalar(data + done * 4, pixelCount - done, outData + done * 3);
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGGBBBBB
+void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t pixelCount = dataLen / 4;
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = convertRGBA8888To16AVX2<toRGB565AVX2>(data, pixelCount, outData);
+    else
+        done = convertRGBA8888To16SSE2<toRGB565SSE2>(data, pixelCount, outData);
+#elif defined (INCLUDE_SSE2)
+    done = convertRGBA8888To16SSE2<toRGB565SSE2>(data, pixelCount, outData);
+#elif defined (INCLUDE_NEON)
+    done = convertRGBA8888ToRGB565Neon(data, pixelCount, outData);
+#endif
+    convertRGBA8888ToRGB565Scalar(data + done * 4, pixelCount - done, outData + done * 2);
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> AAAAAAAA
+void convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t pixelCount = dataLen / 4;
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = convertRGBA8888ToA8AVX2(data, pixelCount, outData);
+    else
+        done = convertRGBA8888ToA8SSE2(data, pixelCount, outData);
+#elif defined (INCLUDE_SSE2)
+    done = convertRGBA8888ToA8SSE2(data, pixelCount, outData);
+#elif defined (INCLUDE_NEON)
+    done = convertRGBA8888ToA8Neon(data, pixelCount, outData);
+#endif
+    convertRGBA8888ToA8Scalar(data + done * 4, pixelCount - done, outData + done);
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRGGGGBBBBAAAA
+void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t pixelCount = dataLen / 4;
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = convertRGBA8888To16AVX2<toRGBA4444AVX2>(data, pixelCount, outData);
+    else
+        done = convertRGBA8888To16SSE2<toRGBA4444SSE2>(data, pixelCount, outData);
+#elif defined (INCLUDE_SSE2)
+    done = convertRGBA8888To16SSE2<toRGBA4444SSE2>(data, pixelCount, outData);
+#elif defined (INCLUDE_NEON)
+    done = convertRGBA8888ToRGBA4444Neon(data, pixelCount, outData);
+#endif
+    convertRGBA8888ToRGBA4444Scalar(data + done * 4, pixelCount - done, outData + done * 2);
+}
+
+// RRRRRRRRGGGGGGGGBBBBBBBBAAAAAAAA -> RRRRRGGGGGBBBBBA
+void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData)
+{
+    ssize_t pixelCount = dataLen / 4;
+    ssize_t done = 0;
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        done = convertRGBA8888To16AVX2<toRGB5A1AVX2>(data, pixelCount, outData);
+    else
+        done = convertRGBA8888To16SSE2<toRGB5A1SSE2>(data, pixelCount, outData);
+#elif defined (INCLUDE_SSE2)
+    done = convertRGBA8888To16SSE2<toRGB5A1SSE2>(data, pixelCount, outData);
+#elif defined (INCLUDE_NEON)
+    done = convertRGBA8888ToRGB5A1Neon(data, pixelCount, outData);
+#endif
+    convertRGBA8888ToRGB5A1Scalar(data + done * 4, pixelCount - done, outData + done * 2);
+}
+
+} // namespace PixelUtils
+
+NS_CC_END
@@ -0,0 +1,67 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+#ifndef __SUPPORT_CC_PIXEL_UTILS_H__
+#define __SUPPORT_CC_PIXEL_UTILS_H__
+
+#include "platform/CCPlatformMacros.h"
+#include "platform/CCStdC.h"
+
+/** @file ccPixelUtils.h
+Pixel kernels used by Image and Texture2D.
+The SSE2, AVX2 or NEON implementation is picked at runtime, the results are the same as the scalar code.
+*/
+
+NS_CC_BEGIN
+
+namespace PixelUtils
+{
+    /** Returns true if the SSE2 kernels are used. */
+    CC_DLL bool isSSE2Enabled();
+
+    /** Returns true if the AVX2 kernels are used. */
+    CC_DLL bool isAVX2Enabled();
+
+    /** Returns true if the NEON kernels are used. */
+    CC_DLL bool isNeonEnabled();
+
+    /** Premultiplies the RGB channels of RGBA8888 pixels by their alpha, in place.
+     * @param data The pixels.
+     * @param pixelCount The number of pixels.
+     */
+    CC_DLL void premultiplyAlpha(unsigned char* data, ssize_t pixelCount);
+
+    /** The converters have the same signature as the Texture2D ones,
+     * dataLen is the size of the source buffer in bytes.
+     */
+    CC_DLL void convertRGB888ToRGBA8888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGB888(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGB565(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToA8(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGBA4444(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+    CC_DLL void convertRGBA8888ToRGB5A1(const unsigned char* data, ssize_t dataLen, unsigned char* outData);
+}
+
+NS_CC_END
+
+#endif // __SUPPORT_CC_PIXEL_UTILS_H__
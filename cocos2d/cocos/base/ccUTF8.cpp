@@ -29,6 +29,27 @@
 #include "base/CCConsole.h"
 #include "ConvertUTF.h"
 #include <limits>
+#include <string.h>
+
+//#define INCLUDE_SSE2      : SSE2 code included, SSE2 is always available on the targets including it
+//#define INCLUDE_AVX2      : AVX2 code included, used when the CPU supports it
+//#define INCLUDE_NEON      : NEON code included, NEON is always available on the targets including it
+
+#if defined (__SSE2__) || defined (_M_X64) || (defined (_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INCLUDE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined (INCLUDE_SSE2) && (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define INCLUDE_AVX2
+#include <immintrin.h>
+#define CC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define INCLUDE_NEON
+#include <arm_neon.h>
+#endif
 
 NS_CC_BEGIN
 
@@ -275,14 +296,339 @@ bool utfConvert(
 };
 
 
+/*
+ * UTF-8 decoding. The runs of ASCII, most of the text of many languages, are copied or counted by blocks with
+ * SIMD kernels, the other characters are decoded one by one. The sequences accepted are the ones accepted by
+ * ConvertUTF with strictConversion, i.e. no overlong forms, surrogates or code points beyond U+10FFFF.
+ */
+
+#ifdef INCLUDE_AVX2
+static bool isAVX2Enabled()
+{
+    static const bool enabled = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return enabled;
+}
+#endif
+
+// The kernels handle whole blocks of ASCII and return the number of bytes handled,
+// they stop at the first block with another byte.
+
+#ifdef INCLUDE_SSE2
+static size_t countASCIISSE2(const unsigned char* in, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)(in + i))) != 0)
+            break;
+    }
+    return i;
+}
+
+static size_t widenASCIISSE2(const unsigned char* in, size_t len, char16_t* out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        if (_mm_movemask_epi8(v) != 0)
+            break;
+        _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+    return i;
+}
+
+static size_t widenASCIISSE2(const unsigned char* in, size_t len, char32_t* out)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(in + i));
+        if (_mm_movemask_epi8(v) != 0)
+            break;
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(out + i + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(out + i + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i*)(out + i + 12), _mm_unpackhi_epi16(hi, zero));
+    }
+    return i;
+}
+#endif // INCLUDE_SSE2
+
+#ifdef INCLUDE_AVX2
+CC_TARGET_AVX2 static size_t countASCIIAVX2(const unsigned char* in, size_t len)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)(in + i))) != 0)
+            break;
+    }
+    return i;
+}
+
+CC_TARGET_AVX2 static size_t widenASCIIAVX2(const unsigned char* in, size_t len, char16_t* out)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        if (_mm256_movemask_epi8(v) != 0)
+            break;
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_cvtepu8_epi16(_mm256_castsi256_si128(v)));
+        _mm256_storeu_si256((__m256i*)(out + i + 16), _mm256_cvtepu8_epi16(_mm256_extracti128_si256(v, 1)));
+    }
+    return i;
+}
+
+CC_TARGET_AVX2 static size_t widenASCIIAVX2(const unsigned char* in, size_t len, char32_t* out)
+{
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(in + i));
+        if (_mm256_movemask_epi8(v) != 0)
+            break;
+        __m128i lo = _mm256_castsi256_si128(v);
+        __m128i hi = _mm256_extracti128_si256(v, 1);
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_cvtepu8_epi32(lo));
+        _mm256_storeu_si256((__m256i*)(out + i + 8), _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+        _mm256_storeu_si256((__m256i*)(out + i + 16), _mm256_cvtepu8_epi32(hi));
+        _mm256_storeu_si256((__m256i*)(out + i + 24), _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+    }
+    return i;
+}
+#endif // INCLUDE_AVX2
+
+#ifdef INCLUDE_NEON
+static inline bool isASCIINeon(uint8x16_t v)
+{
+    uint8x8_t bits = vorr_u8(vget_low_u8(v), vget_high_u8(v));
+    return (vget_lane_u64(vreinterpret_u64_u8(bits), 0) & 0x8080808080808080ULL) == 0;
+}
+
+static size_t countASCIINeon(const unsigned char* in, size_t len)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        if (!isASCIINeon(vld1q_u8(in + i)))
+            break;
+    }
+    return i;
+}
+
+static size_t widenASCIINeon(const unsigned char* in, size_t len, char16_t* out)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(in + i);
+        if (!isASCIINeon(v))
+            break;
+        vst1q_u16((uint16_t*)(out + i), vmovl_u8(vget_low_u8(v)));
+        vst1q_u16((uint16_t*)(out + i + 8), vmovl_u8(vget_high_u8(v)));
+    }
+    return i;
+}
+
+static size_t widenASCIINeon(const unsigned char* in, size_t len, char32_t* out)
+{
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
+    {
+        uint8x16_t v = vld1q_u8(in + i);
+        if (!isASCIINeon(v))
+            break;
+        uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        vst1q_u32((uint32_t*)(out + i), vmovl_u16(vget_low_u16(lo)));
+        vst1q_u32((uint32_t*)(out + i + 4), vmovl_u16(vget_high_u16(lo)));
+        vst1q_u32((uint32_t*)(out + i + 8), vmovl_u16(vget_low_u16(hi)));
+        vst1q_u32((uint32_t*)(out + i + 12), vmovl_u16(vget_high_u16(hi)));
+    }
+    return i;
+}
+#endif // INCLUDE_NEON
+
+static size_t countASCII(const unsigned char* in, size_t len)
+{
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        return countASCIIAVX2(in, len);
+    return countASCIISSE2(in, len);
+#elif defined (INCLUDE_SSE2)
+    return countASCIISSE2(in, len);
+#elif defined (INCLUDE_NEON)
+    return countASCIINeon(in, len);
+#else
+    return 0;
+#endif
+}
+
+template <typename To>
+static size_t widenASCII(const unsigned char* in, size_t len, To* out)
+{
+#if defined (INCLUDE_AVX2)
+    if (isAVX2Enabled())
+        return widenASCIIAVX2(in, len, out);
+    return widenASCIISSE2(in, len, out);
+#elif defined (INCLUDE_SSE2)
+    return widenASCIISSE2(in, len, out);
+#elif defined (INCLUDE_NEON)
+    return widenASCIINeon(in, len, out);
+#else
+    return 0;
+#endif
+}
+
+// Decodes the character starting with a byte >= 0x80, returns its length, 0 if it is illegal or truncated.
+static inline int decodeUTF8(const unsigned char* in, const unsigned char* end, char32_t* ch)
+{
+    unsigned char lead = in[0];
+    size_t left = end - in;
+    if (lead < 0xC2)
+    {
+        return 0;
+    }
+    else if (lead < 0xE0)
+    {
+        if (left < 2 || (in[1] & 0xC0) != 0x80)
+            return 0;
+        *ch = ((lead & 0x1F) << 6) | (in[1] & 0x3F);
+        return 2;
+    }
+    else if (lead < 0xF0)
+    {
+        // the second byte excludes the overlong forms after 0xE0 and the surrogates after 0xED
+        unsigned char low = (lead == 0xE0) ? 0xA0 : 0x80;
+        unsigned char high = (lead == 0xED) ? 0x9F : 0xBF;
+        if (left < 3 || in[1] < low || in[1] > high || (in[2] & 0xC0) != 0x80)
+            return 0;
+        *ch = ((lead & 0x0F) << 12) | ((in[1] & 0x3F) << 6) | (in[2] & 0x3F);
+        return 3;
+    }
+    else if (lead < 0xF5)
+    {
+        // the second byte excludes the overlong forms after 0xF0 and the code points beyond U+10FFFF after 0xF4
+        unsigned char low = (lead == 0xF0) ? 0x90 : 0x80;
+        unsigned char high = (lead == 0xF4) ? 0x8F : 0xBF;
+        if (left < 4 || in[1] < low || in[1] > high || (in[2] & 0xC0) != 0x80 || (in[3] & 0xC0) != 0x80)
+            return 0;
+        *ch = ((lead & 0x07) << 18) | ((in[1] & 0x3F) << 12) | ((in[2] & 0x3F) << 6) | (in[3] & 0x3F);
+        return 4;
+    }
+    return 0;
+}
+
+static inline void appendUTF(char32_t ch, char16_t*& out)
+{
+    if (ch < 0x10000)
+    {
+        *out++ = (char16_t)ch;
+    }
+    else
+    {
+        ch -= 0x10000;
+        *out++ = (char16_t)(0xD800 + (ch >> 10));
+        *out++ = (char16_t)(0xDC00 + (ch & 0x3FF));
+    }
+}
+
+static inline void appendUTF(char32_t ch, char32_t*& out)
+{
+    *out++ = ch;
+}
+
+template <typename To>
+static bool convertFromUTF8(const std::string& from, std::basic_string<To>& to)
+{
+    if (from.empty())
+    {
+        to.clear();
+        return true;
+    }
+
+    // a character has at most one UTF-16 or UTF-32 unit per byte
+    std::basic_string<To> working(from.length(), 0);
+
+    auto in = reinterpret_cast<const unsigned char*>(from.data());
+    auto end = in + from.length();
+    To* out = &working[0];
+    while (in < end)
+    {
+        if (*in < 0x80)
+        {
+            size_t count = widenASCII(in, end - in, out);
+            in += count;
+            out += count;
+            while (in < end && *in < 0x80)
+                *out++ = *in++;
+        }
+        else
+        {
+            char32_t ch;
+            int length = decodeUTF8(in, end, &ch);
+            if (length == 0)
+                return false;
+            in += length;
+            appendUTF(ch, out);
+        }
+    }
+
+    working.resize(out - &working[0]);
+    to = std::move(working);
+
+    return true;
+}
+
+// the number of characters, -1 if the string isn't legal UTF-8
+static long countUTF8Characters(const unsigned char* in, size_t len)
+{
+    auto end = in + len;
+    long count = 0;
+    while (in < end)
+    {
+        if (*in < 0x80)
+        {
+            size_t ascii = countASCII(in, end - in);
+            in += ascii;
+            count += (long)ascii;
+            while (in < end && *in < 0x80)
+            {
+                ++in;
+                ++count;
+            }
+        }
+        else
+        {
+            char32_t ch;
+            int length = decodeUTF8(in, end, &ch);
+            if (length == 0)
+                return -1;
+            in += length;
+            ++count;
+        }
+    }
+    return count;
+}
+
 bool UTF8ToUTF16(const std::string& utf8, std::u16string& outUtf16)
 {
-    return utfConvert(utf8, outUtf16, ConvertUTF8toUTF16);
+    return convertFromUTF8(utf8, outUtf16);
 }
 
 bool UTF8ToUTF32(const std::string& utf8, std::u32string& outUtf32)
 {
-    return utfConvert(utf8, outUtf32, ConvertUTF8toUTF32);
+    return convertFromUTF8(utf8, outUtf32);
 }
 
 bool UTF16ToUTF8(const std::u16string& utf16, std::string& outUtf8)
@@ -362,7 +708,9 @@ std::vector<char16_t> getChar16VectorFromUTF16String(const std::u16string& utf16
 
 long getCharacterCountInUTF8String(const std::string& utf8)
 {
-    return getUTF8StringLength((const UTF8*)utf8.c_str());
+    // counted up to the first null character and 0 if the string is illegal, like getUTF8StringLength
+    long count = countUTF8Characters((const unsigned char*)utf8.c_str(), strlen(utf8.c_str()));
+    return count < 0 ? 0 : count;
 }
 
 
@@ -393,7 +741,7 @@ void StringUTF8::replace(const std::string& newStr)
     {
         UTF8* sequenceUtf8 = (UTF8*)newStr.c_str();
 
-        int lengthString = getUTF8StringLength(sequenceUtf8);
+        long lengthString = getCharacterCountInUTF8String(newStr);
 
         if (lengthString == 0)
         {
@@ -401,6 +749,7 @@ void StringUTF8::replace(const std::string& newStr)
             return;
         }
 
+        _str.reserve(lengthString);
         while (*sequenceUtf8)
         {
             std::size_t lengthChar = getNumBytesForUTF8(*sequenceUtf8);
@@ -731,6 +731,19 @@ void Mat4::multiply(const Mat4& m1, const Mat4& m2, Mat4* dst)
 #endif
 }
 
+void Mat4::multiply(const Mat4& m, const Mat4* matrices, Mat4* dst, size_t count)
+{
+    if (count == 0)
+        return;
+
+    GP_ASSERT(matrices && dst);
+#ifdef __SSE__
+    MathUtil::multiplyMatrices(m.col, matrices->col, dst->col, count);
+#else
+    MathUtil::multiplyMatrices(m.m, matrices->m, dst->m, count);
+#endif
+}
+
 void Mat4::negate()
 {
 #ifdef __SSE__
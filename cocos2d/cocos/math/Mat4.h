@@ -540,6 +540,18 @@ public:
      */
     static void multiply(const Mat4& m1, const Mat4& m2, Mat4* dst);
 
+    /**
+     * Multiplies m by each matrix of an array, dst[i] gets the same value as multiply(m, matrices[i], &dst[i]).
+     * The x86 implementation computes two columns per instruction when the CPU supports AVX.
+     *
+     * @param m The first matrix to multiply.
+     * @param matrices The matrices to multiply m by.
+     * @param dst The matrices to store the results in, it may be matrices.
+     * @param count The number of matrices.
+     * @since v3.17
+     */
+    static void multiply(const Mat4& m, const Mat4* matrices, Mat4* dst, size_t count);
+
     /**
      * Negates this matrix.
      */
@@ -32,6 +32,7 @@ This file was modified to fit the cocos2d-x project
 //#define INCLUDE_NEON64    : neon 64 code included
 //#define USE_SSE           : SSE code used
 //#define INCLUDE_SSE       : SSE code included
+//#define INCLUDE_AVX       : AVX code included, used when the CPU supports it
 
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_IOS)
     #if defined (__arm64__)
@@ -59,6 +60,12 @@ This file was modified to fit the cocos2d-x project
 #define INCLUDE_SSE
 #endif
 
+#if defined (INCLUDE_SSE) && (defined (__GNUC__) || defined (__clang__)) && (defined (__x86_64__) || defined (__i386__))
+#define INCLUDE_AVX
+#include <immintrin.h>
+#define CC_TARGET_AVX __attribute__((target("avx")))
+#endif
+
 #ifdef INCLUDE_NEON32
 #include "math/MathUtilNeon.inl"
 #endif
@@ -71,6 +78,10 @@ This file was modified to fit the cocos2d-x project
 #include "math/MathUtilSSE.inl"
 #endif
 
+#ifdef INCLUDE_AVX
+#include "math/MathUtilAVX.inl"
+#endif
+
 #include "math/MathUtil.inl"
 
 NS_CC_MATH_BEGIN
@@ -136,6 +147,19 @@ bool MathUtil::isNeon64Enabled()
 #endif
 }
 
+bool MathUtil::isAVXEnabled()
+{
+#ifdef INCLUDE_AVX
+    static const bool enabled = []() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx") != 0;
+    }();
+    return enabled;
+#else
+    return false;
+#endif
+}
+
 void MathUtil::addMatrix(const float* m, float scalar, float* dst)
 {
 #ifdef USE_NEON32
@@ -206,6 +230,31 @@ void MathUtil::multiplyMatrix(const float* m1, const float* m2, float* dst)
 #endif
 }
 
+void MathUtil::multiplyMatrices(const float* m, const float* matrices, float* dst, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m, matrices + i * 16, dst + i * 16);
+    }
+}
+
+#ifdef __SSE__
+void MathUtil::multiplyMatrices(const __m128 m[4], const __m128* matrices, __m128* dst, size_t count)
+{
+#ifdef INCLUDE_AVX
+    if (isAVXEnabled())
+    {
+        MathUtilAVX::multiplyMatrices(reinterpret_cast<const float*>(m), reinterpret_cast<const float*>(matrices), reinterpret_cast<float*>(dst), count);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < count; ++i)
+    {
+        multiplyMatrix(m, matrices + i * 4, dst + i * 4);
+    }
+}
+#endif
+
 void MathUtil::negateMatrix(const float* m, float* dst)
 {
 #ifdef USE_NEON32
@@ -92,6 +92,8 @@ private:
     //Indicates that if neon is enabled
     static bool isNeon32Enabled();
     static bool isNeon64Enabled();
+    //Indicates that if the CPU supports AVX, checked at runtime
+    static bool isAVXEnabled();
 private:
 #ifdef __SSE__
     static void addMatrix(const __m128 m[4], float scalar, __m128 dst[4]);
@@ -103,6 +105,8 @@ private:
     static void multiplyMatrix(const __m128 m[4], float scalar, __m128 dst[4]);
     
     static void multiplyMatrix(const __m128 m1[4], const __m128 m2[4], __m128 dst[4]);
+
+    static void multiplyMatrices(const __m128 m[4], const __m128* matrices, __m128* dst, size_t count);
     
     static void negateMatrix(const __m128 m[4], __m128 dst[4]);
     
@@ -120,6 +124,8 @@ private:
 
     static void multiplyMatrix(const float* m1, const float* m2, float* dst);
 
+    static void multiplyMatrices(const float* m, const float* matrices, float* dst, size_t count);
+
     static void negateMatrix(const float* m, float* dst);
 
     static void transposeMatrix(const float* m, float* dst);
@@ -0,0 +1,60 @@
+/****************************************************************************
+ Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+ http://www.cocos2d-x.org
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ ****************************************************************************/
+
+NS_CC_MATH_BEGIN
+
+// Only called when MathUtil::isAVXEnabled() returns true.
+class MathUtilAVX
+{
+public:
+    // dst[i] = m * matrices[i], rounded like the SSE multiplyMatrix: no FMA, same order of the additions
+    CC_TARGET_AVX inline static void multiplyMatrices(const float* m, const float* matrices, float* dst, size_t count);
+};
+
+CC_TARGET_AVX inline void MathUtilAVX::multiplyMatrices(const float* m, const float* matrices, float* dst, size_t count)
+{
+    // each column of m in both halves, a 256 bits register computes two columns of the result
+    __m256 c0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m));
+    __m256 c1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 4));
+    __m256 c2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 8));
+    __m256 c3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m + 12));
+
+    for (size_t i = 0; i < count; ++i, matrices += 16, dst += 16)
+    {
+        for (int half = 0; half < 16; half += 8)
+        {
+            __m256 cols = _mm256_loadu_ps(matrices + half);
+            __m256 e0 = _mm256_permute_ps(cols, _MM_SHUFFLE(0, 0, 0, 0));
+            __m256 e1 = _mm256_permute_ps(cols, _MM_SHUFFLE(1, 1, 1, 1));
+            __m256 e2 = _mm256_permute_ps(cols, _MM_SHUFFLE(2, 2, 2, 2));
+            __m256 e3 = _mm256_permute_ps(cols, _MM_SHUFFLE(3, 3, 3, 3));
+
+            __m256 a0 = _mm256_add_ps(_mm256_mul_ps(c0, e0), _mm256_mul_ps(c1, e1));
+            __m256 a1 = _mm256_add_ps(_mm256_mul_ps(c2, e2), _mm256_mul_ps(c3, e3));
+            _mm256_storeu_ps(dst + half, _mm256_add_ps(a0, a1));
+        }
+    }
+}
+
+NS_CC_MATH_END
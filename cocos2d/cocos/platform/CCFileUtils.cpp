@@ -27,10 +27,12 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 
 #include <stack>
+#include <algorithm>
 
 #include "base/CCData.h"
 #include "base/ccMacros.h"
 #include "base/CCDirector.h"
+#include "base/CCAssetPack.h"
 #include "platform/CCSAXParser.h"
 //#include "base/ccUtils.h"
 
@@ -394,6 +396,8 @@ bool FileUtils::writeValueMapToFile(const ValueMap& dict, const std::string& ful
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+        _fullPathCache.clear(true);
 
     delete doc;
     return ret;
@@ -434,6 +438,8 @@ bool FileUtils::writeValueVectorToFile(const ValueVector& vecData, const std::st
     rootEle->LinkEndChild(innerDict);
 
     bool ret = tinyxml2::XML_SUCCESS == doc->SaveFile(getSuitableFOpen(fullPath).c_str());
+    if (ret)
+        _fullPathCache.clear(true);
 
     delete doc;
     return ret;
@@ -535,29 +541,119 @@ bool FileUtils::writeToFile(const ValueMap& /*dict*/, const std::string &/*fullP
 
 #endif /* (CC_TARGET_PLATFORM != CC_PLATFORM_IOS) && (CC_TARGET_PLATFORM != CC_PLATFORM_MAC) */
 
+ValueDocument FileUtils::getValueDocumentFromFile(const std::string& filename)
+{
+    ValueDocument document;
+    Data data = getDataFromFile(filename);
+    if (!data.isNull())
+    {
+        document.initWithPlistData((const char*)data.getBytes(), data.getSize());
+    }
+    return document;
+}
+
 // Implement FileUtils
 FileUtils* FileUtils::s_sharedFileUtils = nullptr;
 
 void FileUtils::destroyInstance()
 {
+    // the I/O threads call the instance, they are joined before its destructors run
+    if (s_sharedFileUtils)
+        CC_SAFE_DELETE(s_sharedFileUtils->_ioPool);
     CC_SAFE_DELETE(s_sharedFileUtils);
 }
 
 void FileUtils::setDelegate(FileUtils *delegate)
 {
     if (s_sharedFileUtils)
+    {
+        CC_SAFE_DELETE(s_sharedFileUtils->_ioPool);
         delete s_sharedFileUtils;
+    }
 
     s_sharedFileUtils = delegate;
 }
 
+FullPathCache::FullPathCache()
+: _generation(0)
+{
+}
+
+FullPathCache::tShard& FullPathCache::getShard(const std::string& path) const
+{
+    return _shards[std::hash<std::string>()(path) % SHARD_COUNT];
+}
+
+bool FullPathCache::find(const std::string& path, std::string* fullPath) const
+{
+    auto& shard = getShard(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto iter = shard.paths.find(path);
+    if (iter == shard.paths.end())
+        return false;
+
+    *fullPath = iter->second;
+    return true;
+}
+
+void FullPathCache::emplace(const std::string& path, const std::string& fullPath, unsigned int generation)
+{
+    auto& shard = getShard(path);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // clear increases the generation before emptying the shards
+    if (_generation.load(std::memory_order_acquire) == generation)
+        shard.paths.emplace(path, fullPath);
+}
+
+void FullPathCache::clear(bool missesOnly)
+{
+    // also for the misses, a lookup running may have found the file missing before it was created
+    _generation.fetch_add(1, std::memory_order_acq_rel);
+
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (!missesOnly)
+        {
+            shard.paths.clear();
+            continue;
+        }
+        for (auto iter = shard.paths.begin(); iter != shard.paths.end();)
+        {
+            if (iter->second.empty())
+                iter = shard.paths.erase(iter);
+            else
+                ++iter;
+        }
+    }
+}
+
+std::unordered_map<std::string, std::string> FullPathCache::getEntries() const
+{
+    std::unordered_map<std::string, std::string> entries;
+    for (auto& shard : _shards)
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        entries.insert(shard.paths.begin(), shard.paths.end());
+    }
+    return entries;
+}
+
 FileUtils::FileUtils()
-    : _writablePath("")
+    : _ioPool(nullptr)
+    , _writablePath("")
 {
 }
 
 FileUtils::~FileUtils()
 {
+    // the running requests use the caches and the packs
+    delete _ioPool;
+
+    for (auto& pack : _packs)
+    {
+        delete pack.second;
+    }
 }
 
 bool FileUtils::writeStringToFile(const std::string& dataStr, const std::string& fullPath)
@@ -573,9 +669,9 @@ bool FileUtils::writeStringToFile(const std::string& dataStr, const std::string&
 
 void FileUtils::writeStringToFile(std::string dataStr, const std::string& fullPath, std::function<void(bool)> callback)
 {
-    performOperationOffthread([fullPath](const std::string& dataStrIn) -> bool {
-        return FileUtils::getInstance()->writeStringToFile(dataStrIn, fullPath);
-    }, std::move(callback),std::move(dataStr));
+    Data data;
+    data.copy((const unsigned char*)dataStr.c_str(), dataStr.size());
+    writeDataAsync(std::move(data), fullPath, std::move(callback));
 }
 
 bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath)
@@ -596,6 +692,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath)
         fwrite(data.getBytes(), size, 1, fp);
 
         fclose(fp);
+        fileutils->_fullPathCache.clear(true);
 
         return true;
     } while (0);
@@ -605,9 +702,7 @@ bool FileUtils::writeDataToFile(const Data& data, const std::string& fullPath)
 
 void FileUtils::writeDataToFile(Data data, const std::string& fullPath, std::function<void(bool)> callback)
 {
-    performOperationOffthread([fullPath](const Data& dataIn) -> bool {
-        return FileUtils::getInstance()->writeDataToFile(dataIn, fullPath);
-    }, std::move(callback), std::move(data));
+    writeDataAsync(std::move(data), fullPath, std::move(callback));
 }
 
 bool FileUtils::init()
@@ -631,12 +726,7 @@ std::string FileUtils::getStringFromFile(const std::string& filename)
 
 void FileUtils::getStringFromFile(const std::string &path, std::function<void (std::string)> callback)
 {
-    // Get the full path on the main thread, to avoid the issue that FileUtil's is not
-    // thread safe, and accessing the fullPath cache and searching the search paths is not thread safe
-    auto fullPath = fullPathForFilename(path);
-    performOperationOffthread([fullPath]() -> std::string {
-        return FileUtils::getInstance()->getStringFromFile(fullPath);
-    }, std::move(callback));
+    readStringAsync(path, std::move(callback));
 }
 
 Data FileUtils::getDataFromFile(const std::string& filename)
@@ -648,10 +738,92 @@ Data FileUtils::getDataFromFile(const std::string& filename)
 
 void FileUtils::getDataFromFile(const std::string& filename, std::function<void(Data)> callback)
 {
-    auto fullPath = fullPathForFilename(filename);
-    performOperationOffthread([fullPath]() -> Data {
-        return FileUtils::getInstance()->getDataFromFile(fullPath);
-    }, std::move(callback));
+    readDataAsync(filename, std::move(callback));
+}
+
+Data FileUtils::getMappedDataFromFile(const std::string& filename)
+{
+    if (!_packs.empty())
+    {
+        // the stored files of the packs are used in place
+        std::string entry;
+        AssetPack* pack = getPackForPath(fullPathForFilename(filename), &entry);
+        ssize_t size = 0;
+        unsigned char* bytes = pack ? pack->getMappedData(entry, &size) : nullptr;
+        if (bytes)
+        {
+            Data d;
+            d.borrow(bytes, size);
+            return d;
+        }
+    }
+    return getDataFromFile(filename);
+}
+
+FileIOPool* FileUtils::getIOPool()
+{
+    std::call_once(_ioPoolCreated, [this]() {
+        _ioPool = new (std::nothrow) FileIOPool();
+    });
+    return _ioPool;
+}
+
+unsigned int FileUtils::readDataAsync(const std::string& filename, std::function<void(Data)> callback, FileIOPool::Priority priority)
+{
+    // the search paths are only read on the calling thread
+    return getIOPool()->read(fullPathForFilename(filename), priority, [callback](Data& data, bool last) -> std::function<void()> {
+        auto result = std::make_shared<Data>();
+        if (last)
+            *result = std::move(data);
+        else
+            *result = data;
+        return [callback, result]() {
+            callback(std::move(*result));
+        };
+    });
+}
+
+unsigned int FileUtils::readStringAsync(const std::string& filename, std::function<void(std::string)> callback, FileIOPool::Priority priority)
+{
+    return getIOPool()->read(fullPathForFilename(filename), priority, [callback](Data& data, bool /*last*/) -> std::function<void()> {
+        auto result = std::make_shared<std::string>((const char*)data.getBytes(), data.getSize());
+        return [callback, result]() {
+            callback(std::move(*result));
+        };
+    });
+}
+
+unsigned int FileUtils::readValueMapAsync(const std::string& filename, std::function<void(ValueMap)> callback, FileIOPool::Priority priority)
+{
+    return getIOPool()->read(fullPathForFilename(filename), priority, [this, callback](Data& data, bool /*last*/) -> std::function<void()> {
+        auto result = std::make_shared<ValueMap>();
+        if (!data.isNull())
+            *result = getValueMapFromData((const char*)data.getBytes(), (int)data.getSize());
+        return [callback, result]() {
+            callback(std::move(*result));
+        };
+    });
+}
+
+unsigned int FileUtils::writeDataAsync(Data data, const std::string& fullPath, std::function<void(bool)> callback, FileIOPool::Priority priority)
+{
+    return getIOPool()->write(fullPath, std::move(data), priority, std::move(callback));
+}
+
+bool FileUtils::cancelAsyncRequest(unsigned int requestId)
+{
+    return getIOPool()->cancel(requestId);
+}
+
+void FileUtils::prefetchFiles(const std::vector<std::string>& filenames)
+{
+    auto pool = getIOPool();
+    for (const auto& filename : filenames)
+    {
+        std::string fullPath = fullPathForFilename(filename);
+        if (!fullPath.empty())
+            pool->prefetch(fullPath);
+    }
 }
 
 FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableBuffer* buffer)
@@ -665,6 +837,10 @@ FileUtils::Status FileUtils::getContents(const std::string& filename, ResizableB
     if (fullPath.empty())
         return Status::NotExists;
 
+    std::string entry;
+    if (AssetPack* pack = fs->getPackForPath(fullPath, &entry))
+        return pack->getContents(entry, buffer);
+
     FILE *fp = fopen(fs->getSuitableFOpen(fullPath).c_str(), "rb");
     if (!fp)
         return Status::OpenFailed;
@@ -806,6 +982,19 @@ std::string FileUtils::getPathForFilename(const std::string& filename, const std
     return path;
 }
 
+// the path of a file in a pack, as getPathForFilename builds it in a directory
+static std::string getPackEntryPath(const std::string& filename, const std::string& resolutionDirectory)
+{
+    size_t pos = filename.find_last_of("/");
+    if (pos == std::string::npos)
+        return resolutionDirectory + filename;
+
+    std::string path = filename.substr(0, pos + 1);
+    path += resolutionDirectory;
+    path += filename.substr(pos + 1);
+    return path;
+}
+
 std::string FileUtils::fullPathForFilename(const std::string &filename) const
 {
     if (filename.empty())
@@ -818,12 +1007,13 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
         return filename;
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(filename);
-    if(cacheIter != _fullPathCache.end())
+    // Already Cached ? The missing files are cached too
+    std::string cachedPath;
+    if (_fullPathCache.find(filename, &cachedPath))
     {
-        return cacheIter->second;
+        return cachedPath;
     }
+    unsigned int cacheGeneration = _fullPathCache.getGeneration();
 
     // Get the new file name.
     const std::string newFilename( getNewFilename(filename) );
@@ -832,6 +1022,23 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
 
     for (const auto& searchIt : _searchPathArray)
     {
+        // the mounted packs are searched in their index only
+        auto packIter = _packs.empty() ? _packs.end() : _packs.find(searchIt);
+        if (packIter != _packs.end())
+        {
+            for (const auto& resolutionIt : _searchResolutionsOrderArray)
+            {
+                std::string entry = getPackEntryPath(newFilename, resolutionIt);
+                if (packIter->second->fileExists(entry))
+                {
+                    fullpath = searchIt + entry;
+                    _fullPathCache.emplace(filename, fullpath, cacheGeneration);
+                    return fullpath;
+                }
+            }
+            continue;
+        }
+
         for (const auto& resolutionIt : _searchResolutionsOrderArray)
         {
             fullpath = this->getPathForFilename(newFilename, resolutionIt, searchIt);
@@ -839,13 +1046,16 @@ std::string FileUtils::fullPathForFilename(const std::string &filename) const
             if (!fullpath.empty())
             {
                 // Using the filename passed in as key.
-                _fullPathCache.emplace(filename, fullpath);
+                _fullPathCache.emplace(filename, fullpath, cacheGeneration);
                 return fullpath;
             }
 
         }
     }
 
+    // the next lookups of the missing file don't probe the search paths again
+    _fullPathCache.emplace(filename, "", cacheGeneration);
+
     if(isPopupNotify()){
         CCLOG("cocos2d: fullPathForFilename: No file found at %s. Possible missing file.", filename.c_str());
     }
@@ -898,6 +1108,8 @@ void FileUtils::addSearchResolutionsOrder(const std::string &order,const bool fr
     if (!resOrder.empty() && resOrder[resOrder.length()-1] != '/')
         resOrder.append("/");
 
+    _fullPathCache.clear(!front);
+
     if (front) {
         _searchResolutionsOrderArray.insert(_searchResolutionsOrderArray.begin(), resOrder);
     } else {
@@ -994,6 +1206,9 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
         path += "/";
     }
 
+    // the cached misses may be in the new path, and in front of it the found files too
+    _fullPathCache.clear(!front);
+
     if (front) {
         _originalSearchPaths.insert(_originalSearchPaths.begin(), searchpath);
         _searchPathArray.insert(_searchPathArray.begin(), path);
@@ -1003,6 +1218,65 @@ void FileUtils::addSearchPath(const std::string &searchpath,const bool front)
     }
 }
 
+bool FileUtils::mountPack(const std::string& packPath, const bool front)
+{
+    std::string fullPath = fullPathForFilename(packPath);
+    if (fullPath.empty())
+        return false;
+
+    std::string mountPoint = fullPath + '/';
+    if (_packs.find(mountPoint) != _packs.end())
+        return true;
+
+    auto pack = new (std::nothrow) AssetPack();
+    if (!pack || !pack->open(fullPath))
+    {
+        delete pack;
+        return false;
+    }
+
+    _packs.emplace(mountPoint, pack);
+    _fullPathCache.clear();
+    if (front) {
+        _originalSearchPaths.insert(_originalSearchPaths.begin(), mountPoint);
+        _searchPathArray.insert(_searchPathArray.begin(), mountPoint);
+    } else {
+        _originalSearchPaths.push_back(mountPoint);
+        _searchPathArray.push_back(mountPoint);
+    }
+    return true;
+}
+
+void FileUtils::unmountPack(const std::string& packPath)
+{
+    std::string fullPath = isAbsolutePath(packPath) ? packPath : fullPathForFilename(packPath);
+    auto iter = _packs.find(fullPath + '/');
+    if (iter == _packs.end())
+        return;
+
+    std::string mountPoint = iter->first;
+    delete iter->second;
+    _packs.erase(iter);
+
+    _fullPathCache.clear();
+    _originalSearchPaths.erase(std::remove(_originalSearchPaths.begin(), _originalSearchPaths.end(), mountPoint), _originalSearchPaths.end());
+    _searchPathArray.erase(std::remove(_searchPathArray.begin(), _searchPathArray.end(), mountPoint), _searchPathArray.end());
+}
+
+AssetPack* FileUtils::getPackForPath(const std::string& fullPath, std::string* entry) const
+{
+    for (const auto& pack : _packs)
+    {
+        const std::string& mountPoint = pack.first;
+        if (fullPath.size() > mountPoint.size() && fullPath.compare(0, mountPoint.size(), mountPoint) == 0)
+        {
+            *entry = fullPath.substr(mountPoint.size());
+            return pack.second;
+        }
+    }
+    return nullptr;
+}
+
 void FileUtils::setFilenameLookupDictionary(const ValueMap& filenameLookupDict)
 {
     _fullPathCache.clear();
@@ -1049,6 +1323,9 @@ bool FileUtils::isFileExist(const std::string& filename) const
 {
     if (isAbsolutePath(filename))
     {
+        std::string entry;
+        if (AssetPack* pack = getPackForPath(filename, &entry))
+            return pack->fileExists(entry);
         return isFileExistInternal(filename);
     }
     else
@@ -1083,12 +1360,13 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
         return isDirectoryExistInternal(dirPath);
     }
 
-    // Already Cached ?
-    auto cacheIter = _fullPathCache.find(dirPath);
-    if( cacheIter != _fullPathCache.end() )
+    // Already Cached ? A missing file of the same name doesn't tell about the directory
+    std::string cachedPath;
+    if (_fullPathCache.find(dirPath, &cachedPath) && !cachedPath.empty())
     {
-        return isDirectoryExistInternal(cacheIter->second);
+        return isDirectoryExistInternal(cachedPath);
     }
+    unsigned int cacheGeneration = _fullPathCache.getGeneration();
 
     std::string fullpath;
     for (const auto& searchIt : _searchPathArray)
@@ -1099,7 +1377,7 @@ bool FileUtils::isDirectoryExist(const std::string& dirPath) const
             fullpath = fullPathForFilename(searchIt + dirPath + resolutionIt);
             if (isDirectoryExistInternal(fullpath))
             {
-                _fullPathCache.emplace(dirPath, fullpath);
+                _fullPathCache.emplace(dirPath, fullpath, cacheGeneration);
                 return true;
             }
         }
@@ -1385,6 +1663,7 @@ bool FileUtils::renameFile(const std::string &oldfullpath, const std::string &ne
         CCLOGERROR("Fail to rename file %s to %s !Error code is %d", oldfullpath.c_str(), newfullpath.c_str(), errorCode);
         return false;
     }
+    _fullPathCache.clear(true);
     return true;
 }
 
@@ -1414,6 +1693,10 @@ long FileUtils::getFileSize(const std::string &filepath)
             return 0;
     }
 
+    std::string entry;
+    if (AssetPack* pack = getPackForPath(fullpath, &entry))
+        return pack->getFileSize(entry);
+
     struct stat info;
     // Get data associated with "crt_stat.c":
     int result = stat(fullpath.c_str(), &info);
@@ -30,12 +30,16 @@ THE SOFTWARE.
 #include <vector>
 #include <unordered_map>
 #include <type_traits>
+#include <atomic>
+#include <mutex>
 
 #include "platform/CCPlatformMacros.h"
 #include "base/ccTypes.h"
 #include "base/CCValue.h"
+#include "base/CCValueDocument.h"
 #include "base/CCData.h"
 #include "base/CCAsyncTaskPool.h"
+#include "base/CCFileIOPool.h"
 #include "base/CCScheduler.h"
 #include "base/CCDirector.h"
 
@@ -46,6 +50,57 @@ NS_CC_BEGIN
  * @{
  */
 
+class AssetPack;
+
+/**
+ * Cache of the full paths resolved by FileUtils, usable from any thread.
+ * The entries are split in shards locked separately, so the threads looking up different paths rarely wait.
+ * The missing files are cached with an empty path. FileUtils drops them when it writes, renames or creates files
+ * and directories, but a file created outside FileUtils, e.g. with fopen or by a downloader, stays cached as missing
+ * until FileUtils::purgeCachedEntries is called.
+ * @since v3.17
+ */
+class CC_DLL FullPathCache
+{
+public:
+    static const int SHARD_COUNT = 16;
+
+    FullPathCache();
+
+    /**
+     * Looks up a path.
+     * @param[out] fullPath The cached full path, empty for a missing file.
+     * @return True if the path is cached.
+     */
+    bool find(const std::string& path, std::string* fullPath) const;
+
+    /**
+     * Caches a path resolved since getGeneration returned generation, it is dropped if the cache was cleared since.
+     */
+    void emplace(const std::string& path, const std::string& fullPath, unsigned int generation);
+
+    /** Increased by each clear, to drop the paths resolved before it, e.g. with the previous search paths
+     *  or before a missing file was created. */
+    unsigned int getGeneration() const { return _generation.load(std::memory_order_acquire); }
+
+    /** Removes all the entries, or only the missing files. */
+    void clear(bool missesOnly = false);
+
+    /** Copies all the entries. */
+    std::unordered_map<std::string, std::string> getEntries() const;
+
+private:
+    typedef struct _shard
+    {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::string> paths;
+    } tShard;
+
+    tShard& getShard(const std::string& path) const;
+
+    mutable tShard _shards[SHARD_COUNT];
+    std::atomic<unsigned int> _generation;
+};
 
 class ResizableBuffer {
 public:
@@ -161,6 +216,7 @@ public:
 
     /**
      *  Purges full path caches.
+     *  The missing files are cached too, call it after writing files without FileUtils, e.g. with fopen.
      */
     virtual void purgeCachedEntries();
 
@@ -194,6 +250,75 @@ public:
      */
     virtual void getDataFromFile(const std::string& filename, std::function<void(Data)> callback);
 
+    /**
+     * Gets a file without copying it when it is stored uncompressed in a mounted pack (or in the obb file on Android),
+     * otherwise the same as getDataFromFile.
+     * @note The returned Data may be borrowed, see Data::borrow: its bytes are read-only, may be unaligned and are
+     *       only valid until the pack is unmounted. Use getDataFromFile to modify them in place.
+     *
+     * @param filename The file to read, relative or absolute.
+     * @return A data object, null if the file couldn't be read.
+     * @since v3.17
+     */
+    virtual Data getMappedDataFromFile(const std::string& filename);
+
+    /**
+     * Reads a file on the I/O threads, see FileIOPool for the ordering, the coalescing and the batched completions.
+     *
+     * @param filename The file to read, relative or absolute.
+     * @param callback Called on the cocos thread with the contents of the file, empty if it couldn't be read.
+     * @param priority The requests of higher priority run first.
+     * @return The id of the request, for cancelAsyncRequest.
+     * @since v3.17
+     */
+    unsigned int readDataAsync(const std::string& filename, std::function<void(Data)> callback,
+                               FileIOPool::Priority priority = FileIOPool::Priority::NORMAL);
+
+    /**
+     * Reads a file as a string on the I/O threads, see readDataAsync.
+     * @since v3.17
+     */
+    unsigned int readStringAsync(const std::string& filename, std::function<void(std::string)> callback,
+                                 FileIOPool::Priority priority = FileIOPool::Priority::NORMAL);
+
+    /**
+     * Reads and parses a plist file on the I/O threads, see readDataAsync.
+     * @since v3.17
+     */
+    unsigned int readValueMapAsync(const std::string& filename, std::function<void(ValueMap)> callback,
+                                   FileIOPool::Priority priority = FileIOPool::Priority::NORMAL);
+
+    /**
+     * Writes a file on the I/O threads, the waiting writes of a file are coalesced.
+     *
+     * @param callback Called on the cocos thread with whether the file was written, it can be empty.
+     * @return The id of the request, for cancelAsyncRequest.
+     * @since v3.17
+     */
+    unsigned int writeDataAsync(Data data, const std::string& fullPath, std::function<void(bool)> callback,
+                                FileIOPool::Priority priority = FileIOPool::Priority::NORMAL);
+
+    /**
+     * Cancels a request of readDataAsync, readStringAsync, readValueMapAsync or writeDataAsync, its callback isn't called.
+     * A write already running still writes its file.
+     * @return False if the request is unknown or its callback was already called.
+     * @since v3.17
+     */
+    bool cancelAsyncRequest(unsigned int requestId);
+
+    /**
+     * Hints the files which will be read next, e.g. the next assets of a sequential stream.
+     * They are read ahead at a low priority and kept in memory for their next read.
+     * @since v3.17
+     */
+    void prefetchFiles(const std::vector<std::string>& filenames);
+
+    /**
+     * Gets the threads running the asynchronous requests, they are created by the first request.
+     * @since v3.17
+     */
+    FileIOPool* getIOPool();
+
     enum class Status
     {
         OK = 0,
@@ -333,6 +458,8 @@ public:
              internal_dir/gamescene/uilayer/sprite.pvr.gz                      (if not found, return "gamescene/uilayer/sprite.png")
 
      If the new file can't be found on the file system, it will return the parameter filename directly.
+     The missing files are cached too: a file created afterwards without FileUtils, e.g. with fopen, isn't found
+     until purgeCachedEntries is called.
 
      This method was added to simplify multiplatform support. Whether you are using cocos2d-js or any cross-compilation toolchain like StellaSDK or Apportable,
      you might need to load different resources for a given file in the different platforms.
@@ -461,6 +588,27 @@ public:
       */
     void addSearchPath(const std::string & path, const bool front=false);
 
+    /**
+     * Mounts a read-only asset pack built by tools/asset-pack/ccpack.py and adds it to the search paths.
+     * The files in the pack are found by fullPathForFilename as "<pack full path>/<path in the pack>" without
+     * touching the disk, and read by getContents and getDataFromFile from the memory mapped pack, and by
+     * getMappedDataFromFile without copy for the stored ones. The pack can be listed in setSearchPaths while it is mounted.
+     * @note The files are only readable through FileUtils, e.g. not by the audio decoders opening them directly.
+     *
+     * @param packPath The path of the pack, which must not be inside another pack.
+     * @param front Whether the pack is searched before the other search paths, which avoids probing the disk.
+     * @return True if the pack was mounted.
+     * @since v3.17
+     */
+    virtual bool mountPack(const std::string& packPath, const bool front = true);
+
+    /**
+     * Removes a pack mounted by mountPack from the search paths and unmaps it.
+     * @note The Data returned by getMappedDataFromFile for the pack must not be used anymore, see Data::borrow.
+     * @since v3.17
+     */
+    virtual void unmountPack(const std::string& packPath);
+
     /**
      *  Gets the array of search paths.
      *
@@ -514,6 +662,14 @@ public:
      */
     virtual ValueMap getValueMapFromData(const char* filedata, int filesize);
 
+    /**
+     *  Parses a plist in a ValueDocument, faster to build and to destroy than a ValueMap for a large file.
+     *  @param filename The filename of the plist.
+     *  @return The document, empty if the file isn't a plist.
+     *  @since v3.17
+     */
+    virtual ValueDocument getValueDocumentFromFile(const std::string& filename);
+
     /**
     * write a ValueMap into a plist file
     *
@@ -841,8 +997,8 @@ public:
     */
     virtual void listFilesRecursivelyAsync(const std::string& dirPath, std::function<void(std::vector<std::string>)> callback) const;
 
-    /** Returns the full path cache. */
-    const std::unordered_map<std::string, std::string>& getFullPathCache() const { return _fullPathCache; }
+    /** Returns a copy of the full path cache, the missing files have an empty full path. */
+    std::unordered_map<std::string, std::string> getFullPathCache() const { return _fullPathCache.getEntries(); }
 
     /**
      *  Gets the new filename from the filename lookup dictionary.
@@ -854,6 +1010,13 @@ public:
     virtual std::string getNewFilename(const std::string &filename) const;
 
 protected:
+    /**
+     *  Gets the mounted pack containing a full path.
+     *  @param[out] entry The path of the file in the pack.
+     *  @return The pack, nullptr if the path isn't in a mounted pack.
+     */
+    AssetPack* getPackForPath(const std::string& fullPath, std::string* entry) const;
+
     /**
      *  The default constructor.
      */
@@ -941,10 +1104,21 @@ protected:
     std::string _defaultResRootPath;
 
     /**
-     *  The full path cache. When a file is found, it will be added into this cache.
-     *  This variable is used for improving the performance of file search.
+     *  The full path cache. When a file is looked up, found or not, it will be added into this cache.
+     *  This variable is used for improving the performance of file search, it can be used from any thread.
+     */
+    mutable FullPathCache _fullPathCache;
+
+    /**
+     *  The mounted asset packs, by their search path ending with '/'.
+     */
+    std::unordered_map<std::string, AssetPack*> _packs;
+
+    /**
+     *  The threads of the asynchronous requests.
      */
-    mutable std::unordered_map<std::string, std::string> _fullPathCache;
+    FileIOPool* _ioPool;
+    std::once_flag _ioPoolCreated;
 
     /**
      * Writable path.
@@ -108,7 +108,9 @@ extern "C"
 #include "platform/CCFileUtils.h"
 #include "base/CCConfiguration.h"
 #include "base/ccUtils.h"
+#include "base/ccPixelUtils.h"
 #include "base/ZipUtils.h"
+#include "base/CCTracing.h"
 #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
 #include "platform/android/CCFileUtils-android.h"
 #endif
@@ -538,6 +540,7 @@ bool Image::initWithImageFileThreadSafe(const std::string& fullpath)
 
 bool Image::initWithImageData(const unsigned char * data, ssize_t dataLen)
 {
+    CC_TRACE_SCOPE("Image::initWithImageData");
     bool ret = false;
     
     do
@@ -2453,12 +2456,7 @@ void Image::premultipliedAlpha()
 #else
     CCASSERT(_renderFormat == Texture2D::PixelFormat::RGBA8888, "The pixel format should be RGBA8888!");
     
-    unsigned int* fourBytes = (unsigned int*)_data;
-    for(int i = 0; i < _width * _height; i++)
-    {
-        unsigned char* p = _data + i * 4;
-        fourBytes[i] = CC_RGB_PREMULTIPLY_ALPHA(p[0], p[1], p[2], p[3]);
-    }
+    PixelUtils::premultiplyAlpha(_data, static_cast<ssize_t>(_width) * _height);
     
     _hasPremultipliedAlpha = true;
 #endif
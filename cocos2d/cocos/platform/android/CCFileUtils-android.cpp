@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "android/asset_manager.h"
 #include "android/asset_manager_jni.h"
 #include "base/ZipUtils.h"
+#include "base/CCAssetPack.h"
 
 #include <stdlib.h>
 #include <sys/stat.h>
@@ -280,6 +281,31 @@ long FileUtilsAndroid::getFileSize(const std::string& filepath)
     return size;
 }
 
+Data FileUtilsAndroid::getMappedDataFromFile(const std::string& filename)
+{
+    static const std::string apkprefix("assets/");
+    if (obbfile && !filename.empty())
+    {
+        // the files stored in the obb file are used in place
+        std::string fullPath = fullPathForFilename(filename);
+        std::string entry;
+        if (!fullPath.empty() && fullPath[0] != '/' && !getPackForPath(fullPath, &entry))
+        {
+            std::string relativePath = fullPath.compare(0, apkprefix.size(), apkprefix) == 0 ? fullPath.substr(apkprefix.size()) : fullPath;
+            ssize_t size = 0;
+            unsigned char* bytes = obbfile->getMappedData(relativePath, &size);
+            if (bytes)
+            {
+                EngineDataManager::onBeforeReadFile();
+                Data d;
+                d.borrow(bytes, size);
+                return d;
+            }
+        }
+    }
+    return FileUtils::getMappedDataFromFile(filename);
+}
+
 FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, ResizableBuffer* buffer)
 {
     EngineDataManager::onBeforeReadFile();
@@ -290,6 +316,10 @@ FileUtils::Status FileUtilsAndroid::getContents(const std::string& filename, Res
 
     string fullPath = fullPathForFilename(filename);
 
+    string entry;
+    if (AssetPack* pack = getPackForPath(fullPath, &entry))
+        return pack->getContents(entry, buffer);
+
     if (fullPath[0] == '/')
         return FileUtils::getContents(fullPath, buffer);
 
@@ -28,6 +28,7 @@ import android.content.Context;
 import android.database.Cursor;
 import android.database.sqlite.SQLiteDatabase;
 import android.database.sqlite.SQLiteOpenHelper;
+import android.os.Build;
 import android.util.Log;
 
 
@@ -52,6 +53,10 @@ public class Cocos2dxLocalStorage {
             TABLE_NAME = tableName;
             mDatabaseOpenHelper = new DBOpenHelper(Cocos2dxActivity.getContext());
             mDatabase = mDatabaseOpenHelper.getWritableDatabase();
+            // a commit appends to the log instead of rewriting the pages and syncing the database
+            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.HONEYCOMB) {
+                mDatabase.enableWriteAheadLogging();
+            }
             return true;
         }
         return false;
@@ -102,6 +107,23 @@ public class Cocos2dxLocalStorage {
         }
     }
     
+    public static void beginBatch() {
+        try {
+            mDatabase.beginTransaction();
+        } catch (Exception e) {
+            e.printStackTrace();
+        }
+    }
+
+    public static void endBatch() {
+        try {
+            mDatabase.setTransactionSuccessful();
+            mDatabase.endTransaction();
+        } catch (Exception e) {
+            e.printStackTrace();
+        }
+    }
+
     public static void clear() {
         try {
             String sql = "delete from "+TABLE_NAME;
@@ -453,15 +453,21 @@ ValueVector FileUtilsApple::getValueVectorFromFile(const std::string& filename)
     //    pPath = [pPath stringByDeletingPathExtension];
     //    pPath = [[NSBundle mainBundle] pathForResource:pPath ofType:pathExtension];
     //    fixing cannot read data using Array::createWithContentsOfFile
-    std::string fullPath = fullPathForFilename(filename);
-    NSString* path = [NSString stringWithUTF8String:fullPath.c_str()];
-    NSArray* array = [NSArray arrayWithContentsOfFile:path];
+    // read with getContents, the file may be in an asset pack
+    auto d(FileUtils::getInstance()->getDataFromFile(filename));
+    NSData* file = [NSData dataWithBytes:d.getBytes() length:d.getSize()];
+    NSPropertyListFormat format;
+    NSError* error;
+    id plist = [NSPropertyListSerialization propertyListWithData:file options:NSPropertyListImmutable format:&format error:&error];
 
     ValueVector ret;
 
-    for (id value in array)
+    if ([plist isKindOfClass:[NSArray class]])
     {
-        addNSObjectToCCVector(value, ret);
+        for (id value in (NSArray*)plist)
+        {
+            addNSObjectToCCVector(value, ret);
+        }
     }
 
     return ret;
@@ -29,8 +29,9 @@ THE SOFTWARE.
 
 #include "platform/linux/CCApplication-linux.h"
 #include <unistd.h>
-#include <sys/time.h>
 #include <string>
+#include <chrono>
+#include <thread>
 #include "base/CCDirector.h"
 #include "base/ccUtils.h"
 #include "platform/CCFileUtils.h"
@@ -41,17 +42,24 @@ NS_CC_BEGIN
 // sharedApplication pointer
 Application * Application::sm_pSharedApplication = nullptr;
 
-static long getCurrentMillSecond() {
-    long lLastTime;
-    struct timeval stCurrentTime;
+// the end of the wait is spun, sleeping alone overshoots by up to a scheduler tick
+static const std::chrono::microseconds FRAME_WAIT_SPIN(1500);
 
-    gettimeofday(&stCurrentTime,NULL);
-    lLastTime = stCurrentTime.tv_sec*1000+stCurrentTime.tv_usec*0.001; // milliseconds
-    return lLastTime;
+static void waitUntil(const std::chrono::steady_clock::time_point& deadline)
+{
+    auto sleepDeadline = deadline - FRAME_WAIT_SPIN;
+    if (std::chrono::steady_clock::now() < sleepDeadline)
+    {
+        std::this_thread::sleep_until(sleepDeadline);
+    }
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::yield();
+    }
 }
 
 Application::Application()
-: _animationInterval(1.0f/60.0f*1000.0f)
+: _animationInterval(1.0f/60.0f*1000000.0f)
 {
     CC_ASSERT(! sm_pSharedApplication);
     sm_pSharedApplication = this;
@@ -72,26 +80,32 @@ int Application::run()
         return 0;
     }
 
-    long lastTime = 0L;
-    long curTime = 0L;
-
     auto director = Director::getInstance();
     auto glview = director->getOpenGLView();
 
     // Retain glview to avoid glview being released in the while loop
     glview->retain();
 
+    auto nextFrame = std::chrono::steady_clock::now();
     while (!glview->windowShouldClose())
     {
-        lastTime = getCurrentMillSecond();
-
         director->mainLoop();
         glview->pollEvents();
 
-        curTime = getCurrentMillSecond();
-        if (curTime - lastTime < _animationInterval)
+        long interval = director->isIdle() ? static_cast<long>(director->getIdleAnimationInterval() * 1000000.0f) : _animationInterval;
+        std::chrono::microseconds frameDuration(interval);
+
+        // the deadlines are kept a frame apart so that the frame rate doesn't drift,
+        // unless a frame is late by more than a frame
+        nextFrame += frameDuration;
+        auto now = std::chrono::steady_clock::now();
+        if (now - nextFrame > frameDuration)
+        {
+            nextFrame = now;
+        }
+        else
         {
-            usleep((_animationInterval - curTime + lastTime)*1000);
+            waitUntil(nextFrame);
         }
     }
     /* Only work on Desktop
@@ -111,8 +125,7 @@ int Application::run()
 
 void Application::setAnimationInterval(float interval)
 {
-    //TODO do something else
-    _animationInterval = interval*1000.0f;
+    _animationInterval = interval*1000000.0f;
 }
 
 void Application::setAnimationInterval(float interval, SetIntervalReason reason)
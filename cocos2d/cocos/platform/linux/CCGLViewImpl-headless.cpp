@@ -0,0 +1,313 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#include "platform/linux/CCGLViewImpl-headless.h"
+
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+// keep Xlib out, its macros clash with the engine names
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include "base/CCDirector.h"
+#include "platform/CCGL.h"
+#include "platform/CCImage.h"
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+
+// added in glew 2.0
+#ifndef GLEW_ERROR_NO_GLX_DISPLAY
+#define GLEW_ERROR_NO_GLX_DISPLAY 4
+#endif
+
+NS_CC_BEGIN
+
+static EGLDisplay getHeadlessDisplay()
+{
+    // The surfaceless platform needs neither X11 nor a DRM device, fall back to the default display otherwise.
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+    {
+        EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        if (display != EGL_NO_DISPLAY)
+            return display;
+    }
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+GLViewHeadless::GLViewHeadless()
+: _display(EGL_NO_DISPLAY)
+, _surface(EGL_NO_SURFACE)
+, _context(EGL_NO_CONTEXT)
+, _shouldClose(false)
+{
+}
+
+GLViewHeadless::~GLViewHeadless()
+{
+    CCLOGINFO("deallocing GLViewHeadless: %p", this);
+    destroyContext();
+}
+
+GLViewHeadless* GLViewHeadless::create(const std::string& viewName, const Size& size)
+{
+    auto ret = new (std::nothrow) GLViewHeadless;
+    if (ret && ret->initWithSize(viewName, size))
+    {
+        ret->autorelease();
+        return ret;
+    }
+    CC_SAFE_DELETE(ret);
+    return nullptr;
+}
+
+bool GLViewHeadless::initWithSize(const std::string& viewName, const Size& size)
+{
+    setViewName(viewName);
+
+    EGLDisplay display = getHeadlessDisplay();
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor))
+    {
+        CCLOG("GLViewHeadless: eglInitialize failed, error 0x%x", eglGetError());
+        return false;
+    }
+    _display = display;
+    CCLOG("GLViewHeadless: EGL %d.%d, %s", major, minor, eglQueryString(display, EGL_VENDOR));
+
+    if (!eglBindAPI(EGL_OPENGL_API))
+    {
+        CCLOG("GLViewHeadless: desktop OpenGL isn't supported by the EGL driver");
+        return false;
+    }
+
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, _glContextAttrs.redBits,
+        EGL_GREEN_SIZE, _glContextAttrs.greenBits,
+        EGL_BLUE_SIZE, _glContextAttrs.blueBits,
+        EGL_ALPHA_SIZE, _glContextAttrs.alphaBits,
+        EGL_DEPTH_SIZE, _glContextAttrs.depthBits,
+        EGL_STENCIL_SIZE, _glContextAttrs.stencilBits,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint numConfigs = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &numConfigs) || numConfigs < 1)
+    {
+        CCLOG("GLViewHeadless: no pbuffer config matches the GL context attributes");
+        return false;
+    }
+
+    const EGLint pbufferAttribs[] = {
+        EGL_WIDTH, (EGLint)size.width,
+        EGL_HEIGHT, (EGLint)size.height,
+        EGL_NONE
+    };
+    _surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+    if (_surface == EGL_NO_SURFACE)
+    {
+        CCLOG("GLViewHeadless: eglCreatePbufferSurface failed, error 0x%x", eglGetError());
+        return false;
+    }
+
+    _context = eglCreateContext(display, config, EGL_NO_CONTEXT, nullptr);
+    if (_context == EGL_NO_CONTEXT || !eglMakeCurrent(display, _surface, _surface, _context))
+    {
+        CCLOG("GLViewHeadless: can't create the GL context, error 0x%x", eglGetError());
+        return false;
+    }
+
+    // glew looks the entry points up through GLX, which has no display here; the ones it finds are enough
+    // with Mesa, which exports them from libGL whatever the window system.
+    glewExperimental = GL_TRUE;
+    GLenum glewError = glewInit();
+    if (glewError != GLEW_OK && glewError != GLEW_ERROR_NO_GLX_DISPLAY)
+    {
+        CCLOG("GLViewHeadless: glewInit failed, %s", (const char*)glewGetErrorString(glewError));
+        return false;
+    }
+
+    const char* glVersion = (const char*)glGetString(GL_VERSION);
+    if (!glVersion || std::atof(glVersion) < 1.5)
+    {
+        CCLOG("GLViewHeadless: OpenGL 1.5 or higher is required, got %s", glVersion ? glVersion : "none");
+        return false;
+    }
+    CCLOG("GLViewHeadless: %s, %s", glVersion, (const char*)glGetString(GL_RENDERER));
+
+    // Enable point size by default.
+    glEnable(GL_VERTEX_PROGRAM_POINT_SIZE);
+
+    setFrameSize(size.width, size.height);
+    return true;
+}
+
+void GLViewHeadless::destroyContext()
+{
+    if (_display == EGL_NO_DISPLAY)
+        return;
+
+    eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (_context != EGL_NO_CONTEXT)
+        eglDestroyContext(_display, _context);
+    if (_surface != EGL_NO_SURFACE)
+        eglDestroySurface(_display, _surface);
+    eglTerminate(_display);
+
+    _context = EGL_NO_CONTEXT;
+    _surface = EGL_NO_SURFACE;
+    _display = EGL_NO_DISPLAY;
+}
+
+bool GLViewHeadless::isOpenGLReady()
+{
+    return _context != EGL_NO_CONTEXT;
+}
+
+void GLViewHeadless::end()
+{
+    _shouldClose = true;
+    // Release self. Otherwise, GLViewHeadless could not be freed.
+    release();
+}
+
+void GLViewHeadless::swapBuffers()
+{
+    // A pbuffer is single buffered, wait for the frame so that its time includes the GPU work.
+    glFinish();
+}
+
+void GLViewHeadless::setIMEKeyboardState(bool /*open*/)
+{
+}
+
+bool GLViewHeadless::windowShouldClose()
+{
+    return _shouldClose;
+}
+
+void GLViewHeadless::pollEvents()
+{
+}
+
+void GLViewHeadless::stepFrames(int frames, float dt)
+{
+    auto director = Director::getInstance();
+    _frameTimes.reserve(_frameTimes.size() + std::max(frames, 0));
+
+    for (int i = 0; i < frames && !_shouldClose; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        director->mainLoop(dt);
+        auto end = std::chrono::steady_clock::now();
+        _frameTimes.push_back(std::chrono::duration<float>(end - start).count());
+    }
+}
+
+Image* GLViewHeadless::captureFrame()
+{
+    auto frameSize = getFrameSize();
+    int width = static_cast<int>(frameSize.width);
+    int height = static_cast<int>(frameSize.height);
+    if (!isOpenGLReady() || width <= 0 || height <= 0)
+        return nullptr;
+
+    ssize_t rowSize = width * 4;
+    ssize_t dataLen = rowSize * height;
+    unsigned char* buffer = (unsigned char*)malloc(dataLen);
+    unsigned char* flipped = (unsigned char*)malloc(dataLen);
+    Image* image = nullptr;
+
+    do
+    {
+        CC_BREAK_IF(!buffer || !flipped);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, buffer);
+
+        // GL rows start at the bottom
+        for (int row = 0; row < height; ++row)
+        {
+            memcpy(flipped + (height - row - 1) * rowSize, buffer + row * rowSize, rowSize);
+        }
+
+        image = new (std::nothrow) Image();
+        if (image && image->initWithRawData(flipped, dataLen, width, height, 8))
+        {
+            image->autorelease();
+        }
+        else
+        {
+            CC_SAFE_DELETE(image);
+        }
+    } while (0);
+
+    free(buffer);
+    free(flipped);
+    return image;
+}
+
+int GLViewHeadless::diffImages(Image* image, Image* reference, int tolerance)
+{
+    if (!image || !reference
+        || image->getWidth() != reference->getWidth()
+        || image->getHeight() != reference->getHeight()
+        || image->getRenderFormat() != Texture2D::PixelFormat::RGBA8888
+        || reference->getRenderFormat() != Texture2D::PixelFormat::RGBA8888)
+    {
+        return -1;
+    }
+
+    const unsigned char* a = image->getData();
+    const unsigned char* b = reference->getData();
+    ssize_t pixelCount = (ssize_t)image->getWidth() * image->getHeight();
+    int differences = 0;
+
+    for (ssize_t i = 0; i < pixelCount; ++i, a += 4, b += 4)
+    {
+        for (int c = 0; c < 4; ++c)
+        {
+            if (std::abs((int)a[c] - (int)b[c]) > tolerance)
+            {
+                ++differences;
+                break;
+            }
+        }
+    }
+    return differences;
+}
+
+NS_CC_END
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
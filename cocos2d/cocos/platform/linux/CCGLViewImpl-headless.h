@@ -0,0 +1,106 @@
+/****************************************************************************
+Copyright (c) 2017-2018 Xiamen Yaji Software Co., Ltd.
+
+http://www.cocos2d-x.org
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+****************************************************************************/
+
+#ifndef __CC_GLVIEW_IMPL_HEADLESS_H__
+#define __CC_GLVIEW_IMPL_HEADLESS_H__
+
+#include "platform/CCPlatformConfig.h"
+#if CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#include <vector>
+
+#include "base/CCRef.h"
+#include "platform/CCCommon.h"
+#include "platform/CCGLView.h"
+
+NS_CC_BEGIN
+
+class Image;
+
+/** @brief GLView rendering into an EGL pbuffer, without window nor display.
+ * It runs on GPU-less servers with a software EGL driver (e.g. Mesa llvmpipe), for frame-time
+ * benchmarks and golden-image tests. The frames are stepped by the caller with a fixed delta time.
+ * Enabled with the USE_HEADLESS_GLVIEW cmake option.
+ */
+class CC_DLL GLViewHeadless : public GLView
+{
+public:
+    /** Creates an offscreen view of the given size in pixels. */
+    static GLViewHeadless* create(const std::string& viewName, const Size& size);
+
+    /* override functions */
+    virtual bool isOpenGLReady() override;
+    virtual void end() override;
+    virtual void swapBuffers() override;
+    virtual void setIMEKeyboardState(bool open) override;
+    virtual bool windowShouldClose() override;
+    virtual void pollEvents() override;
+
+    /** Runs frames through Director::mainLoop with a fixed delta time.
+     * The wall time of each frame, GPU included, is appended to the frame times.
+     * @param frames Number of frames to run.
+     * @param dt The delta time given to the scheduler, in seconds.
+     */
+    void stepFrames(int frames, float dt);
+
+    /** The wall time of the frames run by stepFrames, in seconds. */
+    const std::vector<float>& getFrameTimes() const { return _frameTimes; }
+    void clearFrameTimes() { _frameTimes.clear(); }
+
+    /** Reads back the last rendered frame.
+     * @return An autoreleased RGBA8888 image, top row first like utils::captureScreen, or nullptr on error.
+     */
+    Image* captureFrame();
+
+    /** Compares two RGBA8888 images of the same size.
+     * @param tolerance The largest difference allowed per channel.
+     * @return The number of pixels with a channel differing by more than tolerance, -1 if the images can't be compared.
+     */
+    static int diffImages(Image* image, Image* reference, int tolerance);
+
+    /** Makes windowShouldClose return true, so that Application::run returns. */
+    void setShouldClose(bool shouldClose) { _shouldClose = shouldClose; }
+
+CC_CONSTRUCTOR_ACCESS:
+    GLViewHeadless();
+    virtual ~GLViewHeadless();
+
+    bool initWithSize(const std::string& viewName, const Size& size);
+
+protected:
+    void destroyContext();
+
+    // EGLDisplay, EGLSurface and EGLContext, kept opaque to not leak the EGL headers
+    void* _display;
+    void* _surface;
+    void* _context;
+    bool _shouldClose;
+    std::vector<float> _frameTimes;
+};
+
+NS_CC_END
+
+#endif // CC_TARGET_PLATFORM == CC_PLATFORM_LINUX
+
+#endif  // __CC_GLVIEW_IMPL_HEADLESS_H__
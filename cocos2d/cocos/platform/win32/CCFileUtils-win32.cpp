@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "platform/win32/CCFileUtils-win32.h"
 #include "platform/win32/CCUtils-win32.h"
 #include "platform/CCCommon.h"
+#include "base/CCAssetPack.h"
 #include "tinydir/tinydir.h"
 #include <Shlobj.h>
 #include <cstdlib>
@@ -123,6 +124,10 @@ std::string FileUtilsWin32::getSuitableFOpen(const std::string& filenameUtf8) co
 
 long FileUtilsWin32::getFileSize(const std::string &filepath)
 {
+    std::string entry;
+    if (AssetPack* pack = getPackForPath(filepath, &entry))
+        return pack->getFileSize(entry);
+
     WIN32_FILE_ATTRIBUTE_DATA fad;
     if (!GetFileAttributesEx(StringUtf8ToWideChar(filepath).c_str(), GetFileExInfoStandard, &fad))
     {
@@ -173,6 +178,10 @@ FileUtils::Status FileUtilsWin32::getContents(const std::string& filename, Resiz
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    std::string entry;
+    if (AssetPack* pack = getPackForPath(fullPath, &entry))
+        return pack->getContents(entry, buffer);
+
     HANDLE fileHandle = ::CreateFile(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, NULL, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -367,16 +376,10 @@ bool FileUtilsWin32::renameFile(const std::string &oldfullpath, const std::strin
     std::wstring _wNew = StringUtf8ToWideChar(newfullpath);
     std::wstring _wOld = StringUtf8ToWideChar(oldfullpath);
 
-    if (FileUtils::getInstance()->isFileExist(newfullpath))
-    {
-        if (!DeleteFile(_wNew.c_str()))
-        {
-            CCLOGERROR("Fail to delete file %s !Error code is 0x%x", newfullpath.c_str(), GetLastError());
-        }
-    }
-
-    if (MoveFile(_wOld.c_str(), _wNew.c_str()))
+    // replaces an existing file at once, e.g. a file written to a temporary file first
+    if (MoveFileEx(_wOld.c_str(), _wNew.c_str(), MOVEFILE_REPLACE_EXISTING))
     {
+        _fullPathCache.clear(true);
         return true;
     }
     else
@@ -27,6 +27,7 @@ THE SOFTWARE.
 #include <regex>
 #include "platform/winrt/CCWinRTUtils.h"
 #include "platform/CCCommon.h"
+#include "base/CCAssetPack.h"
 #include "tinydir/tinydir.h"
 using namespace std;
 
@@ -133,6 +134,10 @@ std::string CCFileUtilsWinRT::getSuitableFOpen(const std::string& filenameUtf8)
 
 long CCFileUtilsWinRT::getFileSize(const std::string &filepath)
 {
+    std::string entry;
+    if (AssetPack* pack = getPackForPath(filepath, &entry))
+        return pack->getFileSize(entry);
+
     WIN32_FILE_ATTRIBUTE_DATA fad;
     if (!GetFileAttributesEx(StringUtf8ToWideChar(filepath).c_str(), GetFileExInfoStandard, &fad))
     {
@@ -152,6 +157,10 @@ FileUtils::Status CCFileUtilsWinRT::getContents(const std::string& filename, Res
     // read the file from hardware
     std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
 
+    std::string entry;
+    if (AssetPack* pack = getPackForPath(fullPath, &entry))
+        return pack->getContents(entry, buffer);
+
     HANDLE fileHandle = ::CreateFile2(StringUtf8ToWideChar(fullPath).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, OPEN_EXISTING, nullptr);
     if (fileHandle == INVALID_HANDLE_VALUE)
         return FileUtils::Status::OpenFailed;
@@ -343,16 +352,9 @@ bool CCFileUtilsWinRT::renameFile(const std::string &oldfullpath, const std::str
 
     std::wstring _wNewfullpath = StringUtf8ToWideChar(_newfullpath);
 
-    if (FileUtils::getInstance()->isFileExist(_newfullpath))
-    {
-        if (!DeleteFile(_wNewfullpath.c_str()))
-        {
-            CCLOGERROR("Fail to delete file %s !Error code is 0x%x", newfullpath.c_str(), GetLastError());
-        }
-    }
-
+    // replaces an existing file at once, e.g. a file written to a temporary file first
     if (MoveFileEx(StringUtf8ToWideChar(_oldfullpath).c_str(), _wNewfullpath.c_str(),
-        MOVEFILE_REPLACE_EXISTING & MOVEFILE_WRITE_THROUGH))
+        MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
     {
         return true;
     }
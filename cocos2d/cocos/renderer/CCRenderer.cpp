@@ -45,6 +45,7 @@
 #include "base/CCEventDispatcher.h"
 #include "base/CCEventListenerCustom.h"
 #include "base/CCEventType.h"
+#include "base/CCTracing.h"
 #include "2d/CCCamera.h"
 #include "2d/CCScene.h"
 
@@ -631,6 +632,8 @@ void Renderer::visitRenderQueue(RenderQueue& queue)
 
 void Renderer::render()
 {
+    CC_TRACE_SCOPE("Renderer::render");
+
     //Uncomment this once everything is rendered by new renderer
     //glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
@@ -32,6 +32,10 @@ THE SOFTWARE.
 #include <stack>
 #include <cctype>
 #include <list>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 
 #include "renderer/CCTexture2D.h"
 #include "base/ccMacros.h"
@@ -41,6 +45,8 @@ THE SOFTWARE.
 #include "platform/CCFileUtils.h"
 #include "base/ccUtils.h"
 #include "base/CCNinePatchImageParser.h"
+#include "base/CCTracing.h"
+#include "xxhash.h"
 
 
 
@@ -68,10 +74,32 @@ TextureCache * TextureCache::getInstance()
 }
 
 TextureCache::TextureCache()
-: _loadingThread(nullptr)
+: _loadingThreadCount(1)
+, _asyncUploadTimeBudget(0)
+, _maxRequestQueueDepth(0)
+, _nextLoadTicket(0)
+, _nextDeliveryTicket(0)
+, _uploadsLastFrame(0)
+, _uploadTimeLastFrame(0)
 , _needQuit(false)
 , _asyncRefCount(0)
+, _deduplicationEnabled(false)
+, _accessCount(0)
+, _cacheHits(0)
+, _cacheMisses(0)
+, _memoryBudget(0)
+, _residentBytes(0)
+, _peakResidentBytes(0)
+, _evictions(0)
+, _evictedBytes(0)
 {
+    // keep one core for the GL thread
+    unsigned int cores = std::thread::hardware_concurrency();
+    if (cores > 2)
+    {
+        _loadingThreadCount = static_cast<int>(std::min(cores - 1, 4u));
+    }
+    memset(_decodeStats, 0, sizeof(_decodeStats));
 }
 
 TextureCache::~TextureCache()
@@ -81,7 +109,8 @@ TextureCache::~TextureCache()
     for (auto& texture : _textures)
         texture.second->release();
 
-    CC_SAFE_DELETE(_loadingThread);
+    for (auto& thread : _loadingThreads)
+        CC_SAFE_DELETE(thread);
 }
 
 void TextureCache::destroyInstance()
@@ -102,6 +131,30 @@ std::string TextureCache::getDescription() const
     return StringUtils::format("<TextureCache | Number of textures = %d>", static_cast<int>(_textures.size()));
 }
 
+// hashes the decoded pixels and the way they are uploaded, 0 means the image can't be shared
+static unsigned long long computeContentHash(Image* image, Texture2D::PixelFormat pixelFormat, const std::string& path)
+{
+    if (image->getFileType() == Image::Format::ETC || NinePatchImageParser::isNinePatchImage(path))
+    {
+        return 0;
+    }
+
+    const int desc[] = {
+        image->getWidth(),
+        image->getHeight(),
+        static_cast<int>(image->getRenderFormat()),
+        static_cast<int>(pixelFormat),
+        image->hasPremultipliedAlpha() ? 1 : 0,
+        image->getNumberOfMipmaps()
+    };
+    unsigned int seed = XXH32(desc, sizeof(desc), 0);
+    // two 32 bits hashes with different seeds, to make collisions unlikely
+    int len = static_cast<int>(image->getDataLen());
+    unsigned long long hash = XXH32(image->getData(), len, seed);
+    hash = (hash << 32) | XXH32(image->getData(), len, seed ^ 0x9E3779B9);
+    return hash;
+}
+
 struct TextureCache::AsyncStruct
 {
 public:
@@ -110,7 +163,12 @@ public:
       const std::string& key )
       : filename(fn), callback(f),callbackKey( key ),
         pixelFormat(Texture2D::getDefaultAlphaPixelFormat()),
-        loadSuccess(false)
+        contentHash(0),
+        deduplicate(false),
+        priority(AsyncPriority::NORMAL),
+        ticket(0),
+        loadSuccess(false),
+        cancelled(false)
     {}
 
     std::string filename;
@@ -119,14 +177,24 @@ public:
     Image image;
     Image imageAlpha;
     Texture2D::PixelFormat pixelFormat;
+    unsigned long long contentHash;
+    // copied from _deduplicationEnabled when queued, the loading threads don't read the cache
+    bool deduplicate;
+    AsyncPriority priority;
+    // order in which the loading threads took the request, the callbacks are called in this order
+    unsigned int ticket;
     bool loadSuccess;
+    // set in GL thread, read by the loading threads to skip decoding
+    std::atomic<bool> cancelled;
 };
 
 /**
  The addImageAsync logic follow the steps:
- - find the image has been add or not, if not add an AsyncStruct to _requestQueue  (GL thread)
- - get AsyncStruct from _requestQueue, load res and fill image data to AsyncStruct.image, then add AsyncStruct to _responseQueue (Load thread)
- - on schedule callback, get AsyncStruct from _responseQueue, convert image to texture, then delete AsyncStruct (GL thread)
+ - find the image has been add or not, if not insert an AsyncStruct to _requestQueue by priority  (GL thread)
+ - get AsyncStruct from _requestQueue with the next ticket, load res and fill image data to AsyncStruct.image,
+   then add AsyncStruct to _responseQueue, sorted by ticket (Load threads)
+ - on schedule callback, get AsyncStruct from _responseQueue when its ticket is the next one to deliver,
+   convert image to texture, then delete AsyncStruct (GL thread)
 
  the Critical Area include these members:
  - _requestQueue: locked by _requestMutex
@@ -146,8 +214,9 @@ public:
  - In addImageAsyncCallback, will deduplicate the request to ensure only create one texture.
 
  Does process all response in addImageAsyncCallback consume more time?
- - Convert image to texture faster than load image from disk, so this isn't a
- problem.
+ - Convert image to texture faster than load image from disk, but with several
+ loading threads many images can be ready in the same frame, so the conversion
+ stops once the time set by setAsyncUploadTimeBudget is spent.
 
  Call unbindImageAsync(path) to prevent the call to the callback when the
  texture is loaded.
@@ -190,6 +259,11 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
  unbindImageAsync(path) would be ambiguous.
  */
 void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey)
+{
+    addImageAsync(path, callback, callbackKey, AsyncPriority::NORMAL);
+}
+
+void TextureCache::addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority)
 {
     Texture2D *texture = nullptr;
 
@@ -201,10 +275,13 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
 
     if (texture != nullptr)
     {
+        touchTexture(texture);
         if (callback) callback(texture);
         return;
     }
 
+    ++_cacheMisses;
+
     // check if file exists
     if (fullpath.empty() || !FileUtils::getInstance()->isFileExist(fullpath)) {
         if (callback) callback(nullptr);
@@ -212,11 +289,9 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     }
 
     // lazy init
-    if (_loadingThread == nullptr)
+    if (_loadingThreads.empty())
     {
-        // create a new thread to load images
-        _needQuit = false;
-        _loadingThread = new (std::nothrow) std::thread(&TextureCache::loadImage, this);
+        startLoadingThreads();
     }
 
     if (0 == _asyncRefCount)
@@ -229,14 +304,53 @@ void TextureCache::addImageAsync(const std::string &path, const std::function<vo
     // generate async struct
     AsyncStruct *data =
       new (std::nothrow) AsyncStruct(fullpath, callback, callbackKey);
+    data->priority = priority;
+    data->deduplicate = _deduplicationEnabled;
     
-    // add async struct into queue
+    // add async struct into queue, after the requests with the same or a higher priority
     _asyncStructQueue.push_back(data);
     std::unique_lock<std::mutex> ul(_requestMutex);
-    _requestQueue.push_back(data);
+    auto pos = std::find_if(_requestQueue.begin(), _requestQueue.end(), [priority](AsyncStruct* request) {
+        return request->priority < priority;
+    });
+    _requestQueue.insert(pos, data);
+    _maxRequestQueueDepth = std::max(_maxRequestQueueDepth, _requestQueue.size());
     _sleepCondition.notify_one();
 }
 
+void TextureCache::startLoadingThreads()
+{
+    _needQuit = false;
+    while (static_cast<int>(_loadingThreads.size()) < _loadingThreadCount)
+    {
+        _loadingThreads.push_back(new (std::nothrow) std::thread(&TextureCache::loadImage, this));
+    }
+}
+
+void TextureCache::setAsyncLoadingThreadCount(int count)
+{
+    _loadingThreadCount = std::max(count, 1);
+
+    if (!_loadingThreads.empty())
+    {
+        startLoadingThreads();
+    }
+}
+
+void TextureCache::cancelImageAsync(const std::string& callbackKey)
+{
+    // the loading threads and addImageAsyncCallBack skip cancelled requests,
+    // the AsyncStruct is still deleted in addImageAsyncCallBack
+    for (auto& asyncStruct : _asyncStructQueue)
+    {
+        if (asyncStruct->callbackKey == callbackKey)
+        {
+            asyncStruct->callback = nullptr;
+            asyncStruct->cancelled = true;
+        }
+    }
+}
+
 void TextureCache::unbindImageAsync(const std::string& callbackKey)
 {
     if (_asyncStructQueue.empty())
@@ -268,6 +382,7 @@ void TextureCache::unbindAllImageAsync()
 
 void TextureCache::loadImage()
 {
+    Tracer::setThreadName("TextureCache");
     AsyncStruct *asyncStruct = nullptr;
     while (!_needQuit)
     {
@@ -281,6 +396,7 @@ void TextureCache::loadImage()
         {
             asyncStruct = _requestQueue.front();
             _requestQueue.pop_front();
+            asyncStruct->ticket = _nextLoadTicket++;
         }
 
         if (nullptr == asyncStruct) {
@@ -292,7 +408,16 @@ void TextureCache::loadImage()
         }
         ul.unlock();
 
+        if (asyncStruct->cancelled)
+        {
+            _responseMutex.lock();
+            queueResponse(asyncStruct);
+            _responseMutex.unlock();
+            continue;
+        }
+
         // load image
+        auto start = std::chrono::steady_clock::now();
         asyncStruct->loadSuccess = asyncStruct->image.initWithImageFileThreadSafe(asyncStruct->filename);
 
         // ETC1 ALPHA supports.
@@ -302,22 +427,54 @@ void TextureCache::loadImage()
             if (FileUtils::getInstance()->isFileExist(alphaFile))
                 asyncStruct->imageAlpha.initWithImageFileThreadSafe(alphaFile);
         }
+        // hash in the loading thread, the GL thread only looks it up
+        if (asyncStruct->loadSuccess && asyncStruct->deduplicate)
+        {
+            asyncStruct->contentHash = computeContentHash(&asyncStruct->image, asyncStruct->pixelFormat, asyncStruct->filename);
+        }
+        double decodeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
         // push the asyncStruct to response queue
         _responseMutex.lock();
-        _responseQueue.push_back(asyncStruct);
+        AsyncDecodeStats& stats = _decodeStats[static_cast<int>(asyncStruct->image.getFileType())];
+        ++stats.count;
+        if (!asyncStruct->loadSuccess)
+            ++stats.failures;
+        stats.totalTime += decodeTime;
+        stats.maxTime = std::max(stats.maxTime, decodeTime);
+        queueResponse(asyncStruct);
         _responseMutex.unlock();
     }
 }
 
+void TextureCache::queueResponse(AsyncStruct* asyncStruct)
+{
+    // locked by _responseMutex, the responses are kept sorted by ticket
+    auto pos = std::find_if(_responseQueue.rbegin(), _responseQueue.rend(), [asyncStruct](AsyncStruct* response) {
+        return static_cast<int>(response->ticket - asyncStruct->ticket) < 0;
+    });
+    _responseQueue.insert(pos.base(), asyncStruct);
+}
+
 void TextureCache::addImageAsyncCallBack(float /*dt*/)
 {
     Texture2D *texture = nullptr;
     AsyncStruct *asyncStruct = nullptr;
+    auto start = std::chrono::steady_clock::now();
+    float elapsed = 0;
+    unsigned int uploads = 0;
     while (true)
     {
-        // pop an AsyncStruct from response queue
+        // the textures left wait for the next frame once the budget is spent
+        if (_asyncUploadTimeBudget > 0 && uploads > 0 && elapsed >= _asyncUploadTimeBudget)
+        {
+            break;
+        }
+
+        // pop an AsyncStruct from response queue, the requests completed before
+        // the ones taken earlier by another loading thread wait for them
         _responseMutex.lock();
-        if (_responseQueue.empty())
+        if (_responseQueue.empty() || _responseQueue.front()->ticket != _nextDeliveryTicket)
         {
             asyncStruct = nullptr;
         }
@@ -325,10 +482,7 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         {
             asyncStruct = _responseQueue.front();
             _responseQueue.pop_front();
-
-            // the asyncStruct's sequence order in _asyncStructQueue must equal to the order in _responseQueue
-            CC_ASSERT(asyncStruct == _asyncStructQueue.front());
-            _asyncStructQueue.pop_front();
+            ++_nextDeliveryTicket;
         }
         _responseMutex.unlock();
 
@@ -336,12 +490,27 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
             break;
         }
 
+        // the requests aren't taken in the order they were made
+        auto queueIter = std::find(_asyncStructQueue.begin(), _asyncStructQueue.end(), asyncStruct);
+        CC_ASSERT(queueIter != _asyncStructQueue.end());
+        _asyncStructQueue.erase(queueIter);
+
         // check the image has been convert to texture or not
         auto it = _textures.find(asyncStruct->filename);
         if (it != _textures.end())
         {
             texture = it->second;
         }
+        else if (asyncStruct->cancelled)
+        {
+            texture = nullptr;
+        }
+        else if (asyncStruct->contentHash != 0
+                 && (texture = findTextureWithContent(asyncStruct->contentHash, &asyncStruct->image, asyncStruct->pixelFormat)) != nullptr)
+        {
+            // same pixels already uploaded from another file
+            shareTexture(asyncStruct->filename, texture);
+        }
         else
         {
             // convert image to texture
@@ -371,6 +540,9 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
                     }
                     CC_SAFE_RELEASE(alphaTexture);
                 }
+                trackTexture(texture);
+                setContentHash(texture, asyncStruct->contentHash, asyncStruct->pixelFormat);
+                ++uploads;
             }
             else {
                 texture = nullptr;
@@ -387,8 +559,15 @@ void TextureCache::addImageAsyncCallBack(float /*dt*/)
         // release the asyncStruct
         delete asyncStruct;
         --_asyncRefCount;
+
+        elapsed = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
     }
 
+    _responseMutex.lock();
+    _uploadsLastFrame = uploads;
+    _uploadTimeLastFrame = elapsed;
+    _responseMutex.unlock();
+
     if (0 == _asyncRefCount)
     {
         Director::getInstance()->getScheduler()->unschedule(CC_SCHEDULE_SELECTOR(TextureCache::addImageAsyncCallBack), this);
@@ -410,7 +589,14 @@ Texture2D * TextureCache::addImage(const std::string &path)
     }
     auto it = _textures.find(fullpath);
     if (it != _textures.end())
+    {
         texture = it->second;
+        touchTexture(texture);
+    }
+    else
+    {
+        ++_cacheMisses;
+    }
 
     if (!texture)
     {
@@ -423,6 +609,19 @@ Texture2D * TextureCache::addImage(const std::string &path)
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
+            unsigned long long contentHash = 0;
+            if (_deduplicationEnabled)
+            {
+                contentHash = computeContentHash(image, Texture2D::getDefaultAlphaPixelFormat(), fullpath);
+                texture = findTextureWithContent(contentHash, image, Texture2D::getDefaultAlphaPixelFormat());
+                if (texture)
+                {
+                    // same pixels already uploaded from another file
+                    shareTexture(fullpath, texture);
+                    break;
+                }
+            }
+
             texture = new (std::nothrow) Texture2D();
 
             if (texture && texture->initWithImage(image))
@@ -451,6 +650,9 @@ Texture2D * TextureCache::addImage(const std::string &path)
 
                 //parse 9-patch info
                 this->parseNinePatchImage(image, texture, path);
+
+                trackTexture(texture);
+                setContentHash(texture, contentHash, Texture2D::getDefaultAlphaPixelFormat());
             }
             else
             {
@@ -489,6 +691,7 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
         auto it = _textures.find(key);
         if (it != _textures.end()) {
             texture = it->second;
+            touchTexture(texture);
             break;
         }
 
@@ -499,6 +702,7 @@ Texture2D* TextureCache::addImage(Image *image, const std::string &key)
             if (texture->initWithImage(image))
             {
                 _textures.emplace(key, texture);
+                trackTexture(texture);
             }
             else
             {
@@ -551,7 +755,24 @@ bool TextureCache::reloadTexture(const std::string& fileName)
             bool bRet = image->initWithImageFile(fullpath);
             CC_BREAK_IF(!bRet);
 
+            if (isTextureShared(texture))
+            {
+                // the other keys sharing the texture keep their pixels
+                Texture2D* ownTexture = new (std::nothrow) Texture2D();
+                CC_BREAK_IF(nullptr == ownTexture);
+                untrackTexture(texture);
+                texture->release();
+                texture = it->second = ownTexture;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                VolatileTextureMgr::addImageTexture(texture, fullpath);
+#endif
+            }
+
             ret = texture->initWithImage(image);
+            // the size, the format or the pixels may have changed
+            trackTexture(texture);
+            Texture2D::PixelFormat pixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+            setContentHash(texture, (ret && _deduplicationEnabled) ? computeContentHash(image, pixelFormat, fullpath) : 0, pixelFormat);
         } while (0);
     }
 
@@ -568,15 +789,19 @@ void TextureCache::removeAllTextures()
         texture.second->release();
     }
     _textures.clear();
+    _textureUsage.clear();
+    _texturesByContent.clear();
+    _residentBytes = 0;
 }
 
 void TextureCache::removeUnusedTextures()
 {
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         Texture2D *tex = it->second;
-        if (tex->getReferenceCount() == 1) {
+        if (isTextureUnused(tex)) {
             CCLOG("cocos2d: TextureCache: removing unused texture: %s", it->first.c_str());
 
+            untrackTexture(tex);
             tex->release();
             it = _textures.erase(it);
         }
@@ -594,11 +819,12 @@ void TextureCache::removeTexture(Texture2D* texture)
         return;
     }
 
+    // a shared texture is removed with all its keys
     for (auto it = _textures.cbegin(); it != _textures.cend(); /* nothing */) {
         if (it->second == texture) {
+            untrackTexture(texture);
             it->second->release();
             it = _textures.erase(it);
-            break;
         }
         else
             ++it;
@@ -616,6 +842,7 @@ void TextureCache::removeTextureForKey(const std::string &textureKeyName)
     }
 
     if (it != _textures.end()) {
+        untrackTexture(it->second);
         it->second->release();
         _textures.erase(it);
     }
@@ -632,10 +859,221 @@ Texture2D* TextureCache::getTextureForKey(const std::string &textureKeyName) con
     }
 
     if (it != _textures.end())
+    {
+        touchTexture(it->second);
         return it->second;
+    }
+
+    ++_cacheMisses;
+    return nullptr;
+}
+
+void TextureCache::trackTexture(Texture2D* texture)
+{
+    size_t bytes = static_cast<size_t>(texture->getPixelsWide()) * texture->getPixelsHigh() * texture->getBitsPerPixelForFormat() / 8;
+    Texture2D* alphaTexture = texture->getAlphaTexture();
+    if (alphaTexture)
+    {
+        bytes += static_cast<size_t>(alphaTexture->getPixelsWide()) * alphaTexture->getPixelsHigh() * alphaTexture->getBitsPerPixelForFormat() / 8;
+    }
+
+    // re-tracking a reloaded texture updates its size and keeps it pinned
+    auto it = _textureUsage.find(texture);
+    if (it != _textureUsage.end())
+    {
+        _residentBytes -= it->second.bytes;
+        it->second.lastAccess = ++_accessCount;
+        it->second.bytes = bytes;
+    }
+    else
+    {
+        TextureUsage usage = { ++_accessCount, bytes, false, 1, 0, Texture2D::PixelFormat::AUTO };
+        _textureUsage.emplace(texture, usage);
+    }
+    _residentBytes += bytes;
+    _peakResidentBytes = std::max(_peakResidentBytes, _residentBytes);
+}
+
+void TextureCache::untrackTexture(Texture2D* texture)
+{
+    auto it = _textureUsage.find(texture);
+    if (it != _textureUsage.end() && --it->second.keys == 0)
+    {
+        setContentHash(texture, 0, Texture2D::PixelFormat::AUTO);
+        _residentBytes -= it->second.bytes;
+        _textureUsage.erase(it);
+    }
+}
+
+bool TextureCache::isTextureUnused(Texture2D* texture) const
+{
+    // only the keys of the cache hold the texture
+    auto it = _textureUsage.find(texture);
+    unsigned int keys = (it != _textureUsage.end()) ? it->second.keys : 1;
+    return texture->getReferenceCount() == keys;
+}
+
+bool TextureCache::isTextureShared(Texture2D* texture) const
+{
+    auto it = _textureUsage.find(texture);
+    return it != _textureUsage.end() && it->second.keys > 1;
+}
+
+Texture2D* TextureCache::findTextureWithContent(unsigned long long contentHash, Image* image, Texture2D::PixelFormat pixelFormat) const
+{
+    if (contentHash == 0)
+    {
+        return nullptr;
+    }
+
+    auto it = _texturesByContent.find(contentHash);
+    if (it == _texturesByContent.end())
+    {
+        return nullptr;
+    }
+
+    Texture2D* texture = it->second;
+    auto usage = _textureUsage.find(texture);
+    if (usage == _textureUsage.end()
+        || usage->second.contentFormat != pixelFormat
+        || texture->getPixelsWide() != image->getWidth()
+        || texture->getPixelsHigh() != image->getHeight())
+    {
+        return nullptr;
+    }
+
+    // the texture doesn't keep its pixels, they are decoded again from its file so that a hash collision can't share another image
+    for (const auto& entry : _textures)
+    {
+        if (entry.second == texture)
+        {
+            Image sharedImage;
+            bool same = sharedImage.initWithImageFile(entry.first)
+                && sharedImage.getRenderFormat() == image->getRenderFormat()
+                && sharedImage.getDataLen() == image->getDataLen()
+                && memcmp(sharedImage.getData(), image->getData(), image->getDataLen()) == 0;
+            return same ? texture : nullptr;
+        }
+    }
     return nullptr;
 }
 
+void TextureCache::shareTexture(const std::string& key, Texture2D* texture)
+{
+    // every key holds a reference, as if it was loaded on its own
+    _textures.emplace(key, texture);
+    texture->retain();
+
+    auto it = _textureUsage.find(texture);
+    if (it != _textureUsage.end())
+    {
+        ++it->second.keys;
+        it->second.lastAccess = ++_accessCount;
+    }
+}
+
+void TextureCache::setContentHash(Texture2D* texture, unsigned long long contentHash, Texture2D::PixelFormat pixelFormat)
+{
+    auto it = _textureUsage.find(texture);
+    if (it == _textureUsage.end())
+    {
+        return;
+    }
+
+    unsigned long long& current = it->second.contentHash;
+    if (current != 0)
+    {
+        auto byContent = _texturesByContent.find(current);
+        if (byContent != _texturesByContent.end() && byContent->second == texture)
+            _texturesByContent.erase(byContent);
+    }
+
+    current = contentHash;
+    it->second.contentFormat = pixelFormat;
+    if (contentHash != 0)
+    {
+        _texturesByContent[contentHash] = texture;
+    }
+}
+
+void TextureCache::touchTexture(Texture2D* texture) const
+{
+    ++_cacheHits;
+    auto it = _textureUsage.find(texture);
+    if (it != _textureUsage.end())
+    {
+        it->second.lastAccess = ++_accessCount;
+    }
+}
+
+void TextureCache::evictUnusedTextures()
+{
+    if (_memoryBudget == 0 || _residentBytes <= _memoryBudget)
+    {
+        return;
+    }
+
+    // only the cache holds the candidates, oldest access first
+    std::vector<std::pair<unsigned int, Texture2D*>> candidates;
+    for (const auto& usage : _textureUsage)
+    {
+        Texture2D* tex = usage.first;
+        if (!usage.second.pinned && tex->getReferenceCount() == usage.second.keys)
+        {
+            candidates.push_back(std::make_pair(usage.second.lastAccess, tex));
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const auto& candidate : candidates)
+    {
+        if (_residentBytes <= _memoryBudget)
+        {
+            break;
+        }
+
+        Texture2D* tex = candidate.second;
+        _evictedBytes += _textureUsage[tex].bytes;
+        ++_evictions;
+
+        // a shared texture is evicted with all its keys
+        for (auto it = _textures.begin(); it != _textures.end(); /* nothing */)
+        {
+            if (it->second == tex)
+            {
+                CCLOG("cocos2d: TextureCache: evicting texture: %s", it->first.c_str());
+                it = _textures.erase(it);
+                untrackTexture(tex);
+                tex->release();
+            }
+            else
+                ++it;
+        }
+    }
+}
+
+void TextureCache::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+}
+
+void TextureCache::setTexturePinned(const std::string& key, bool pinned)
+{
+    std::string fullpath = key;
+    auto it = _textures.find(fullpath);
+
+    if (it == _textures.end()) {
+        fullpath = FileUtils::getInstance()->fullPathForFilename(key);
+        it = _textures.find(fullpath);
+    }
+
+    if (it != _textures.end()) {
+        auto usage = _textureUsage.find(it->second);
+        if (usage != _textureUsage.end())
+            usage->second.pinned = pinned;
+    }
+}
+
 void TextureCache::reloadAllTextures()
 {
     //will do nothing
@@ -662,9 +1100,12 @@ void TextureCache::waitForQuit()
     // notify sub thread to quick
     std::unique_lock<std::mutex> ul(_requestMutex);
     _needQuit = true;
-    _sleepCondition.notify_one();
+    _sleepCondition.notify_all();
     ul.unlock();
-    if (_loadingThread) _loadingThread->join();
+    for (auto& thread : _loadingThreads)
+    {
+        if (thread) thread->join();
+    }
 }
 
 std::string TextureCache::getCachedTextureInfo() const
@@ -674,6 +1115,8 @@ std::string TextureCache::getCachedTextureInfo() const
 
     unsigned int count = 0;
     unsigned int totalBytes = 0;
+    unsigned int sharedBytes = 0;
+    std::unordered_map<Texture2D*, int> counted;
 
     for (auto& texture : _textures) {
 
@@ -684,8 +1127,16 @@ std::string TextureCache::getCachedTextureInfo() const
         unsigned int bpp = tex->getBitsPerPixelForFormat();
         // Each texture takes up width * height * bytesPerPixel bytes.
         auto bytes = tex->getPixelsWide() * tex->getPixelsHigh() * bpp / 8;
-        totalBytes += bytes;
-        count++;
+        // a texture shared by several keys is only counted once
+        if (counted[tex]++ == 0)
+        {
+            totalBytes += bytes;
+            count++;
+        }
+        else
+        {
+            sharedBytes += bytes;
+        }
         snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" rc=%lu id=%lu %lu x %lu @ %ld bpp => %lu KB\n",
             texture.first.c_str(),
             (long)tex->getReferenceCount(),
@@ -701,6 +1152,77 @@ std::string TextureCache::getCachedTextureInfo() const
     snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache dumpDebugInfo: %ld textures, for %lu KB (%.2f MB)\n", (long)count, (long)totalBytes / 1024, totalBytes / (1024.0f*1024.0f));
     buffer += buftmp;
 
+    unsigned int lookups = _cacheHits + _cacheMisses;
+    snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache stats: resident %.2f MB (peak %.2f MB), budget %.2f MB, hit rate %.1f%% (%u/%u), %u evictions for %.2f MB\n",
+        _residentBytes / (1024.0f*1024.0f),
+        _peakResidentBytes / (1024.0f*1024.0f),
+        _memoryBudget / (1024.0f*1024.0f),
+        lookups > 0 ? _cacheHits * 100.0f / lookups : 0.0f,
+        _cacheHits,
+        lookups,
+        _evictions,
+        _evictedBytes / (1024.0f*1024.0f));
+    buffer += buftmp;
+
+    snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache deduplication: %s, %ld keys share %ld textures, saving %lu KB (%.2f MB)\n",
+        _deduplicationEnabled ? "on" : "off",
+        (long)_textures.size(),
+        (long)count,
+        (long)sharedBytes / 1024,
+        sharedBytes / (1024.0f*1024.0f));
+    buffer += buftmp;
+
+    return buffer;
+}
+
+std::string TextureCache::getAsyncLoadingInfo() const
+{
+    static const char* formatNames[] = {
+        "JPG", "PNG", "TIFF", "WEBP", "PVR", "ETC", "S3TC", "ATITC", "TGA", "RAW_DATA", "UNKNOWN"
+    };
+    static_assert(sizeof(formatNames) / sizeof(formatNames[0]) == static_cast<int>(Image::Format::UNKNOWN) + 1,
+                  "formatNames must match Image::Format");
+
+    std::string buffer;
+    char buftmp[512];
+
+    _requestMutex.lock();
+    size_t queueDepth = _requestQueue.size();
+    size_t maxQueueDepth = _maxRequestQueueDepth;
+    _requestMutex.unlock();
+
+    std::lock_guard<std::mutex> lock(_responseMutex);
+
+    snprintf(buftmp, sizeof(buftmp) - 1, "TextureCache async loading: %d threads, %ld requests in flight, %ld queued (max %ld), %ld decoded waiting\n",
+        (int)_loadingThreads.size(),
+        (long)_asyncStructQueue.size(),
+        (long)queueDepth,
+        (long)maxQueueDepth,
+        (long)_responseQueue.size());
+    buffer += buftmp;
+
+    snprintf(buftmp, sizeof(buftmp) - 1, "last frame: %u textures created in %.2f ms (budget %.2f ms)\n",
+        _uploadsLastFrame,
+        _uploadTimeLastFrame * 1000.0f,
+        _asyncUploadTimeBudget * 1000.0f);
+    buffer += buftmp;
+
+    for (int i = 0; i <= static_cast<int>(Image::Format::UNKNOWN); ++i)
+    {
+        const AsyncDecodeStats& stats = _decodeStats[i];
+        if (stats.count == 0)
+            continue;
+
+        snprintf(buftmp, sizeof(buftmp) - 1, "\"%s\" decoded=%u failed=%u avg=%.2f ms max=%.2f ms total=%.2f ms\n",
+            formatNames[i],
+            stats.count,
+            stats.failures,
+            stats.totalTime * 1000.0 / stats.count,
+            stats.maxTime * 1000.0,
+            stats.totalTime * 1000.0);
+        buffer += buftmp;
+    }
+
     return buffer;
 }
 
@@ -722,11 +1244,30 @@ void TextureCache::renameTextureWithKey(const std::string& srcName, const std::s
         if (image)
         {
             bool ret = image->initWithImageFile(dstName);
+            Texture2D* ownTexture = nullptr;
+            if (ret && isTextureShared(tex))
+            {
+                // the other keys sharing the texture keep their pixels, only the renamed key drops its share
+                ownTexture = new (std::nothrow) Texture2D();
+                ret = (ownTexture != nullptr);
+            }
             if (ret)
             {
-                tex->initWithImage(image);
+                if (ownTexture)
+                {
+                    untrackTexture(tex);
+                    tex->release();
+                    tex = ownTexture;
+#if CC_ENABLE_CACHE_TEXTURE_DATA
+                    VolatileTextureMgr::addImageTexture(tex, fullpath);
+#endif
+                }
+                bool initialized = tex->initWithImage(image);
                 _textures.emplace(fullpath, tex);
                 _textures.erase(it);
+                trackTexture(tex);
+                Texture2D::PixelFormat pixelFormat = Texture2D::getDefaultAlphaPixelFormat();
+                setContentHash(tex, (initialized && _deduplicationEnabled) ? computeContentHash(image, pixelFormat, fullpath) : 0, pixelFormat);
             }
             CC_SAFE_DELETE(image);
         }
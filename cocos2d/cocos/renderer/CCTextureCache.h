@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include <thread>
 #include <condition_variable>
 #include <queue>
+#include <vector>
 #include <string>
 #include <unordered_map>
 #include <functional>
@@ -88,6 +89,16 @@ public:
     static std::string getETC1AlphaFileSuffix();
 
 public:
+    /** Priority of an asynchronous load request.
+     * Requests with a higher priority are decoded before the ones already queued with a lower priority.
+     */
+    enum class AsyncPriority
+    {
+        LOW,
+        NORMAL,
+        HIGH
+    };
+
     /**
      * @js ctor
      */
@@ -119,6 +130,8 @@ public:
     * Otherwise it will load a texture in a new thread, and when the image is loaded, the callback will be called with the Texture2D as a parameter.
     * The callback will be called from the main thread, so it is safe to create any cocos2d object from the callback.
     * Supported image extensions: .png, .jpg
+    * The images are decoded by several threads, see setAsyncLoadingThreadCount, but the callbacks are still called
+    * in the order the requests are taken for decoding: the highest priority first, then in the order they were made.
      @param filepath A null terminated string.
      @param callback A callback function would be invoked after the image is loaded.
      @since v0.8
@@ -127,6 +140,41 @@ public:
     
     void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey );
 
+    /** Same as addImageAsync(path, callback, callbackKey), with a decoding priority.
+     * @param priority Requests with a higher priority are decoded first.
+     * @since v3.17
+     */
+    void addImageAsync(const std::string &path, const std::function<void(Texture2D*)>& callback, const std::string& callbackKey, AsyncPriority priority);
+
+    /** Cancel the asynchronous loads bound to a callback key.
+     * Requests that are still queued are dropped without being decoded, requests being decoded
+     * are not converted into a texture. The callback is never invoked.
+     * @param callbackKey The key passed to addImageAsync, the file path by default.
+     * @since v3.17
+     */
+    virtual void cancelImageAsync(const std::string &callbackKey);
+
+    /** Sets the number of threads decoding the images requested by addImageAsync.
+     * If the loading threads are already running, new threads are started when the count grows.
+     * The callbacks keep their order whatever the count, an image decoded early waits for the ones taken before it.
+     * @param count Number of decoding threads, at least 1.
+     * @since v3.17
+     */
+    void setAsyncLoadingThreadCount(int count);
+
+    /** Gets the number of threads decoding the images requested by addImageAsync. */
+    int getAsyncLoadingThreadCount() const { return _loadingThreadCount; }
+
+    /** Sets the time spent per frame converting decoded images into textures.
+     * At least one texture is created per frame, the remaining ones wait for the next frame.
+     * @param seconds The time budget in seconds, 0 means no limit.
+     * @since v3.17
+     */
+    void setAsyncUploadTimeBudget(float seconds) { _asyncUploadTimeBudget = seconds; }
+
+    /** Gets the time spent per frame converting decoded images into textures, 0 means no limit. */
+    float getAsyncUploadTimeBudget() const { return _asyncUploadTimeBudget; }
+
     /** Unbind a specified bound image asynchronous callback.
      * In the case an object who was bound to an image asynchronous callback was destroyed before the callback is invoked,
      * the object always need to unbind this callback manually.
@@ -179,6 +227,49 @@ public:
     */
     void removeUnusedTextures();
 
+    /** Sets the texture memory budget.
+    * When the textures in the cache take more memory than the budget, the unused ones
+    * (retain count of 1, not pinned) are removed at the end of the frame, least recently used first.
+    * A texture returned by addImage is kept at least until then, even if it isn't retained.
+    * @param bytes The budget in bytes, 0 means no limit (default).
+    * @since v3.17
+    */
+    void setMemoryBudget(size_t bytes);
+
+    /** Removes the unused textures until the cache fits in the memory budget.
+    * Called by Director at the end of each frame.
+    * @since v3.17
+    */
+    void evictUnusedTextures();
+
+    /** Gets the texture memory budget in bytes, 0 means no limit. */
+    size_t getMemoryBudget() const { return _memoryBudget; }
+
+    /** Gets the memory taken by the textures in the cache, in bytes. */
+    size_t getResidentBytes() const { return _residentBytes; }
+
+    /** Pins or unpins a texture.
+    * A pinned texture is never removed by the memory budget, removeUnusedTextures still removes it.
+    * @param key It's the related/absolute path of the file image.
+    * @param pinned Whether the texture is pinned.
+    * @since v3.17
+    */
+    void setTexturePinned(const std::string& key, bool pinned);
+
+    /** Enables or disables the deduplication of the textures loaded from files.
+    * When enabled, the decoded pixels are hashed and files with the same content share one Texture2D,
+    * each key holding its own reference, so removeTextureForKey only drops the given key.
+    * A hash match is confirmed by decoding the file of the shared texture again and comparing the pixels.
+    * reloadTexture and renameTextureWithKey give the key its own texture first if it is shared.
+    * 9-patch and ETC1 images with an alpha file are never shared.
+    * @param enabled Whether the deduplication is enabled (default: false).
+    * @since v3.17
+    */
+    void setDeduplicationEnabled(bool enabled) { _deduplicationEnabled = enabled; }
+
+    /** Whether the textures loaded from files are deduplicated by content. */
+    bool isDeduplicationEnabled() const { return _deduplicationEnabled; }
+
     /** Deletes a texture from the cache given a texture.
     */
     void removeTexture(Texture2D* texture);
@@ -196,6 +287,11 @@ public:
     */
     std::string getCachedTextureInfo() const;
 
+    /** Returns the state of the asynchronous loading: queue depth and decode time per image format.
+     * @since v3.17
+     */
+    std::string getAsyncLoadingInfo() const;
+
     //Wait for texture cache to quit before destroy instance.
     /**Called by director, please do not called outside.*/
     void waitForQuit();
@@ -222,20 +318,51 @@ public:
 
 private:
     void addImageAsyncCallBack(float dt);
+    void trackTexture(Texture2D* texture);
+    void untrackTexture(Texture2D* texture);
+    void touchTexture(Texture2D* texture) const;
+    bool isTextureUnused(Texture2D* texture) const;
+    bool isTextureShared(Texture2D* texture) const;
+    Texture2D* findTextureWithContent(unsigned long long contentHash, Image* image, Texture2D::PixelFormat pixelFormat) const;
+    void shareTexture(const std::string& key, Texture2D* texture);
+    void setContentHash(Texture2D* texture, unsigned long long contentHash, Texture2D::PixelFormat pixelFormat);
     void loadImage();
     void parseNinePatchImage(Image* image, Texture2D* texture, const std::string& path);
 public:
 protected:
     struct AsyncStruct;
+
+    struct AsyncDecodeStats
+    {
+        unsigned int count;
+        unsigned int failures;
+        double totalTime;
+        double maxTime;
+    };
+
+    void startLoadingThreads();
+    void queueResponse(AsyncStruct* asyncStruct);
     
-    std::thread* _loadingThread;
+    std::vector<std::thread*> _loadingThreads;
+    int _loadingThreadCount;
+    float _asyncUploadTimeBudget;
 
     std::deque<AsyncStruct*> _asyncStructQueue;
     std::deque<AsyncStruct*> _requestQueue;
     std::deque<AsyncStruct*> _responseQueue;
 
-    std::mutex _requestMutex;
-    std::mutex _responseMutex;
+    mutable std::mutex _requestMutex;
+    mutable std::mutex _responseMutex;
+
+    // guarded by _requestMutex
+    size_t _maxRequestQueueDepth;
+    unsigned int _nextLoadTicket;
+    // guarded by _responseMutex
+    unsigned int _nextDeliveryTicket;
+    // guarded by _responseMutex
+    AsyncDecodeStats _decodeStats[static_cast<int>(Image::Format::UNKNOWN) + 1];
+    unsigned int _uploadsLastFrame;
+    float _uploadTimeLastFrame;
     
     std::condition_variable _sleepCondition;
 
@@ -245,6 +372,32 @@ protected:
 
     std::unordered_map<std::string, Texture2D*> _textures;
 
+    struct TextureUsage
+    {
+        unsigned int lastAccess;
+        size_t bytes;
+        bool pinned;
+        // number of keys sharing the texture in _textures, each one holds a reference
+        unsigned int keys;
+        // hash of the pixels the texture was created with, 0 if it can't be shared
+        unsigned long long contentHash;
+        // pixel format the texture was requested with, matched along with the hash
+        Texture2D::PixelFormat contentFormat;
+    };
+
+    // LRU bookkeeping, one entry per texture in _textures
+    mutable std::unordered_map<Texture2D*, TextureUsage> _textureUsage;
+    std::unordered_map<unsigned long long, Texture2D*> _texturesByContent;
+    bool _deduplicationEnabled;
+    mutable unsigned int _accessCount;
+    mutable unsigned int _cacheHits;
+    mutable unsigned int _cacheMisses;
+    size_t _memoryBudget;
+    size_t _residentBytes;
+    size_t _peakResidentBytes;
+    unsigned int _evictions;
+    size_t _evictedBytes;
+
     static std::string s_etc1AlphaFileSuffix;
 };
 
@@ -28,6 +28,7 @@
 
 #include "renderer/CCRenderCommand.h"
 #include "renderer/CCGLProgramState.h"
+#include "base/allocator/CCAllocatorMacros.h"
 
 /**
  * @addtogroup renderer
@@ -95,6 +96,9 @@ public:
     BlendFunc getBlendType() const { return _blendType; }
     /**Get the model view matrix.*/
     const Mat4& getModelView() const { return _mv; }
+
+    // allocated from a pool when CC_ENABLE_ALLOCATOR is set
+    CC_DECLARE_ALLOCATOR_POOL(TrianglesCommand)
     
 protected:
     /**Generate the material ID by textureID, glProgramState, and blend function.*/
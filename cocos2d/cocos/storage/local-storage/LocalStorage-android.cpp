@@ -42,6 +42,7 @@
 
 USING_NS_CC;
 static int _initialized = 0;
+static int _batchDepth = 0;
 
 static std::string className = "org/cocos2dx/lib/Cocos2dxLocalStorage";
 
@@ -73,6 +74,12 @@ void localStorageInit( const std::string& fullpath)
 void localStorageFree()
 {
     if (_initialized) {
+        // an unfinished batch is committed too
+        if (_batchDepth > 0)
+        {
+            _batchDepth = 0;
+            JniHelper::callStaticVoidMethod(className, "endBatch");
+        }
         JniHelper::callStaticVoidMethod(className, "destroy");
         _initialized = 0;
     }
@@ -131,4 +138,24 @@ void localStorageClear()
     JniHelper::callStaticVoidMethod(className, "clear");
 }
 
+void localStorageBeginBatch()
+{
+    assert( _initialized );
+    if (_batchDepth++ == 0)
+        JniHelper::callStaticVoidMethod(className, "beginBatch");
+}
+
+void localStorageEndBatch()
+{
+    assert( _initialized && _batchDepth > 0 );
+    if (--_batchDepth == 0)
+        JniHelper::callStaticVoidMethod(className, "endBatch");
+}
+
+/** the items are written by localStorageSetItem and localStorageRemoveItem */
+void localStorageFlush()
+{
+    assert( _initialized );
+}
+
 #endif // #if (CC_TARGET_PLATFORM == CC_PLATFORM_ANDROID)
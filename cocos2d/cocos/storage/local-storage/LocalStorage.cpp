@@ -38,6 +38,60 @@
 #include <assert.h>
 #include <sqlite3.h>
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/*
+ The items are written by a thread. The items set or removed are queued, then committed by the thread in
+ one transaction for all the queued batches. Until then, localStorageGetItem reads them from _pending, which
+ also keeps them while a failed commit is retried. localStorageFree writes the queued items and stops the thread,
+ it is also called at exit.
+ The functions are called on one thread, e.g. the cocos thread.
+ */
+
+// number of writes queued at most, localStorageSetItem waits for the thread beyond
+#define LOCAL_STORAGE_MAX_QUEUED_WRITES 4096
+
+// a failed commit is retried after this delay, and given up after this many attempts once stopping
+#define LOCAL_STORAGE_RETRY_DELAY_MS 100
+#define LOCAL_STORAGE_MAX_RETRIES_ON_STOP 10
+
+typedef enum
+{
+    kWriteSet,
+    kWriteRemove,
+    kWriteClear,
+} tWriteType;
+
+typedef struct _write
+{
+    tWriteType type;
+    std::string key;
+    std::string value;
+} tWrite;
+
+// the writes committed atomically, e.g. of a localStorageBeginBatch/localStorageEndBatch
+typedef struct _writeBatch
+{
+    std::vector<tWrite> writes;
+    unsigned int sequence;
+} tWriteBatch;
+
+// value of a key not committed yet
+typedef struct _pendingValue
+{
+    std::string value;
+    bool removed;
+    unsigned int sequence;  // of the batch writing it
+} tPendingValue;
+
 static int _initialized = 0;
 static sqlite3 *_db;
 static sqlite3_stmt *_stmt_select;
@@ -45,6 +99,25 @@ static sqlite3_stmt *_stmt_remove;
 static sqlite3_stmt *_stmt_update;
 static sqlite3_stmt *_stmt_clear;
 
+// the connection, used by the thread and localStorageGetItem
+static std::mutex _dbMutex;
+
+// the queue and the pending values
+static std::mutex _mutex;
+static std::condition_variable _queueCondition;
+static std::condition_variable _commitCondition;
+static std::deque<tWriteBatch> _queue;
+static size_t _queuedWrites = 0;
+static std::unordered_map<std::string, tPendingValue> _pending;
+static unsigned int _pendingClearSequence = 0;  // of the last clear not committed, 0 if none
+static bool _stop = false;
+static std::thread _writer;
+
+// the batch being made, only used by the calling thread
+static tWriteBatch _batch;
+static unsigned int _batchSequence = 0;
+static int _batchDepth = 0;
+
 
 static void localStorageCreateTable()
 {
@@ -58,6 +131,167 @@ static void localStorageCreateTable()
         printf("Error in CREATE TABLE\n");
 }
 
+static bool localStorageExecute(const char *sql)
+{
+    if (sqlite3_exec(_db, sql, nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        printf("Error in %s: %s\n", sql, sqlite3_errmsg(_db));
+        return false;
+    }
+    return true;
+}
+
+static bool localStorageStep(sqlite3_stmt *stmt, const tWrite& write)
+{
+    int ok = SQLITE_OK;
+    if (write.type != kWriteClear)
+        ok |= sqlite3_bind_text(stmt, 1, write.key.c_str(), (int)write.key.size(), SQLITE_STATIC);
+    if (write.type == kWriteSet)
+        ok |= sqlite3_bind_text(stmt, 2, write.value.c_str(), (int)write.value.size(), SQLITE_STATIC);
+
+    ok |= sqlite3_step(stmt);
+
+    ok |= sqlite3_reset(stmt);
+
+    if (ok != SQLITE_OK && ok != SQLITE_DONE)
+    {
+        printf("Error in localStorage write: %s\n", sqlite3_errmsg(_db));
+        return false;
+    }
+    return true;
+}
+
+// returns false if nothing was written, e.g. the database was busy or an I/O error occurred
+static bool localStorageCommit(const std::deque<tWriteBatch>& batches)
+{
+    std::lock_guard<std::mutex> lock(_dbMutex);
+    if (!localStorageExecute("BEGIN;"))
+        return false;
+
+    bool ok = true;
+    for (const auto& batch : batches)
+    {
+        for (const auto& write : batch.writes)
+        {
+            switch (write.type)
+            {
+            case kWriteSet:
+                ok = localStorageStep(_stmt_update, write);
+                break;
+            case kWriteRemove:
+                ok = localStorageStep(_stmt_remove, write);
+                break;
+            case kWriteClear:
+                ok = localStorageStep(_stmt_clear, write);
+                break;
+            }
+            if (!ok)
+                break;
+        }
+        if (!ok)
+            break;
+    }
+
+    if (ok && localStorageExecute("COMMIT;"))
+        return true;
+
+    // a failed COMMIT leaves the transaction open
+    sqlite3_exec(_db, "ROLLBACK;", nullptr, nullptr, nullptr);
+    return false;
+}
+
+static void localStorageRunWriter()
+{
+    int failures = 0;
+    for (;;)
+    {
+        std::deque<tWriteBatch> batches;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _queueCondition.wait(lock, [] { return _stop || !_queue.empty(); });
+            // the queued batches are written before stopping
+            if (_queue.empty())
+                return;
+            batches.swap(_queue);
+        }
+
+        if (!localStorageCommit(batches))
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (!_stop || ++failures < LOCAL_STORAGE_MAX_RETRIES_ON_STOP)
+            {
+                // the writes stay pending and are committed with the batches queued since
+                _queue.insert(_queue.begin(), std::make_move_iterator(batches.begin()), std::make_move_iterator(batches.end()));
+                _queueCondition.wait_for(lock, std::chrono::milliseconds(LOCAL_STORAGE_RETRY_DELAY_MS));
+                continue;
+            }
+            printf("Error in localStorage: the writes of %d batches are lost\n", (int)batches.size());
+        }
+        failures = 0;
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            unsigned int committed = batches.back().sequence;
+            for (const auto& batch : batches)
+            {
+                _queuedWrites -= batch.writes.size();
+                for (const auto& write : batch.writes)
+                {
+                    auto iter = _pending.find(write.key);
+                    if (iter != _pending.end() && iter->second.sequence <= committed)
+                        _pending.erase(iter);
+                }
+            }
+            if (_pendingClearSequence != 0 && _pendingClearSequence <= committed)
+                _pendingClearSequence = 0;
+        }
+        _commitCondition.notify_all();
+    }
+}
+
+static void localStorageSubmitBatch()
+{
+    if (_batch.writes.empty())
+        return;
+
+    size_t count = _batch.writes.size();
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        // a batch larger than the queue waits for it to be empty
+        _commitCondition.wait(lock, [count] { return _queuedWrites == 0 || _queuedWrites + count <= LOCAL_STORAGE_MAX_QUEUED_WRITES; });
+        _queuedWrites += count;
+        _queue.push_back(std::move(_batch));
+    }
+    _queueCondition.notify_one();
+    _batch.writes.clear();
+}
+
+static void localStorageWrite(tWriteType type, const std::string& key, const std::string& value)
+{
+    if (_batch.writes.empty())
+        _batch.sequence = ++_batchSequence;
+
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (type == kWriteClear)
+        {
+            _pending.clear();
+            _pendingClearSequence = _batch.sequence;
+        }
+        else
+        {
+            tPendingValue& pending = _pending[key];
+            pending.value = value;
+            pending.removed = (type == kWriteRemove);
+            pending.sequence = _batch.sequence;
+        }
+    }
+
+    _batch.writes.push_back({ type, key, value });
+    if (_batchDepth == 0)
+        localStorageSubmitBatch();
+}
+
 void localStorageInit( const std::string& fullpath/* = "" */)
 {
     if (!_initialized) {
@@ -69,6 +303,13 @@ void localStorageInit( const std::string& fullpath/* = "" */)
         else
             ret = sqlite3_open(fullpath.c_str(), &_db);
 
+        // a commit appends to the log instead of rewriting the pages and syncing the database
+        if (!fullpath.empty())
+        {
+            localStorageExecute("PRAGMA journal_mode=WAL;");
+            localStorageExecute("PRAGMA synchronous=NORMAL;");
+        }
+
         localStorageCreateTable();
 
         // SELECT
@@ -91,6 +332,17 @@ void localStorageInit( const std::string& fullpath/* = "" */)
             printf("Error initializing DB\n");
             // report error
         }
+
+        _stop = false;
+        _writer = std::thread(localStorageRunWriter);
+
+        // a joinable thread destroyed at exit terminates the program, the engine never calls localStorageFree
+        static bool s_freedAtExit = false;
+        if (!s_freedAtExit)
+        {
+            atexit(localStorageFree);
+            s_freedAtExit = true;
+        }
 		
         _initialized = 1;
     }
@@ -99,9 +351,20 @@ void localStorageInit( const std::string& fullpath/* = "" */)
 void localStorageFree()
 {
     if (_initialized) {
+        // an unfinished batch is written too
+        _batchDepth = 0;
+        localStorageSubmitBatch();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _queueCondition.notify_one();
+        _writer.join();
+
         sqlite3_finalize(_stmt_select);
         sqlite3_finalize(_stmt_remove);
         sqlite3_finalize(_stmt_update);
+        sqlite3_finalize(_stmt_clear);
 
         sqlite3_close(_db);
 		
@@ -113,16 +376,8 @@ void localStorageFree()
 void localStorageSetItem( const std::string& key, const std::string& value)
 {
     assert( _initialized );
-	
-    int ok = sqlite3_bind_text(_stmt_update, 1, key.c_str(), -1, SQLITE_TRANSIENT);
-    ok |= sqlite3_bind_text(_stmt_update, 2, value.c_str(), -1, SQLITE_TRANSIENT);
 
-    ok |= sqlite3_step(_stmt_update);
-	
-    ok |= sqlite3_reset(_stmt_update);
-	
-    if (ok != SQLITE_OK && ok != SQLITE_DONE)
-        printf("Error in localStorage.setItem()\n");
+    localStorageWrite(kWriteSet, key, value);
 }
 
 /** gets an item from the LS */
@@ -130,6 +385,23 @@ bool localStorageGetItem( const std::string& key, std::string *outItem )
 {
     assert( _initialized );
 
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto iter = _pending.find(key);
+        if (iter != _pending.end())
+        {
+            if (iter->second.removed)
+                return false;
+            outItem->assign(iter->second.value);
+            return true;
+        }
+        if (_pendingClearSequence != 0)
+            return false;
+    }
+
+    // the items not pending are committed
+    std::lock_guard<std::mutex> lock(_dbMutex);
+
     int ok = sqlite3_reset(_stmt_select);
 
     ok |= sqlite3_bind_text(_stmt_select, 1, key.c_str(), -1, SQLITE_TRANSIENT);
@@ -157,25 +429,38 @@ void localStorageRemoveItem( const std::string& key )
 {
     assert( _initialized );
 
-    int ok = sqlite3_bind_text(_stmt_remove, 1, key.c_str(), -1, SQLITE_TRANSIENT);
-	
-    ok |= sqlite3_step(_stmt_remove);
-	
-    ok |= sqlite3_reset(_stmt_remove);
-
-    if (ok != SQLITE_OK && ok != SQLITE_DONE)
-        printf("Error in localStorage.removeItem()\n");
+    localStorageWrite(kWriteRemove, key, "");
 }
 
 /** removes all items from the LS */
 void localStorageClear()
 {
     assert( _initialized );
-    
-    int ok = sqlite3_step(_stmt_clear);
-    
-    if( ok != SQLITE_OK && ok != SQLITE_DONE)
-        printf("Error in localStorage.clear()\n");
+
+    localStorageWrite(kWriteClear, "", "");
+}
+
+void localStorageBeginBatch()
+{
+    assert( _initialized );
+
+    ++_batchDepth;
+}
+
+void localStorageEndBatch()
+{
+    assert( _initialized && _batchDepth > 0 );
+
+    if (--_batchDepth == 0)
+        localStorageSubmitBatch();
+}
+
+void localStorageFlush()
+{
+    assert( _initialized );
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _commitCondition.wait(lock, [] { return _queuedWrites == 0; });
 }
 
 #endif // #if (CC_TARGET_PLATFORM != CC_PLATFORM_ANDROID)
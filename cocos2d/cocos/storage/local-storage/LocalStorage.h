@@ -55,6 +55,27 @@ void CC_DLL localStorageRemoveItem( const std::string& key );
 /** Removes all items from the JS. */
 void CC_DLL localStorageClear();
 
+/**
+ * Starts a batch, the items set or removed until localStorageEndBatch are committed in one transaction.
+ * The batches can be nested, the outermost one is committed.
+ * @since v3.17
+ */
+void CC_DLL localStorageBeginBatch();
+
+/**
+ * Ends a batch started by localStorageBeginBatch.
+ * @since v3.17
+ */
+void CC_DLL localStorageEndBatch();
+
+/**
+ * Waits until the items set or removed are written to the database, except those of an unfinished batch.
+ * Except on Android, they are written by a thread after localStorageSetItem returns, and localStorageGetItem
+ * reads them meanwhile. localStorageFree writes them too.
+ * @since v3.17
+ */
+void CC_DLL localStorageFlush();
+
 // end group
 /// @}
 
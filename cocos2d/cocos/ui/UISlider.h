@@ -288,6 +288,8 @@ protected:
     virtual void onPressStateChangedToPressed() override;
     virtual void onPressStateChangedToDisabled() override;
     virtual void onSizeChanged() override;
+    // the slid ball may stick out of the bar
+    virtual bool isHitTestInContentSize() const override { return false; }
 
     void setupBarTexture();
     void loadBarTexture(SpriteFrame* spriteframe);
@@ -662,6 +662,8 @@ protected:
     void insertTextEvent();
     void deleteBackwardEvent();
     virtual void onSizeChanged() override;
+    // the touch area may be larger than the content size
+    virtual bool isHitTestInContentSize() const override { return false; }
   
     void textfieldRendererScaleChangedWithSize();
     
@@ -587,6 +587,7 @@ void Widget::setTouchEnabled(bool enable)
         _touchListener = EventListenerTouchOneByOne::create();
         CC_SAFE_RETAIN(_touchListener);
         _touchListener->setSwallowTouches(true);
+        _touchListener->setCullTouchesOutsideNode(isHitTestInContentSize());
         _touchListener->onTouchBegan = CC_CALLBACK_2(Widget::onTouchBegan, this);
         _touchListener->onTouchMoved = CC_CALLBACK_2(Widget::onTouchMoved, this);
         _touchListener->onTouchEnded = CC_CALLBACK_2(Widget::onTouchEnded, this);
@@ -895,6 +895,13 @@ protected:
     //initializes renderer of widget.
     virtual void initRenderer();
 
+    /* Whether hitTest only accepts points inside the content size, so that the EventDispatcher
+     * may skip the touches outside the widget when its touch culling is enabled.
+     * Subclasses hit testing a larger area return false.
+     * @since v3.17
+     */
+    virtual bool isHitTestInContentSize() const { return true; }
+
     //call back function called widget's state changed to normal.
     virtual void onPressStateChangedToNormal();
     //call back function called widget's state changed to selected.
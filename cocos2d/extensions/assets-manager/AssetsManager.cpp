@@ -418,7 +418,9 @@ bool AssetsManager::uncompress()
     
     CCLOG("end uncompressing");
     unzClose(zipfile);
-    
+
+    // the extracted files may have been cached as missing
+    FileUtils::getInstance()->purgeCachedEntries();
     return true;
 }
 
@@ -461,6 +461,9 @@ bool AssetsManagerEx::decompress(const std::string &zip)
     }
     
     unzClose(zipfile);
+
+    // the extracted files may have been cached as missing
+    FileUtils::getInstance()->purgeCachedEntries();
     return true;
 }
 
@@ -0,0 +1,96 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Build an asset pack to mount with FileUtils::mountPack.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Build an asset pack (.ccpack) from a directory, see cocos/base/CCAssetPack.h for the format.
+The files are compressed with zlib unless their extension is in --store or the compression saves
+less than --min-gain, the stored files are read by the engine without copy.
+
+    python ccpack.py res res.ccpack
+'''
+
+import os
+import struct
+import zlib
+
+from argparse import ArgumentParser
+
+MAGIC = b'CCPK'
+VERSION = 1
+HEADER_FORMAT = '<4sIII'
+ENTRY_FORMAT = '<IIQIIII'
+STORED = 0
+ZLIB = 1
+# the stored entries are aligned for the readers casting them, e.g. the textures
+DATA_ALIGNMENT = 16
+
+DEFAULT_STORE = 'png,jpg,jpeg,webp,pvr,ccz,pkm,ktx,mp3,ogg,m4a,caf,ttf,otf,zip'
+
+
+def collect_files(root):
+    files = []
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames.sort()
+        for name in filenames:
+            path = os.path.join(dirpath, name)
+            files.append(os.path.relpath(path, root).replace(os.sep, '/'))
+    return files
+
+
+def build_pack(root, output, store_extensions, min_gain, level):
+    names = sorted(collect_files(root), key=lambda n: n.encode('utf-8'))
+    encoded = [n.encode('utf-8') for n in names]
+    names_block = b''.join(encoded)
+
+    data_start = struct.calcsize(HEADER_FORMAT) + len(names) * struct.calcsize(ENTRY_FORMAT) + len(names_block)
+    entries = []
+    blobs = []
+    offset = data_start
+    name_offset = 0
+    for name, raw_name in zip(names, encoded):
+        with open(os.path.join(root, name), 'rb') as f:
+            content = f.read()
+
+        compression = STORED
+        stored = content
+        extension = os.path.splitext(name)[1][1:].lower()
+        if extension not in store_extensions and content:
+            compressed = zlib.compress(content, level)
+            if len(compressed) <= len(content) * (1.0 - min_gain):
+                compression = ZLIB
+                stored = compressed
+
+        padding = (-offset) % DATA_ALIGNMENT
+        offset += padding
+        blobs.append(b'\0' * padding + stored)
+        entries.append(struct.pack(ENTRY_FORMAT, name_offset, len(raw_name), offset, len(stored), len(content), compression, 0))
+        offset += len(stored)
+        name_offset += len(raw_name)
+
+    with open(output, 'wb') as f:
+        f.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(names), len(names_block)))
+        f.write(b''.join(entries))
+        f.write(names_block)
+        for blob in blobs:
+            f.write(blob)
+
+    print('%d files packed in %s (%d bytes)' % (len(names), output, offset))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Build an asset pack to mount with FileUtils::mountPack.')
+    parser.add_argument('root', help='the directory to pack, its files are found relatively to it')
+    parser.add_argument('output', help='the pack to write')
+    parser.add_argument('--store', default=DEFAULT_STORE,
+                        help='comma separated extensions stored without compression, default: %s' % DEFAULT_STORE)
+    parser.add_argument('--min-gain', type=float, default=0.1,
+                        help='the files are stored when the compression saves less than this ratio, default: 0.1')
+    parser.add_argument('--level', type=int, default=9, help='the zlib compression level, default: 9')
+    args = parser.parse_args()
+
+    build_pack(args.root, args.output, set(e.strip().lower() for e in args.store.split(',') if e.strip()),
+               args.min_gain, args.level)
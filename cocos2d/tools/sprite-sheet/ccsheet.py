@@ -0,0 +1,175 @@
+#!/usr/bin/python
+#-*- coding: UTF-8 -*-
+# ----------------------------------------------------------------------------
+# Convert a sprite sheet plist to a binary sprite sheet for SpriteFrameCache.
+#
+# License: MIT
+# ----------------------------------------------------------------------------
+'''
+Convert the .plist files of TexturePacker or Zwoptex (formats 0 to 3) to .ccsheet files, loaded by
+SpriteFrameCache::addSpriteFramesWithFile without parsing, see cocos/2d/CCSpriteFrameCache.h for the format.
+
+    python ccsheet.py ui.plist              # writes ui.ccsheet
+    python ccsheet.py ui.plist -o out/ui.ccsheet
+'''
+
+import os
+import plistlib
+import re
+import struct
+
+from argparse import ArgumentParser
+
+MAGIC = b'CCSF'
+VERSION = 1
+HEADER_FORMAT = '<4sIIIIIIIIIff'
+FRAME_FORMAT = '<IIffffffffffIIII'
+ALIAS_FORMAT = '<III'
+
+FRAME_ROTATED = 1
+FRAME_ANCHOR = 2
+FRAME_POLYGON = 4
+
+NUMBER = re.compile(r'-?[0-9]*\.?[0-9]+(?:[eE][-+]?[0-9]+)?')
+
+
+def numbers(value):
+    # '{{x,y},{w,h}}' like RectFromString, PointFromString and SizeFromString
+    return [float(n) for n in NUMBER.findall(value or '')]
+
+
+def pair(value):
+    n = numbers(value)
+    return (n[0], n[1]) if len(n) >= 2 else (0.0, 0.0)
+
+
+def rect(value):
+    n = numbers(value)
+    return tuple(n[:4]) if len(n) >= 4 else (0.0, 0.0, 0.0, 0.0)
+
+
+def integers(value):
+    return [int(n) for n in (value or '').split()]
+
+
+class Frame(object):
+    def __init__(self, name):
+        self.name = name
+        self.rect = (0.0, 0.0, 0.0, 0.0)
+        self.offset = (0.0, 0.0)
+        self.source_size = (0.0, 0.0)
+        self.anchor = None
+        self.rotated = False
+        self.vertices = []
+        self.vertices_uv = []
+        self.triangles = []
+        self.aliases = []
+
+
+def read_frame(name, frame_dict, format):
+    frame = Frame(name)
+    if format == 0:
+        frame.rect = (float(frame_dict.get('x', 0)), float(frame_dict.get('y', 0)),
+                      float(frame_dict.get('width', 0)), float(frame_dict.get('height', 0)))
+        frame.offset = (float(frame_dict.get('offsetX', 0)), float(frame_dict.get('offsetY', 0)))
+        frame.source_size = (float(abs(int(frame_dict.get('originalWidth', 0)))),
+                             float(abs(int(frame_dict.get('originalHeight', 0)))))
+    elif format in (1, 2):
+        frame.rect = rect(frame_dict.get('frame'))
+        frame.rotated = format == 2 and bool(frame_dict.get('rotated', False))
+        frame.offset = pair(frame_dict.get('offset'))
+        frame.source_size = pair(frame_dict.get('sourceSize'))
+    elif format == 3:
+        sprite_size = pair(frame_dict.get('spriteSize'))
+        texture_rect = rect(frame_dict.get('textureRect'))
+        frame.rect = (texture_rect[0], texture_rect[1], sprite_size[0], sprite_size[1])
+        frame.rotated = bool(frame_dict.get('textureRotated', False))
+        frame.offset = pair(frame_dict.get('spriteOffset'))
+        frame.source_size = pair(frame_dict.get('spriteSourceSize'))
+        frame.aliases = list(frame_dict.get('aliases', []))
+        if 'vertices' in frame_dict:
+            frame.vertices = integers(frame_dict.get('vertices'))
+            frame.vertices_uv = integers(frame_dict.get('verticesUV'))
+            frame.triangles = integers(frame_dict.get('triangles'))
+            if len(frame.vertices) % 2 or len(frame.vertices) != len(frame.vertices_uv):
+                raise ValueError('%s: the vertices and verticesUV do not match' % name)
+        if 'anchor' in frame_dict:
+            frame.anchor = pair(frame_dict.get('anchor'))
+    else:
+        raise ValueError('format %d is not supported' % format)
+    return frame
+
+
+def convert(plist_path, output):
+    with open(plist_path, 'rb') as f:
+        plist = plistlib.load(f) if hasattr(plistlib, 'load') else plistlib.readPlist(f)
+
+    metadata = plist.get('metadata', {})
+    format = int(metadata.get('format', 0))
+    texture_size = pair(metadata.get('size'))
+    frames = [read_frame(name, frame_dict, format) for name, frame_dict in plist.get('frames', {}).items()]
+    frames.sort(key=lambda frame: frame.name.encode('utf-8'))
+
+    strings = bytearray()
+
+    def add_string(value):
+        encoded = (value or '').encode('utf-8')
+        offset = len(strings)
+        strings.extend(encoded)
+        return offset, len(encoded)
+
+    # the last alias of a name wins, like in SpriteFrameCache
+    aliases = {}
+    polygons = []
+    frame_entries = []
+    for index, frame in enumerate(frames):
+        name_offset, name_length = add_string(frame.name)
+        flags = 0
+        if frame.rotated:
+            flags |= FRAME_ROTATED
+        if frame.anchor is not None:
+            flags |= FRAME_ANCHOR
+        polygon_offset = len(polygons)
+        if frame.vertices:
+            flags |= FRAME_POLYGON
+            polygons.extend(frame.vertices + frame.vertices_uv + frame.triangles)
+        anchor = frame.anchor or (0.0, 0.0)
+        frame_entries.append(struct.pack(FRAME_FORMAT, name_offset, name_length,
+                                         frame.rect[0], frame.rect[1], frame.rect[2], frame.rect[3],
+                                         frame.offset[0], frame.offset[1],
+                                         frame.source_size[0], frame.source_size[1],
+                                         anchor[0], anchor[1], flags,
+                                         len(frame.vertices) // 2, len(frame.triangles), polygon_offset))
+        for alias in frame.aliases:
+            aliases[alias] = index
+
+    alias_entries = []
+    for alias in sorted(aliases, key=lambda name: name.encode('utf-8')):
+        name_offset, name_length = add_string(alias)
+        alias_entries.append(struct.pack(ALIAS_FORMAT, name_offset, name_length, aliases[alias]))
+
+    texture_offset, texture_length = add_string(metadata.get('textureFileName', ''))
+    pixel_format_offset, pixel_format_length = add_string(metadata.get('pixelFormat', ''))
+
+    with open(output, 'wb') as f:
+        f.write(struct.pack(HEADER_FORMAT, MAGIC, VERSION, len(frame_entries), len(alias_entries), len(polygons),
+                            len(strings), texture_offset, texture_length, pixel_format_offset, pixel_format_length,
+                            texture_size[0], texture_size[1]))
+        f.write(b''.join(frame_entries))
+        f.write(b''.join(alias_entries))
+        f.write(struct.pack('<%di' % len(polygons), *polygons))
+        f.write(bytes(strings))
+
+    print('%s: %d frames, %d aliases written in %s' % (plist_path, len(frame_entries), len(alias_entries), output))
+
+
+if __name__ == '__main__':
+    parser = ArgumentParser(description='Convert a sprite sheet plist to a binary sprite sheet for SpriteFrameCache.')
+    parser.add_argument('plist', nargs='+', help='the plist files to convert')
+    parser.add_argument('-o', '--output', help='the output file, the plist name with .ccsheet by default, for one plist only')
+    args = parser.parse_args()
+
+    if args.output and len(args.plist) > 1:
+        parser.error('--output is for one plist only')
+    for path in args.plist:
+        convert(path, args.output or os.path.splitext(path)[0] + '.ccsheet')